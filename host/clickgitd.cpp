@@ -0,0 +1,724 @@
+/*
+ * clickgitd — host-side hook daemon for the ClickGit button.
+ *
+ * Every agent session on the workstation used to fork curl against /led
+ * on each hook, so concurrent sessions raced each other and a busy turn
+ * cost dozens of requests. Hooks now run `clickgitd send`, which hands the
+ * event to this daemon over a Unix socket and exits. The daemon tracks
+ * every session, merges them into one state (any needs input → red pulse,
+ * else any working → blue spin, else done → green), debounces, and sends
+ * only real changes over one persistent WebSocket (port 81) to the button.
+ *
+ *   clickgitd run [--device HOST] [--port 81] [--socket PATH] [--debounce MS] [--idle S]
+ *   clickgitd send [SESSION EVENT]   hook command; reads the hook JSON on stdin
+ *   clickgitd status                 counters, including requests saved
+ *   clickgitd mock [--port 81]       stand-in button that logs each command
+ *
+ * The button password comes from CLICKGIT_PASSWORD (kept out of ps).
+ *
+ * Build: c++ -std=c++17 -O2 -Wall host/clickgitd.cpp -o clickgitd
+ * Test:  host/selftest.sh
+ */
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// ── Defaults ────────────────────────────────────────────────
+#define DEFAULT_DEVICE   "clickgit.local"
+#define DEFAULT_WS_PORT  81
+#define DEBOUNCE_MS      150     // Max delay a state change waits for more events
+#define SESSION_IDLE_S   900     // Forget a session silent this long (crashed agent)
+#define CONNECT_MS       2000    // TCP connect + WebSocket handshake budget
+#define BACKOFF_MIN_MS   1000
+#define BACKOFF_MAX_MS   30000
+#define CLIENT_MAX       4096    // Bytes accepted per socket client
+
+struct Options {
+  std::string device = DEFAULT_DEVICE;
+  int port = DEFAULT_WS_PORT;
+  std::string socketPath;
+  std::string password;
+  int debounceMs = DEBOUNCE_MS;
+  int idleSec = SESSION_IDLE_S;
+};
+
+uint64_t nowMs() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+std::string defaultSocketPath() {
+  const char* dir = getenv("XDG_RUNTIME_DIR");
+  if (dir && *dir) return std::string(dir) + "/clickgitd.sock";
+  return "/tmp/clickgitd-" + std::to_string(getuid()) + ".sock";
+}
+
+// ── Encoding: base64, SHA-1 (WebSocket handshake) ───────────
+std::string base64(const std::string& in) {
+  static const char* ABC = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < in.size(); i += 3) {
+    uint32_t n = (uint8_t)in[i] << 16;
+    if (i + 1 < in.size()) n |= (uint8_t)in[i + 1] << 8;
+    if (i + 2 < in.size()) n |= (uint8_t)in[i + 2];
+    out += ABC[n >> 18 & 63];
+    out += ABC[n >> 12 & 63];
+    out += i + 1 < in.size() ? ABC[n >> 6 & 63] : '=';
+    out += i + 2 < in.size() ? ABC[n & 63] : '=';
+  }
+  return out;
+}
+
+std::string sha1(const std::string& msg) {
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  std::string m = msg;
+  uint64_t bits = (uint64_t)msg.size() * 8;
+  m += '\x80';
+  while (m.size() % 64 != 56) m += '\0';
+  for (int i = 7; i >= 0; i--) m += (char)(bits >> (i * 8));
+  auto rol = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+  for (size_t off = 0; off < m.size(); off += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++)
+      w[i] = (uint8_t)m[off + i * 4] << 24 | (uint8_t)m[off + i * 4 + 1] << 16 |
+             (uint8_t)m[off + i * 4 + 2] << 8 | (uint8_t)m[off + i * 4 + 3];
+    for (int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+      else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+      else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+      else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+      uint32_t t = rol(a, 5) + f + e + k + w[i];
+      e = d; d = c; c = rol(b, 30); b = a; a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+  }
+  std::string out;
+  for (uint32_t v : h)
+    for (int i = 3; i >= 0; i--) out += (char)(v >> (i * 8));
+  return out;
+}
+
+std::string wsAccept(const std::string& key) {
+  return base64(sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+}
+
+// ── Sockets ─────────────────────────────────────────────────
+void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); }
+
+bool waitFd(int fd, short events, int timeoutMs) {
+  pollfd p = { fd, events, 0 };
+  return poll(&p, 1, timeoutMs) == 1 && !(p.revents & (POLLERR | POLLNVAL));
+}
+
+bool writeAll(int fd, const std::string& data, int timeoutMs = CONNECT_MS) {
+  size_t off = 0;
+  while (off < data.size()) {
+    ssize_t n = send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+    if (n > 0) { off += n; continue; }
+    if (n < 0 && (errno == EAGAIN || errno == EINTR) && waitFd(fd, POLLOUT, timeoutMs)) continue;
+    return false;
+  }
+  return true;
+}
+
+int dialTcp(const std::string& host, int port, int timeoutMs) {
+  addrinfo hints = {}, *res = nullptr;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0) return -1;
+  int fd = -1;
+  for (addrinfo* a = res; a; a = a->ai_next) {
+    fd = socket(a->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) continue;
+    setNonBlocking(fd);
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (connect(fd, a->ai_addr, a->ai_addrlen) == 0 ||
+        (errno == EINPROGRESS && waitFd(fd, POLLOUT, timeoutMs) &&
+         getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0))
+      break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  if (fd >= 0) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  return fd;
+}
+
+int listenUnix(const std::string& path) {
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) return -1;
+  strcpy(addr.sun_path, path.c_str());
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  // A socket file nobody answers on is left over from a crash
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) { close(fd); errno = EADDRINUSE; return -1; }
+  unlink(path.c_str());
+  mode_t old = umask(077); // Only this user's hooks may talk to us
+  bool ok = bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(fd, 64) == 0;
+  umask(old);
+  if (!ok) { close(fd); return -1; }
+  setNonBlocking(fd);
+  return fd;
+}
+
+int dialUnix(const std::string& path) {
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) return -1;
+  strcpy(addr.sun_path, path.c_str());
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) { close(fd); fd = -1; }
+  return fd;
+}
+
+// ── WebSocket frames ────────────────────────────────────────
+enum { WS_TEXT = 1, WS_CLOSE = 8, WS_PING = 9, WS_PONG = 10 };
+
+// Clients mask what they send, servers don't (RFC 6455)
+std::string wsFrame(int opcode, const std::string& payload, bool masked) {
+  std::string f;
+  f += (char)(0x80 | opcode);
+  uint8_t maskBit = masked ? 0x80 : 0;
+  if (payload.size() < 126) {
+    f += (char)(maskBit | payload.size());
+  } else {
+    f += (char)(maskBit | 126);
+    f += (char)(payload.size() >> 8);
+    f += (char)payload.size();
+  }
+  if (!masked) return f + payload;
+  static std::mt19937 rng(std::random_device{}());
+  uint8_t key[4];
+  for (auto& k : key) k = rng();
+  f.append((const char*)key, 4);
+  for (size_t i = 0; i < payload.size(); i++) f += (char)(payload[i] ^ key[i % 4]);
+  return f;
+}
+
+// Pops one complete frame off the front of `buf`; false if more bytes are needed
+bool wsNextFrame(std::string& buf, int& opcode, std::string& payload) {
+  if (buf.size() < 2) return false;
+  size_t len = buf[1] & 0x7F, pos = 2;
+  if (len == 126) {
+    if (buf.size() < 4) return false;
+    len = (uint8_t)buf[2] << 8 | (uint8_t)buf[3];
+    pos = 4;
+  } else if (len == 127) {
+    if (buf.size() < 10) return false;
+    len = 0;
+    for (int i = 2; i < 10; i++) len = len << 8 | (uint8_t)buf[i];
+    pos = 10;
+  }
+  bool masked = buf[1] & 0x80;
+  if (buf.size() < pos + (masked ? 4 : 0) + len) return false;
+  const char* key = masked ? &buf[pos] : nullptr;
+  if (masked) pos += 4;
+  opcode = buf[0] & 0x0F;
+  payload.assign(buf, pos, len);
+  if (key)
+    for (size_t i = 0; i < len; i++) payload[i] ^= key[i % 4];
+  buf.erase(0, pos + len);
+  return true;
+}
+
+// Reads an HTTP head (through the blank line); anything after it stays in `rest`
+bool readHead(int fd, std::string& head, std::string& rest, int timeoutMs) {
+  uint64_t deadline = nowMs() + timeoutMs;
+  std::string buf;
+  char tmp[1024];
+  for (;;) {
+    size_t end = buf.find("\r\n\r\n");
+    if (end != std::string::npos) {
+      head = buf.substr(0, end + 2);
+      rest = buf.substr(end + 4);
+      return true;
+    }
+    if (buf.size() > 8192) return false;
+    uint64_t now = nowMs();
+    if (now >= deadline || !waitFd(fd, POLLIN, (int)(deadline - now))) return false;
+    ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+    if (n <= 0) return false;
+    buf.append(tmp, n);
+  }
+}
+
+// Value of an HTTP header in `head`, case-insensitive name ("" if absent)
+std::string headerValue(const std::string& head, const char* name) {
+  size_t nameLen = strlen(name);
+  for (size_t pos = head.find("\r\n"); pos != std::string::npos; pos = head.find("\r\n", pos + 2)) {
+    size_t start = pos + 2;
+    if (head.size() > start + nameLen && head[start + nameLen] == ':' &&
+        strncasecmp(head.c_str() + start, name, nameLen) == 0) {
+      size_t v = head.find_first_not_of(' ', start + nameLen + 1);
+      size_t e = head.find("\r\n", start);
+      return v < e ? head.substr(v, e - v) : "";
+    }
+  }
+  return "";
+}
+
+// ── Sessions ────────────────────────────────────────────────
+// Each agent session is in one state; the button shows the most urgent
+enum SessionState { S_IDLE, S_DONE, S_WORKING, S_NEEDS_INPUT };
+const char* const STATE_NAMES[] = { "idle", "done", "working", "needs-input" };
+
+// LED command per merged state, as sent to /led (or the WebSocket)
+const char* const STATE_COMMANDS[] = {
+  "color=off",
+  "color=green&timeout=60000",
+  "color=blue&effect=spin",
+  "color=red&effect=pulse",
+};
+
+struct Session { SessionState state; uint64_t lastSeen; };
+
+std::map<std::string, Session> sessions;
+
+// -1 = ignore the event, -2 = the session ended
+int stateForEvent(const std::string& event) {
+  if (event == "UserPromptSubmit" || event == "PreToolUse" || event == "PostToolUse") return S_WORKING;
+  if (event == "Notification") return S_NEEDS_INPUT;
+  if (event == "Stop") return S_DONE;
+  if (event == "SessionEnd") return -2;
+  return -1; // SubagentStop, PreCompact, ...: the parent session says more
+}
+
+SessionState mergedState() {
+  SessionState s = S_IDLE;
+  for (auto& it : sessions) s = std::max(s, it.second.state);
+  return s;
+}
+
+// ── Counters ────────────────────────────────────────────────
+struct Stats {
+  unsigned long events = 0, ignored = 0, sessionsSeen = 0;
+  unsigned long commands = 0, repliesOk = 0, repliesError = 0;
+  unsigned long connects = 0, connectFailures = 0, expired = 0;
+};
+Stats stats;
+
+std::string report() {
+  char buf[640];
+  unsigned long saved = stats.events > stats.commands ? stats.events - stats.commands : 0;
+  snprintf(buf, sizeof(buf),
+    "state     %s (%zu active sessions, %lu seen, %lu expired)\n"
+    "events    %lu received, %lu ignored\n"
+    "commands  %lu sent, %lu ok, %lu errors\n"
+    "saved     %lu device requests (%lu%%)\n"
+    "link      %lu connects, %lu failed attempts\n",
+    STATE_NAMES[mergedState()], sessions.size(), stats.sessionsSeen, stats.expired,
+    stats.events, stats.ignored,
+    stats.commands, stats.repliesOk, stats.repliesError,
+    saved, stats.events ? saved * 100 / stats.events : 0,
+    stats.connects, stats.connectFailures);
+  return buf;
+}
+
+// ── Device link ─────────────────────────────────────────────
+// One WebSocket to the button, authenticated once on the upgrade
+int linkFd = -1;
+std::string linkRx;
+uint64_t reconnectAt = 0;
+int backoffMs = BACKOFF_MIN_MS;
+const char* lastSent = nullptr; // Command the button has now, nullptr = unknown
+
+void linkClose(const char* why) {
+  if (linkFd < 0) return;
+  fprintf(stderr, "clickgitd: device link closed (%s)\n", why);
+  close(linkFd);
+  linkFd = -1;
+  linkRx.clear();
+  lastSent = nullptr; // It may have rebooted meanwhile
+  reconnectAt = nowMs() + backoffMs;
+}
+
+bool linkOpen(const Options& o) {
+  int fd = dialTcp(o.device, o.port, CONNECT_MS);
+  if (fd < 0) return false;
+  std::string keyBytes(16, 0);
+  static std::mt19937 rng(std::random_device{}());
+  for (auto& c : keyBytes) c = (char)rng();
+  std::string key = base64(keyBytes);
+  std::string req =
+    "GET / HTTP/1.1\r\nHost: " + o.device + ":" + std::to_string(o.port) + "\r\n"
+    "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+    "Sec-WebSocket-Key: " + key + "\r\nSec-WebSocket-Version: 13\r\n";
+  if (!o.password.empty()) req += "Authorization: Basic " + base64("admin:" + o.password) + "\r\n";
+  req += "\r\n";
+  std::string head, rest;
+  if (!writeAll(fd, req) || !readHead(fd, head, rest, CONNECT_MS)) { close(fd); return false; }
+  if (head.compare(0, 12, "HTTP/1.1 101") != 0) {
+    fprintf(stderr, "clickgitd: device refused the WebSocket: %s\n", head.substr(0, head.find('\r')).c_str());
+    close(fd);
+    return false;
+  }
+  if (headerValue(head, "Sec-WebSocket-Accept") != wsAccept(key)) {
+    fprintf(stderr, "clickgitd: bad Sec-WebSocket-Accept from device\n");
+    close(fd);
+    return false;
+  }
+  linkFd = fd;
+  linkRx = rest;
+  return true;
+}
+
+bool linkSend(const char* command) {
+  if (linkFd < 0) return false;
+  if (!writeAll(linkFd, wsFrame(WS_TEXT, command, true))) { linkClose("write failed"); return false; }
+  stats.commands++;
+  return true;
+}
+
+// Replies, pings from the button's heartbeat, close
+void linkReadable() {
+  char tmp[1024];
+  ssize_t n = recv(linkFd, tmp, sizeof(tmp), 0);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) { linkClose("device hung up"); return; }
+  if (n > 0) linkRx.append(tmp, n);
+  int opcode;
+  std::string payload;
+  while (linkFd >= 0 && wsNextFrame(linkRx, opcode, payload)) {
+    if (opcode == WS_TEXT) {
+      if (payload.find("\"error\"") != std::string::npos) {
+        stats.repliesError++;
+        fprintf(stderr, "clickgitd: device: %s\n", payload.c_str());
+      } else {
+        stats.repliesOk++;
+      }
+    } else if (opcode == WS_PING) {
+      if (!writeAll(linkFd, wsFrame(WS_PONG, payload, true))) linkClose("write failed");
+    } else if (opcode == WS_CLOSE) {
+      writeAll(linkFd, wsFrame(WS_CLOSE, "", true), 100);
+      linkClose("device closed");
+    }
+  }
+}
+
+// ── Daemon ──────────────────────────────────────────────────
+volatile sig_atomic_t stopping = 0, reportWanted = 0;
+
+void onSignal(int sig) {
+  if (sig == SIGUSR1) reportWanted = 1;
+  else stopping = 1;
+}
+
+struct Client { int fd; std::string buf; };
+
+// One line per client: "event <session> <name>" or "status"; returns the reply
+std::string handleLine(const std::string& line, uint64_t now, uint64_t& sendAt, int debounceMs) {
+  char session[128], event[64];
+  if (line == "status") return report();
+  if (sscanf(line.c_str(), "event %127s %63s", session, event) != 2) return "bad request\n";
+  stats.events++;
+  int state = stateForEvent(event);
+  if (state == -1) { stats.ignored++; return ""; }
+  SessionState before = mergedState();
+  if (state == -2) {
+    sessions.erase(session);
+  } else {
+    auto it = sessions.find(session);
+    if (it == sessions.end()) stats.sessionsSeen++;
+    sessions[session] = { (SessionState)state, now };
+  }
+  // The first change in a burst starts the clock; later ones ride along
+  if (mergedState() != before && !sendAt) sendAt = now + debounceMs;
+  return "";
+}
+
+int runDaemon(const Options& o) {
+  int lfd = listenUnix(o.socketPath);
+  if (lfd < 0) {
+    fprintf(stderr, "clickgitd: cannot listen on %s: %s\n", o.socketPath.c_str(), strerror(errno));
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGUSR1, onSignal);
+  fprintf(stderr, "clickgitd: listening on %s, device %s:%d\n", o.socketPath.c_str(), o.device.c_str(), o.port);
+
+  std::vector<Client> clients;
+  uint64_t sendAt = 0;
+  while (!stopping) {
+    uint64_t now = nowMs();
+    if (reportWanted) { reportWanted = 0; fputs(report().c_str(), stderr); }
+
+    // Drop sessions that went quiet without a SessionEnd
+    for (auto it = sessions.begin(); it != sessions.end();) {
+      if (now - it->second.lastSeen > (uint64_t)o.idleSec * 1000) {
+        it = sessions.erase(it);
+        stats.expired++;
+        if (!sendAt) sendAt = now;
+      } else {
+        ++it;
+      }
+    }
+
+    if (linkFd < 0 && now >= reconnectAt) {
+      if (linkOpen(o)) {
+        stats.connects++;
+        backoffMs = BACKOFF_MIN_MS;
+        fprintf(stderr, "clickgitd: connected to %s:%d\n", o.device.c_str(), o.port);
+        if (!sessions.empty() && !sendAt) sendAt = now; // Restore what it should show
+      } else {
+        stats.connectFailures++;
+        reconnectAt = nowMs() + backoffMs;
+        backoffMs = std::min(backoffMs * 2, BACKOFF_MAX_MS);
+      }
+      now = nowMs();
+    }
+
+    if (sendAt && now >= sendAt && linkFd >= 0) {
+      const char* want = STATE_COMMANDS[mergedState()];
+      if (want != lastSent && linkSend(want)) lastSent = want;
+      sendAt = 0;
+    }
+
+    std::vector<pollfd> fds;
+    fds.push_back({ lfd, POLLIN, 0 });
+    if (linkFd >= 0) fds.push_back({ linkFd, POLLIN, 0 });
+    for (auto& c : clients) fds.push_back({ c.fd, POLLIN, 0 });
+
+    uint64_t wake = now + 1000; // Session expiry needs no more than this
+    if (sendAt && linkFd >= 0) wake = std::min(wake, sendAt);
+    if (linkFd < 0) wake = std::min(wake, std::max(reconnectAt, now));
+    if (poll(fds.data(), fds.size(), (int)(wake - now)) < 0 && errno != EINTR) break;
+    now = nowMs();
+
+    size_t i = 0;
+    if (fds[i++].revents & POLLIN) {
+      int cfd;
+      while ((cfd = accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) clients.push_back({ cfd, "" });
+    }
+    if (linkFd >= 0 && fds[i++].revents) linkReadable();
+    for (; i < fds.size(); i++) {
+      if (!fds[i].revents) continue;
+      auto it = std::find_if(clients.begin(), clients.end(), [&](const Client& c) { return c.fd == fds[i].fd; });
+      char tmp[512];
+      ssize_t n = recv(it->fd, tmp, sizeof(tmp), 0);
+      if (n > 0 && it->buf.size() + n <= CLIENT_MAX) { it->buf.append(tmp, n); continue; }
+      if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+      // EOF (or oversized): the whole request is in
+      size_t nl;
+      while ((nl = it->buf.find('\n')) != std::string::npos) {
+        std::string reply = handleLine(it->buf.substr(0, nl), now, sendAt, o.debounceMs);
+        if (!reply.empty()) writeAll(it->fd, reply, 200);
+        it->buf.erase(0, nl + 1);
+      }
+      close(it->fd);
+      clients.erase(it);
+    }
+  }
+
+  fputs(report().c_str(), stderr);
+  for (auto& c : clients) close(c.fd);
+  if (linkFd >= 0) linkClose("shutting down");
+  close(lfd);
+  unlink(o.socketPath.c_str());
+  return 0;
+}
+
+// ── Hook side ───────────────────────────────────────────────
+// String value of a top-level key in the hook's JSON ("" if absent)
+std::string jsonString(const std::string& json, const char* key) {
+  std::string quoted = std::string("\"") + key + "\"";
+  size_t pos = json.find(quoted);
+  if (pos == std::string::npos) return "";
+  pos = json.find_first_not_of(" \t\r\n", pos + quoted.size());
+  if (pos == std::string::npos || json[pos] != ':') return "";
+  pos = json.find_first_not_of(" \t\r\n", pos + 1);
+  if (pos == std::string::npos || json[pos] != '"') return "";
+  std::string out;
+  for (size_t i = pos + 1; i < json.size() && json[i] != '"'; i++) {
+    if (json[i] == '\\' && i + 1 < json.size()) i++;
+    out += json[i];
+  }
+  return out;
+}
+
+bool validToken(const std::string& s) {
+  if (s.empty() || s.size() > 120) return false;
+  for (char c : s)
+    if (!isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') return false;
+  return true;
+}
+
+// Never fails the hook: no daemon means no LEDs, not a broken agent
+int runSend(const Options& o, int argc, char** argv) {
+  std::string session, event;
+  if (argc >= 2) {
+    session = argv[0];
+    event = argv[1];
+  } else {
+    std::string json;
+    char tmp[4096];
+    ssize_t n;
+    while ((n = read(0, tmp, sizeof(tmp))) > 0) json.append(tmp, n); // Drain it all so the agent never blocks
+    session = jsonString(json, "session_id");
+    event = jsonString(json, "hook_event_name");
+  }
+  if (!validToken(session) || !validToken(event)) return 0;
+  int fd = dialUnix(o.socketPath);
+  if (fd < 0) return 0;
+  writeAll(fd, "event " + session + " " + event + "\n", 200);
+  close(fd);
+  return 0;
+}
+
+int runStatus(const Options& o) {
+  int fd = dialUnix(o.socketPath);
+  if (fd < 0) { fprintf(stderr, "clickgitd: not running (%s)\n", o.socketPath.c_str()); return 1; }
+  writeAll(fd, "status\n");
+  shutdown(fd, SHUT_WR);
+  char tmp[1024];
+  ssize_t n;
+  while ((n = recv(fd, tmp, sizeof(tmp), 0)) > 0) fwrite(tmp, 1, n, stdout);
+  close(fd);
+  return 0;
+}
+
+// ── Mock device ─────────────────────────────────────────────
+// Speaks the button's WebSocket protocol on 127.0.0.1 and prints every
+// command with its arrival time, so the daemon can be tested without one
+struct MockClient { int fd; bool upgraded; std::string buf; };
+
+int runMock(const Options& o) {
+  int lfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  int one = 1;
+  setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(o.port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(lfd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(lfd, 8) != 0) {
+    fprintf(stderr, "clickgitd mock: cannot listen on port %d: %s\n", o.port, strerror(errno));
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  fprintf(stderr, "clickgitd mock: ws://127.0.0.1:%d/\n", o.port);
+
+  std::string auth = o.password.empty() ? "" : "Basic " + base64("admin:" + o.password);
+  uint64_t start = nowMs();
+  unsigned long commands = 0;
+  std::vector<MockClient> clients;
+  while (!stopping) {
+    std::vector<pollfd> fds;
+    fds.push_back({ lfd, POLLIN, 0 });
+    for (auto& c : clients) fds.push_back({ c.fd, POLLIN, 0 });
+    if (poll(fds.data(), fds.size(), 1000) < 0 && errno != EINTR) break;
+    if (fds[0].revents & POLLIN) {
+      int cfd = accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (cfd >= 0) clients.push_back({ cfd, false, "" });
+    }
+    for (size_t i = 1; i < fds.size(); i++) {
+      if (!fds[i].revents) continue;
+      MockClient& c = clients[i - 1];
+      char tmp[1024];
+      ssize_t n = recv(c.fd, tmp, sizeof(tmp), 0);
+      if (n <= 0) { close(c.fd); c.fd = -1; continue; }
+      c.buf.append(tmp, n);
+      if (!c.upgraded) {
+        size_t end = c.buf.find("\r\n\r\n");
+        if (end == std::string::npos) continue;
+        std::string head = c.buf.substr(0, end + 2);
+        c.buf.erase(0, end + 4);
+        if (!auth.empty() && headerValue(head, "Authorization") != auth) {
+          writeAll(c.fd, "HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\n\r\n");
+          printf("%7.3f 401\n", (nowMs() - start) / 1000.0);
+          fflush(stdout);
+          close(c.fd);
+          c.fd = -1;
+          continue;
+        }
+        writeAll(c.fd, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: " + wsAccept(headerValue(head, "Sec-WebSocket-Key")) + "\r\n\r\n");
+        c.upgraded = true;
+        printf("%7.3f connected\n", (nowMs() - start) / 1000.0);
+        fflush(stdout);
+        writeAll(c.fd, wsFrame(WS_PING, "", false)); // Like the button's heartbeat
+      }
+      int opcode;
+      std::string payload;
+      while (c.fd >= 0 && wsNextFrame(c.buf, opcode, payload)) {
+        if (opcode == WS_TEXT) {
+          commands++;
+          printf("%7.3f %s\n", (nowMs() - start) / 1000.0, payload.c_str());
+          fflush(stdout);
+          writeAll(c.fd, wsFrame(WS_TEXT, "{\"ok\":true}", false));
+        } else if (opcode == WS_CLOSE) {
+          close(c.fd);
+          c.fd = -1;
+        }
+      }
+    }
+    clients.erase(std::remove_if(clients.begin(), clients.end(), [](const MockClient& c) { return c.fd < 0; }),
+                  clients.end());
+  }
+  fprintf(stderr, "clickgit mock: %lu commands\n", commands);
+  return 0;
+}
+
+// ── Main ────────────────────────────────────────────────────
+int usage() {
+  fprintf(stderr,
+    "usage: clickgitd run [--device HOST] [--port N] [--socket PATH] [--debounce MS] [--idle S]\n"
+    "       clickgitd send [SESSION EVENT]\n"
+    "       clickgitd status [--socket PATH]\n"
+    "       clickgitd mock [--port N]\n"
+    "The button password is read from CLICKGIT_PASSWORD.\n");
+  return 2;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) return usage();
+  std::string mode = argv[1];
+  Options o;
+  o.socketPath = defaultSocketPath();
+  if (const char* pw = getenv("CLICKGIT_PASSWORD")) o.password = pw;
+  std::vector<char*> rest;
+  for (int i = 2; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (a == "--device" && hasValue) o.device = argv[++i];
+    else if (a == "--port" && hasValue) o.port = atoi(argv[++i]);
+    else if (a == "--socket" && hasValue) o.socketPath = argv[++i];
+    else if (a == "--debounce" && hasValue) o.debounceMs = atoi(argv[++i]);
+    else if (a == "--idle" && hasValue) o.idleSec = atoi(argv[++i]);
+    else if (a[0] != '-') rest.push_back(argv[i]);
+    else return usage();
+  }
+  if (mode == "run") return runDaemon(o);
+  if (mode == "send") return runSend(o, (int)rest.size(), rest.data());
+  if (mode == "status") return runStatus(o);
+  if (mode == "mock") return runMock(o);
+  return usage();
+}
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Runs clickgitd against its mock device: bursts of hook events from three
+# sessions must come out as one merged LED command per real change.
+#
+#   host/selftest.sh            (builds into a temp dir)
+#   CLICKGITD_BIN=./clickgitd host/selftest.sh
+set -e
+cd "$(dirname "$0")"
+TMP=$(mktemp -d)
+trap 'kill $DAEMON $MOCK 2>/dev/null; rm -rf "$TMP"' EXIT
+BIN=${CLICKGITD_BIN:-$TMP/clickgitd}
+[ -n "$CLICKGITD_BIN" ] || c++ -std=c++17 -O2 -Wall clickgitd.cpp -o "$BIN"
+
+PORT=$((20000 + $$ % 10000))
+SOCK="$TMP/sock"
+export CLICKGIT_PASSWORD=selftest
+"$BIN" mock --port $PORT > "$TMP/mock.log" 2>/dev/null & MOCK=$!
+sleep 0.2
+"$BIN" run --device 127.0.0.1 --port $PORT --socket "$SOCK" --debounce 100 2> "$TMP/daemon.log" & DAEMON=$!
+sleep 0.3
+
+hook() { printf '{"session_id":"%s","transcript_path":"/tmp/x","hook_event_name":"%s"}' "$1" "$2" | "$BIN" send --socket "$SOCK"; }
+
+# Three sessions start working at once: one spin
+for s in a b c; do hook $s UserPromptSubmit; hook $s PreToolUse; hook $s PostToolUse; done
+sleep 0.3
+# One asks for input while the others keep working: red wins
+hook b Notification; hook a PreToolUse; hook c PreToolUse; hook a PostToolUse
+sleep 0.3
+# It gets its answer: back to spin
+hook b PreToolUse; hook b PostToolUse
+sleep 0.3
+# Two finish, one still works: no change. Then the last finishes: green
+hook a Stop; hook c Stop; hook b PreToolUse
+sleep 0.3
+hook b Stop
+sleep 0.3
+# Events the daemon ignores, plain-argument form, then everyone leaves
+hook a SubagentStop; "$BIN" send a SessionEnd --socket "$SOCK"; hook b SessionEnd; hook c SessionEnd
+sleep 0.3
+"$BIN" status --socket "$SOCK" > "$TMP/status"
+
+cut -c9- "$TMP/mock.log" > "$TMP/got"
+cat > "$TMP/want" <<'WANT'
+connected
+color=blue&effect=spin
+color=red&effect=pulse
+color=blue&effect=spin
+color=green&timeout=60000
+color=off
+WANT
+if diff -u "$TMP/want" "$TMP/got"; then
+  cat "$TMP/status"
+  echo "ok      clickgitd"
+else
+  cat "$TMP/daemon.log"
+  echo "FAILED  clickgitd"
+  exit 1
+fi
@@ -0,0 +1,45 @@
+/*
+ * Host stand-in for Adafruit_NeoPixel (env:native only).
+ *
+ * Pixel storage and brightness scaling mirror the real library; show()
+ * writes the wire bytes to the trace as a timestamped "F" frame.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define NEO_GRB     ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_RGB     ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_KHZ800  0x0000
+
+typedef uint16_t neoPixelType;
+
+class Adafruit_NeoPixel {
+public:
+  Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800);
+  ~Adafruit_NeoPixel();
+
+  void begin() {}
+  void show();
+  void setPin(int16_t p) { pin_ = p; }
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+  void setPixelColor(uint16_t n, uint32_t c) { setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c); }
+  void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+  void setBrightness(uint8_t b);
+  void clear() { memset(pixels_, 0, numBytes_); }
+  uint32_t getPixelColor(uint16_t n) const;
+  uint8_t* getPixels() const { return pixels_; }
+  uint8_t getBrightness() const { return brightness_ - 1; }
+  uint16_t numPixels() const { return numLEDs_; }
+  int16_t getPin() const { return pin_; }
+
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+private:
+  uint16_t numLEDs_, numBytes_;
+  int16_t pin_;
+  uint8_t brightness_ = 0;
+  uint8_t* pixels_;
+};
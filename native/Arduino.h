@@ -0,0 +1,243 @@
+/*
+ * Host stand-in for the Arduino core (env:native only).
+ *
+ * Just enough of String, Print, Serial, GPIO and the clock for src/main.cpp
+ * to compile and run on Linux. Time is virtual: millis()/micros() read the
+ * simulator clock and delay() advances it, so traces are deterministic.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <string>
+#include <algorithm>
+
+using std::abs;
+
+#define HIGH 1
+#define LOW  0
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+#define IRAM_ATTR
+#define digitalPinToInterrupt(p) (p)
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define strlen_P strlen
+class __FlashStringHelper;
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define F(s) FPSTR(s)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// ── String ──────────────────────────────────────────────────
+class String {
+public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(const __FlashStringHelper* s) : s_(reinterpret_cast<const char*>(s)) {}
+  String(const std::string& s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v, unsigned char base = 10) { fmt(v, base); }
+  explicit String(unsigned int v, unsigned char base = 10) { fmt((long long)v, base); }
+  explicit String(long v, unsigned char base = 10) { fmt(v, base); }
+  explicit String(unsigned long v, unsigned char base = 10) { fmt((long long)v, base); }
+  explicit String(float v, unsigned int decimals = 2) { fmtf(v, decimals); }
+  explicit String(double v, unsigned int decimals = 2) { fmtf(v, decimals); }
+
+  unsigned int length() const { return s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  const char* c_str() const { return s_.c_str(); }
+  void reserve(unsigned int n) { s_.reserve(n); }
+
+  char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char& operator[](unsigned int i) { return s_[i]; }
+
+  String& operator=(const char* s) { s_ = s ? s : ""; return *this; }
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String& operator+=(const char* o) { s_ += o; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  String& operator+=(int v) { return *this += String(v); }
+  String& operator+=(unsigned long v) { return *this += String(v); }
+  bool concat(const String& o) { s_ += o.s_; return true; }
+
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+  bool operator!=(const String& o) const { return !(*this == o); }
+  bool operator!=(const char* o) const { return !(*this == o); }
+  bool equals(const String& o) const { return *this == o; }
+  bool equalsIgnoreCase(const String& o) const {
+    if (s_.size() != o.s_.size()) return false;
+    for (size_t i = 0; i < s_.size(); i++)
+      if (tolower((unsigned char)s_[i]) != tolower((unsigned char)o.s_[i])) return false;
+    return true;
+  }
+
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String& p) const {
+    return p.s_.size() <= s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const { return pos(s_.find(c, from)); }
+  int indexOf(const String& p, unsigned int from = 0) const { return pos(s_.find(p.s_, from)); }
+  int indexOf(const char* p, unsigned int from = 0) const { return pos(s_.find(p, from)); }
+  int lastIndexOf(char c) const { return pos(s_.rfind(c)); }
+  int lastIndexOf(const String& p) const { return pos(s_.rfind(p.s_)); }
+
+  String substring(unsigned int from) const { return substring(from, s_.size()); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    if (to > s_.size()) to = s_.size();
+    return String(s_.substr(from, to - from));
+  }
+
+  void replace(char find, char with) { std::replace(s_.begin(), s_.end(), find, with); }
+  void replace(const String& find, const String& with) {
+    if (find.s_.empty()) return;
+    size_t at = 0;
+    while ((at = s_.find(find.s_, at)) != std::string::npos) {
+      s_.replace(at, find.s_.size(), with.s_);
+      at += with.s_.size();
+    }
+  }
+  void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+    if (index < s_.size()) s_.erase(index, count);
+  }
+
+  void trim() {
+    size_t b = 0, e = s_.size();
+    while (b < e && isspace((unsigned char)s_[b])) b++;
+    while (e > b && isspace((unsigned char)s_[e - 1])) e--;
+    s_ = s_.substr(b, e - b);
+  }
+  void toLowerCase() { for (auto& c : s_) c = tolower((unsigned char)c); }
+  void toUpperCase() { for (auto& c : s_) c = toupper((unsigned char)c); }
+
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return atof(s_.c_str()); }
+
+  friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String& a, const char* b) { return String(a.s_ + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s_); }
+  friend String operator+(const String& a, char c) { return String(a.s_ + c); }
+
+private:
+  std::string s_;
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  void fmt(long long v, unsigned char base) {
+    char buf[72];
+    if (base == 10) snprintf(buf, sizeof(buf), "%lld", v);
+    else if (base == 16) snprintf(buf, sizeof(buf), "%llx", (unsigned long long)v);
+    else snprintf(buf, sizeof(buf), "%lld", v);
+    s_ = buf;
+  }
+  void fmtf(double v, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    s_ = buf;
+  }
+};
+
+// ── Print / Serial ──────────────────────────────────────────
+class Printable;
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t w = 0;
+    while (n--) w += write(*buf++);
+    return w;
+  }
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+  size_t print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned int v) { return print(String(v)); }
+  size_t print(long v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t print(double v, int d = 2) { return print(String(v, d)); }
+  size_t print(const Printable& p);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, format);
+    int n = vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, std::min((size_t)n, sizeof(buf) - 1));
+  }
+};
+
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+inline size_t Print::print(const Printable& p) { return p.printTo(*this); }
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+// ── Clock & GPIO (backed by the simulator) ──────────────────
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+// The handler runs from inside the clock advance that crosses a scripted
+// edge, with micros() reading the edge time, even mid-delay()
+void attachInterrupt(uint8_t pin, void (*fn)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+template <typename T, typename L, typename H>
+inline T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+// ── ESP ─────────────────────────────────────────────────────
+class EspClass {
+public:
+  [[noreturn]] void restart();
+  uint32_t getFreeHeap() { return 200000; }
+  uint32_t getMaxAllocHeap() { return 110000; }
+};
+extern EspClass ESP;
@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for ESPmDNS (env:native only).
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class MDNSResponder {
+public:
+  bool begin(const char* host) { (void)host; return true; }
+  void addService(const char* service, const char* proto, uint16_t port) { (void)service; (void)proto; (void)port; }
+};
+extern MDNSResponder MDNS;
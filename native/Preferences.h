@@ -0,0 +1,30 @@
+/*
+ * Host stand-in for the ESP32 Preferences (NVS) library (env:native only).
+ * Namespaces live in memory for the lifetime of the process.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false);
+  void end();
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putInt(const char* key, int32_t value);
+  size_t putString(const char* key, const String& value);
+  size_t putString(const char* key, const char* value) { return putString(key, String(value)); }
+  size_t putBytes(const char* key, const void* value, size_t len);
+
+  int32_t getInt(const char* key, int32_t defaultValue = 0);
+  String getString(const char* key, const String& defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+  String ns_;
+  bool open_ = false, readOnly_ = false;
+};
@@ -0,0 +1,14 @@
+/*
+ * Host stand-in for the ESP32-S3 USB stack (env:native only).
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class ESPUSB {
+public:
+  bool productName(const char* name) { (void)name; return true; }
+  bool manufacturerName(const char* name) { (void)name; return true; }
+  bool begin() { return true; }
+};
+extern ESPUSB USB;
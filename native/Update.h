@@ -0,0 +1,43 @@
+/*
+ * Host stand-in for the ESP32 Update library (env:native only).
+ * Accepts and counts bytes; nothing is flashed. With a declared size, writes
+ * past it and an early end() fail as they do on the device.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+
+class UpdateClass {
+public:
+  bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH) {
+    (void)command; size_ = size; progress_ = 0; error_ = 0; running_ = true; return true;
+  }
+  size_t write(uint8_t* data, size_t len) {
+    (void)data;
+    if (!running_ || error_) return 0;
+    if (size_ != UPDATE_SIZE_UNKNOWN && progress_ + len > size_) { error_ = 3; return 0; }
+    progress_ += len;
+    return len;
+  }
+  bool end(bool evenIfRemaining = false) {
+    running_ = false;
+    if (progress_ == 0) error_ = 1;
+    else if (size_ != UPDATE_SIZE_UNKNOWN && progress_ < size_ && !evenIfRemaining) error_ = 4;
+    return !error_;
+  }
+  void abort() { running_ = false; error_ = 2; }
+  bool hasError() { return error_ != 0; }
+  uint8_t getError() { return error_; }
+  void printError(Print& out) { out.printf("Update error %u\n", error_); }
+  bool isRunning() { return running_; }
+  size_t size() { return size_; }
+  size_t progress() { return progress_; }
+private:
+  size_t size_ = 0, progress_ = 0;
+  uint8_t error_ = 0;
+  bool running_ = false;
+};
+extern UpdateClass Update;
@@ -0,0 +1,106 @@
+/*
+ * Host stand-in for the ESP32 WebServer library (env:native only).
+ *
+ * Requests come from the scenario script instead of a socket. handleClient()
+ * serves at most one request that has "arrived" by the current virtual time,
+ * and every response is written to the trace as an "H" line.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
+
+#define HTTP_UPLOAD_BUFLEN 1436
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) : port_(port) {}
+  virtual ~WebServer() {}
+
+  void begin() {}
+  void enableDelay(bool) {}
+  void handleClient();
+
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn);
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn);
+  void onNotFound(THandlerFunction fn) { notFound_ = fn; }
+
+  String uri() { return currentUri_; }
+  HTTPMethod method() { return currentMethod_; }
+  String arg(const String& name);
+  String arg(int i);
+  String argName(int i);
+  int args() { return _currentArgCount; }
+  bool hasArg(const String& name);
+  // Authorization is always collected, as on the device
+  void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+  String header(const String& name);
+  bool hasHeader(const String& name);
+  HTTPUpload& upload() { return upload_; }
+  WiFiClient client() { return _currentClient; }
+  size_t clientContentLength() { return clientContentLength_; }
+
+  bool authenticate(const char* username, const char* password);
+  void requestAuthentication(HTTPAuthMethod mode = BASIC_AUTH, const char* realm = nullptr,
+                             const String& authFailMsg = String(""));
+
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t len) { contentLength_ = len; }
+  void send(int code, const char* content_type = nullptr, const String& content = String(""));
+  void send(int code, const String& content_type, const String& content) {
+    send(code, content_type.c_str(), content);
+  }
+  void send_P(int code, PGM_P content_type, PGM_P content);
+  void send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength);
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t len);
+  void sendContent_P(PGM_P content, size_t len) { sendContent(content, len); }
+
+protected:
+  struct RequestArgument { String key; String value; };
+  RequestArgument* _currentArgs = nullptr;
+  int _currentArgCount = 0;
+  RequestArgument* _currentHeaders = nullptr;
+  int _headerKeysCount = 0;
+  WiFiClient _currentClient;
+
+private:
+  struct Route { String uri; HTTPMethod method; THandlerFunction fn, ufn; };
+  int port_;
+  std::vector<Route> routes_;
+  THandlerFunction notFound_;
+  String currentUri_;
+  HTTPMethod currentMethod_ = HTTP_GET;
+  String currentAuth_;
+  std::vector<RequestArgument> argStore_;
+  std::vector<RequestArgument> headerStore_;
+  HTTPUpload upload_ = {};
+  size_t contentLength_ = CONTENT_LENGTH_UNKNOWN;
+  size_t clientContentLength_ = 0;
+  bool streaming_ = false;
+  int streamCode_ = 0;
+  std::string streamBody_;
+  unsigned long arrivedAt_ = 0;
+
+  void finishStream();
+};
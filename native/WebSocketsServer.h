@@ -0,0 +1,55 @@
+/*
+ * Host stand-in for links2004/WebSockets' WebSocketsServer (env:native only).
+ *
+ * A single scripted client: its first message connects it (checked against
+ * setAuthorization), and loop() delivers at most one message that has
+ * "arrived" by the current virtual time. Replies are traced as "W" lines.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG,
+} WStype_t;
+
+class WebSocketsServer {
+public:
+  typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)> WebSocketServerEvent;
+
+  explicit WebSocketsServer(uint16_t port, const String& origin = "", const String& protocol = "arduino")
+    : port_(port) { (void)origin; (void)protocol; }
+
+  void begin() {}
+  void loop();
+  void onEvent(WebSocketServerEvent cb) { event_ = cb; }
+
+  void setAuthorization(const char* user, const char* password) { auth_ = String(user) + ":" + password; }
+  void setAuthorization(const char* auth) { auth_ = auth; }
+  void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectCount) {
+    (void)pingInterval; (void)pongTimeout; (void)disconnectCount;
+  }
+
+  bool sendTXT(uint8_t num, const char* payload, size_t length = 0);
+  bool sendTXT(uint8_t num, const String& payload) { return sendTXT(num, payload.c_str(), payload.length()); }
+  void disconnect(uint8_t num);
+  uint8_t connectedClients(bool ping = false) { (void)ping; return connected_ ? 1 : 0; }
+
+private:
+  uint16_t port_;
+  WebSocketServerEvent event_;
+  String auth_;
+  bool connected_ = false;
+  unsigned long arrivedAt_ = 0;
+};
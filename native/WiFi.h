@@ -0,0 +1,62 @@
+/*
+ * Host stand-in for the ESP32 WiFi library (env:native only).
+ * The station "connects" to networks declared in the scenario script.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum {
+  WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_CONNECTION_LOST = 5, WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+class IPAddress : public Printable {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : o_{a, b, c, d} {}
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", o_[0], o_[1], o_[2], o_[3]);
+    return String(buf);
+  }
+  size_t printTo(Print& p) const override { return p.print(toString()); }
+  uint8_t operator[](int i) const { return o_[i]; }
+private:
+  uint8_t o_[4];
+};
+
+// A TCP connection the web server handed over (GET /events). Writes are
+// traced as they reach the scripted client; STALL and HANGUP script lines
+// make it stop reading or disconnect. The id is the request's arrival ms.
+class WiFiClient {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int id) : id_(id) {}
+  size_t write(const uint8_t* buf, size_t size);
+  bool connected();
+  void stop();
+  void setNoDelay(bool) {}
+  int fd() const { return id_; }
+  explicit operator bool() { return connected(); }
+private:
+  int id_ = 0;
+};
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { mode_ = m; return true; }
+  wifi_mode_t getMode() { return mode_; }
+  bool softAP(const char* ssid, const char* pass = nullptr) { (void)ssid; (void)pass; return true; }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  wl_status_t begin(const char* ssid, const char* pass = nullptr);
+  bool disconnect(bool wifioff = false) { (void)wifioff; connectAt_ = 0; return true; }
+  wl_status_t status();
+  IPAddress localIP() { return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress(); }
+  int8_t RSSI() { return status() == WL_CONNECTED ? -58 : 0; }
+private:
+  wifi_mode_t mode_ = WIFI_OFF;
+  unsigned long connectAt_ = 0; // Virtual ms at which the STA link comes up, 0 = never
+};
+extern WiFiClass WiFi;
@@ -0,0 +1,26 @@
+/*
+ * Host stand-in for the ESP32 WiFiUDP class (env:native only).
+ *
+ * Datagrams come from the scenario script. parsePacket() returns the next
+ * one that has "arrived" by the current virtual time; datagrams that arrived
+ * while the socket was not bound are discarded.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+
+class WiFiUDP {
+public:
+  uint8_t begin(uint16_t port) { port_ = port; boundAt_ = millis(); return 1; }
+  void stop() { port_ = 0; }
+  int parsePacket();
+  int read(uint8_t* buf, size_t len);
+  int available() { return (int)(packet_.size() - readPos_); }
+
+private:
+  uint16_t port_ = 0;
+  unsigned long boundAt_ = 0;
+  std::string packet_;
+  size_t readPos_ = 0;
+};
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Replays every scenario in native/scenarios and diffs its trace against
+# native/golden, then runs random tap timelines against the gesture model
+# (--fuzz). Pass --update to rewrite the golden files instead.
+#
+#   pio run -e native && native/check_golden.sh
+set -e
+cd "$(dirname "$0")"
+BIN=${CLICKGIT_NATIVE_BIN:-../.pio/build/native/program}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+status=0
+for s in scenarios/*.txt; do
+  name=$(basename "$s" .txt)
+  "$BIN" "$s" --trace "$OUT/$name.trace" 2>/dev/null
+  if [ "$1" = "--update" ]; then
+    cp "$OUT/$name.trace" "golden/$name.trace"
+    echo "updated $name"
+  elif diff -u "golden/$name.trace" "$OUT/$name.trace" > "$OUT/$name.diff"; then
+    echo "ok      $name"
+  else
+    echo "CHANGED $name"
+    head -40 "$OUT/$name.diff"
+    status=1
+  fi
+done
+if [ "$1" != "--update" ]; then
+  if "$BIN" --fuzz 2000 2> "$OUT/fuzz.log"; then
+    echo "ok      fuzz"
+  else
+    echo "FAILED  fuzz"
+    head -60 "$OUT/fuzz.log"
+    status=1
+  fi
+fi
+exit $status
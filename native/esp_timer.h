@@ -0,0 +1,9 @@
+/*
+ * Host stand-in for the ESP-IDF high-resolution timer (env:native only).
+ */
+#pragma once
+
+#include <cstdint>
+
+// Microseconds since boot on the simulator clock; never wraps
+int64_t esp_timer_get_time();
@@ -0,0 +1,1333 @@
+/*
+ * Implementation of the native HAL stand-ins and the scenario simulator.
+ */
+#include "sim.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <WebServer.h>
+#include <Update.h>
+#include <Preferences.h>
+#include <ESPmDNS.h>
+#include <Adafruit_NeoPixel.h>
+#include <WebSocketsServer.h>
+#include "USB.h"
+#include "USBHIDKeyboard.h"
+#include "mbedtls/md.h"
+#include "rom/miniz.h"
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+MDNSResponder MDNS;
+UpdateClass Update;
+ESPUSB USB;
+
+// ── Simulator state ─────────────────────────────────────────
+namespace sim {
+
+struct Edge { unsigned long at; int level; };
+
+static uint64_t clockUs = 0;
+static std::map<uint8_t, std::vector<Edge>> edges;
+static std::vector<Request> requests;     // Kept sorted by arrival
+static std::vector<Request> socketMessages;
+static std::vector<std::pair<unsigned long, std::string>> datagrams;
+static std::map<std::string, std::string> networks;
+static FILE* traceOut = stdout;
+static bool serialEcho = false;
+static unsigned long lastEventAt = 0, endAt = 0;
+
+struct PinIsr { void (*fn)(void); int mode; size_t next; int level; };
+static std::map<uint8_t, PinIsr> isrs;
+static uint64_t stepUs = 0;
+
+uint64_t nowUs() { return clockUs; }
+
+// Earliest edge still to come on a pin with an interrupt attached, so the
+// 1ms sleeps in between cost no more than moving the clock
+static uint64_t nextIsrUs = UINT64_MAX;
+
+static void findNextIsr() {
+  nextIsrUs = UINT64_MAX;
+  for (auto& it : isrs) {
+    auto& list = edges[it.first];
+    if (it.second.next < list.size()) nextIsrUs = std::min(nextIsrUs, (uint64_t)list[it.second.next].at * 1000);
+  }
+}
+
+// Fires attached pin interrupts for every edge the advance crosses, in
+// time order, with the clock parked on the edge while the handler runs
+void advanceUs(uint64_t us) {
+  uint64_t target = clockUs + us;
+  if (nextIsrUs > target) {
+    clockUs = target;
+    return;
+  }
+  for (;;) {
+    uint8_t pin = 0;
+    PinIsr* due = nullptr;
+    uint64_t dueUs = 0;
+    for (auto& it : isrs) {
+      auto& list = edges[it.first];
+      if (it.second.next >= list.size()) continue;
+      uint64_t at = (uint64_t)list[it.second.next].at * 1000;
+      if (at <= target && (!due || at < dueUs)) { pin = it.first; due = &it.second; dueUs = at; }
+    }
+    if (!due) break;
+    int level = edges[pin][due->next++].level;
+    if (level == due->level) continue; // Not an edge
+    due->level = level;
+    if (dueUs > clockUs) clockUs = dueUs;
+    if (due->mode == CHANGE || (due->mode == FALLING && level == LOW) || (due->mode == RISING && level == HIGH))
+      due->fn();
+  }
+  clockUs = target;
+  findNextIsr();
+}
+
+// Edges at or before the current time already happened
+void attachPinInterrupt(uint8_t pin, void (*fn)(void), int mode) {
+  PinIsr isr = { fn, mode, 0, HIGH };
+  auto& list = edges[pin];
+  while (isr.next < list.size() && (uint64_t)list[isr.next].at * 1000 <= clockUs) isr.level = list[isr.next++].level;
+  isrs[pin] = isr;
+  findNextIsr();
+}
+
+void scheduleEdge(unsigned long at, uint8_t pin, int level) {
+  auto& list = edges[pin];
+  list.push_back({at, level});
+  std::stable_sort(list.begin(), list.end(), [](const Edge& a, const Edge& b) { return a.at < b.at; });
+  lastEventAt = std::max(lastEventAt, at);
+  findNextIsr();
+}
+
+void scheduleRequest(const Request& r) {
+  auto it = std::upper_bound(requests.begin(), requests.end(), r,
+    [](const Request& a, const Request& b) { return a.at < b.at; });
+  requests.insert(it, r);
+  lastEventAt = std::max(lastEventAt, r.at);
+}
+
+void scheduleSocket(const Request& r) {
+  auto it = std::upper_bound(socketMessages.begin(), socketMessages.end(), r,
+    [](const Request& a, const Request& b) { return a.at < b.at; });
+  socketMessages.insert(it, r);
+  lastEventAt = std::max(lastEventAt, r.at);
+}
+
+void scheduleDatagram(unsigned long at, const std::string& bytes) {
+  auto it = std::upper_bound(datagrams.begin(), datagrams.end(), at,
+    [](unsigned long t, const std::pair<unsigned long, std::string>& d) { return t < d.first; });
+  datagrams.insert(it, {at, bytes});
+  lastEventAt = std::max(lastEventAt, at);
+}
+
+void addNetwork(const std::string& ssid, const std::string& pass) { networks[ssid] = pass; }
+
+// Held connections (WiFiClient). A stalled client stops reading, so only
+// a socket buffer's worth more is accepted; a hung-up one takes nothing.
+#define CLIENT_SOCKET_BUF 5744 // lwIP TCP_SND_BUF on the ESP32
+
+struct HeldClient {
+  unsigned long stallAt = ULONG_MAX, hangupAt = ULONG_MAX;
+  std::string method, uri;
+  unsigned long arrived = 0;
+  bool headerDone = false, closed = false;
+  size_t buffered = 0;  // Accepted since the stall
+  size_t stallRoom = CLIENT_SOCKET_BUF;
+  std::string pending;  // Received bytes not yet traced
+};
+static std::map<int, HeldClient> clients;
+
+void scheduleClient(unsigned long at, int id, bool hangup, size_t room) {
+  HeldClient& c = clients[id];
+  if (hangup) c.hangupAt = at;
+  else { c.stallAt = at; c.stallRoom = room; }
+  lastEventAt = std::max(lastEventAt, at);
+}
+
+void openClient(int id, const char* method, const String& uri, unsigned long arrived) {
+  HeldClient& c = clients[id];
+  c.method = method;
+  c.uri = uri.c_str();
+  c.arrived = arrived;
+}
+
+// The response head becomes an H line and each event an E line:
+// "E <ms> <client> <event> <data>" (": comment" for comment lines)
+static void traceClientBytes(int id, HeldClient& c) {
+  unsigned long now = millis();
+  if (!c.headerDone) {
+    size_t end = c.pending.find("\r\n\r\n");
+    if (end == std::string::npos) return;
+    int code = atoi(c.pending.c_str() + c.pending.find(' ') + 1);
+    trace("H %lu +%lu %s %s %d (stream)", now, now - c.arrived, c.method.c_str(), c.uri.c_str(), code);
+    c.pending.erase(0, end + 4);
+    c.headerDone = true;
+  }
+  size_t end;
+  while ((end = c.pending.find("\n\n")) != std::string::npos) {
+    std::string name, data, line;
+    std::istringstream ev(c.pending.substr(0, end));
+    while (std::getline(ev, line)) {
+      if (line.compare(0, 7, "event: ") == 0) name = line.substr(7);
+      else if (line.compare(0, 6, "data: ") == 0) data += line.substr(6);
+      else if (line[0] == ':') name = line;
+    }
+    trace("E %lu %d %s%s%s", now, id, name.c_str(), data.empty() ? "" : " ", data.c_str());
+    c.pending.erase(0, end + 2);
+  }
+}
+
+size_t clientWrite(int id, const uint8_t* buf, size_t size) {
+  HeldClient& c = clients[id];
+  unsigned long now = millis();
+  if (c.closed || now >= c.hangupAt) return 0;
+  if (now >= c.stallAt) {
+    size_t take = std::min(size, c.stallRoom - c.buffered);
+    c.buffered += take;
+    return take;
+  }
+  c.pending.append((const char*)buf, size);
+  traceClientBytes(id, c);
+  return size;
+}
+
+bool clientConnected(int id) {
+  auto it = clients.find(id);
+  return it != clients.end() && !it->second.closed && millis() < it->second.hangupAt;
+}
+
+void clientStop(int id) {
+  auto it = clients.find(id);
+  if (it == clients.end() || it->second.closed) return;
+  it->second.closed = true;
+  trace("E %lu %d closed", millis(), id);
+}
+
+bool networkPassword(const std::string& ssid, std::string& pass) {
+  auto it = networks.find(ssid);
+  if (it == networks.end()) return false;
+  pass = it->second;
+  return true;
+}
+
+int pinLevel(uint8_t pin) {
+  auto it = edges.find(pin);
+  int level = HIGH; // Pull-up idle
+  if (it == edges.end()) return level;
+  unsigned long now = millis();
+  for (auto& e : it->second) {
+    if (e.at > now) break;
+    level = e.level;
+  }
+  return level;
+}
+
+bool nextRequest(Request& out) {
+  if (requests.empty() || requests.front().at > millis()) return false;
+  out = requests.front();
+  requests.erase(requests.begin());
+  return true;
+}
+
+bool nextSocketMessage(Request& out) {
+  if (socketMessages.empty() || socketMessages.front().at > millis()) return false;
+  out = socketMessages.front();
+  socketMessages.erase(socketMessages.begin());
+  return true;
+}
+
+bool nextDatagram(std::string& out, unsigned long& at) {
+  if (datagrams.empty() || datagrams.front().first > millis()) return false;
+  at = datagrams.front().first;
+  out = datagrams.front().second;
+  datagrams.erase(datagrams.begin());
+  return true;
+}
+
+unsigned long scriptEnd() { return endAt ? endAt : lastEventAt + 2000; }
+uint64_t scriptStepUs() { return stepUs; }
+
+void setTrace(FILE* f) { traceOut = f; }
+bool tracing() { return traceOut != nullptr; }
+void setSerialEcho(bool on) { serialEcho = on; }
+
+// ── Heap allocations made by firmware handlers (--allocs) ───
+// Counted only while a route or WebSocket handler runs, and paused inside
+// the stand-ins' own output code, so the totals are what src/main.cpp asks
+// for itself. Short strings fit inline (no allocation) here as on the device.
+struct AllocStats { unsigned long calls = 0; uint64_t allocs = 0; };
+static std::map<std::string, AllocStats> allocStats;
+static bool allocCounting = false;
+static uint64_t allocCount = 0;
+
+struct AllocPause {
+  bool was = allocCounting;
+  AllocPause() { allocCounting = false; }
+  ~AllocPause() { allocCounting = was; }
+};
+
+struct AllocResume {
+  bool was = allocCounting;
+  AllocResume() { allocCounting = true; }
+  ~AllocResume() { allocCounting = was; }
+};
+
+template <typename Fn> static void countAllocs(const std::string& key, Fn fn) {
+  uint64_t before = allocCount;
+  allocCounting = true;
+  fn();
+  allocCounting = false;
+  AllocStats& st = allocStats[key];
+  st.calls++;
+  st.allocs += allocCount - before;
+}
+
+uint64_t allocsDuring(const std::function<void()>& fn) {
+  uint64_t before = allocCount;
+  allocCounting = true;
+  fn();
+  allocCounting = false;
+  return allocCount - before;
+}
+
+void printAllocReport(FILE* out) {
+  fprintf(out, "heap allocations per call (firmware code only):\n");
+  for (auto& it : allocStats)
+    fprintf(out, "  %-28s %6lu calls %8.2f/call\n", it.first.c_str(), it.second.calls,
+            (double)it.second.allocs / it.second.calls);
+}
+
+void trace(const char* fmt, ...) {
+  if (!traceOut) return;
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(traceOut, fmt, ap);
+  va_end(ap);
+  fputc('\n', traceOut);
+}
+
+static std::string unescape(const std::string& s) {
+  std::string out;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '\\' && i + 1 < s.size()) {
+      char c = s[++i];
+      out += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+    } else {
+      out += s[i];
+    }
+  }
+  return out;
+}
+
+// Script format, one directive per line ('#' starts a comment):
+//   pref int <key> <value>        preset an integer preference before boot
+//   pref str <key> <value...>     preset a string preference (\n escapes)
+//   wifi <ssid> <pass>            a network the station can join
+//   <ms> press|release [pin]      button edge (default pin 0, active low)
+//   <ms> tap [pin] [holdMs]       press, then release holdMs later (default 80)
+//   <ms> GET|POST|OPTIONS <uri> [body] [-u user:pass] [-t token] [-b cookie] [-e etag]
+//   <ms> UPLOAD <uri> <file> [-u user:pass] [-t token] [-n bytes]
+//                                 multipart POST of a file (path relative to
+//                                 the script), cut to its first n bytes
+//   <ms> STALL <client> [bytes]   held connection stops reading (client = its
+//                                 request's arrival ms, e.g. a GET /events);
+//                                 bytes it still buffers, default 5744
+//   <ms> HANGUP <client>          held connection disconnects
+//   <ms> NVSFULL [writes] [skip]  after skip more good ones, the next NVS
+//                                 writes (default 1) fail and leave the old
+//                                 value in place
+//   <ms> WS <text> [-u user:pass]   WebSocket text message (port 81)
+//   <ms> WSBIN <hex> [-u user:pass] WebSocket binary message
+//   <ms> WSCLOSE                    client closes the socket
+//   <ms> UDP <hex>                  raw datagram
+//   <ms> DDP <seq> <rrggbb...>      DDP v1 push packet, offset 0
+//   step <us>                     virtual time each loop() pass costs (default 1000)
+//   <ms> end                      stop the run at this time
+bool loadScript(const char* path, std::string& err) {
+  std::ifstream in(path);
+  if (!in) { err = std::string("cannot open ") + path; return false; }
+  std::string line;
+  int lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    size_t hash = line.find('#');
+    if (hash != std::string::npos && (hash == 0 || isspace((unsigned char)line[hash - 1])))
+      line.erase(hash);
+    std::istringstream ss(line);
+    std::string first;
+    if (!(ss >> first)) continue;
+
+    if (first == "pref") {
+      std::string type, key, value;
+      ss >> type >> key;
+      std::getline(ss >> std::ws, value);
+      if (type != "int" && type != "str") { err = "line " + std::to_string(lineNo) + ": pref int|str"; return false; }
+      presetPref(key, unescape(value), type == "int");
+      continue;
+    }
+    if (first == "step") {
+      ss >> stepUs;
+      continue;
+    }
+    if (first == "wifi") {
+      std::string ssid, pass;
+      ss >> ssid >> pass;
+      addNetwork(ssid, pass);
+      continue;
+    }
+
+    char* endp = nullptr;
+    unsigned long at = strtoul(first.c_str(), &endp, 10);
+    if (*endp) { err = "line " + std::to_string(lineNo) + ": expected time in ms"; return false; }
+    std::string cmd;
+    ss >> cmd;
+    if (cmd == "press" || cmd == "release") {
+      int pin = 0;
+      ss >> pin;
+      scheduleEdge(at, pin, cmd == "press" ? LOW : HIGH);
+    } else if (cmd == "tap") {
+      int pin = 0, hold = 80;
+      ss >> pin >> hold;
+      scheduleEdge(at, pin, LOW);
+      scheduleEdge(at + hold, pin, HIGH);
+    } else if (cmd == "GET" || cmd == "POST" || cmd == "OPTIONS") {
+      Request r;
+      r.at = at;
+      r.method = cmd;
+      ss >> r.uri;
+      std::string tok;
+      while (ss >> tok) {
+        if (tok == "-u") ss >> r.auth;
+        else if (tok == "-t") ss >> r.bearer;
+        else if (tok == "-b") ss >> r.cookie;
+        else if (tok == "-e") ss >> r.etag;
+        else r.body += tok;
+      }
+      scheduleRequest(r);
+    } else if (cmd == "UPLOAD") {
+      Request r;
+      r.at = at;
+      r.method = "POST";
+      r.upload = true;
+      ss >> r.uri >> r.fileName;
+      long cut = -1;
+      std::string tok;
+      while (ss >> tok) {
+        if (tok == "-u") ss >> r.auth;
+        else if (tok == "-t") ss >> r.bearer;
+        else if (tok == "-n") ss >> cut;
+      }
+      std::string dir = path;
+      dir.erase(dir.find_last_of('/') == std::string::npos ? 0 : dir.find_last_of('/') + 1);
+      std::ifstream f(dir + r.fileName, std::ios::binary);
+      if (!f) { err = "line " + std::to_string(lineNo) + ": cannot open " + dir + r.fileName; return false; }
+      r.file.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+      if (cut >= 0 && (size_t)cut < r.file.size()) r.file.resize(cut);
+      scheduleRequest(r);
+    } else if (cmd == "WS" || cmd == "WSBIN" || cmd == "WSCLOSE") {
+      Request r;
+      r.at = at;
+      r.method = cmd == "WS" ? "TEXT" : cmd == "WSBIN" ? "BIN" : "CLOSE";
+      std::string tok;
+      while (ss >> tok) {
+        if (tok == "-u") ss >> r.auth;
+        else r.body += tok;
+      }
+      if (r.method == "BIN") {
+        std::string bytes;
+        for (size_t i = 0; i + 1 < r.body.size(); i += 2)
+          bytes += (char)strtol(r.body.substr(i, 2).c_str(), nullptr, 16);
+        r.body = bytes;
+      }
+      scheduleSocket(r);
+    } else if (cmd == "UDP" || cmd == "DDP") {
+      std::string hex, tok;
+      int seq = 0;
+      if (cmd == "DDP") ss >> seq;
+      while (ss >> tok) hex += tok;
+      std::string bytes;
+      for (size_t i = 0; i + 1 < hex.size(); i += 2)
+        bytes += (char)strtol(hex.substr(i, 2).c_str(), nullptr, 16);
+      if (cmd == "DDP") {
+        char header[10] = { 0x41, (char)(seq & 0x0F), 0x0B, 0x01, 0, 0, 0, 0,
+                            (char)(bytes.size() >> 8), (char)(bytes.size() & 0xFF) };
+        bytes.insert(0, header, sizeof(header));
+      }
+      scheduleDatagram(at, bytes);
+    } else if (cmd == "STALL" || cmd == "HANGUP") {
+      int id = 0;
+      size_t room = CLIENT_SOCKET_BUF;
+      ss >> id >> room;
+      scheduleClient(at, id, cmd == "HANGUP", room);
+    } else if (cmd == "NVSFULL") {
+      int writes = 1, skip = 0;
+      ss >> writes >> skip;
+      scheduleNvsFull(at, writes, skip);
+    } else if (cmd == "end") {
+      endAt = at;
+    } else {
+      err = "line " + std::to_string(lineNo) + ": unknown command '" + cmd + "'";
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace sim
+
+// ── Arduino core ────────────────────────────────────────────
+void* operator new(size_t n) {
+  if (sim::allocCounting) sim::allocCount++;
+  if (void* p = malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+// Out of line so GCC doesn't pair the inlined free() with operator new
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (sim::serialEcho) fputc(c, stderr);
+  return 1;
+}
+
+unsigned long millis() { return (unsigned long)(sim::clockUs / 1000); }
+unsigned long micros() { return (unsigned long)sim::clockUs; }
+int64_t esp_timer_get_time() { return (int64_t)sim::clockUs; }
+void delay(unsigned long ms) { sim::advanceUs((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { sim::advanceUs(us); }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+int digitalRead(uint8_t pin) { return sim::pinLevel(pin); }
+void attachInterrupt(uint8_t pin, void (*fn)(void), int mode) { sim::attachPinInterrupt(pin, fn, mode); }
+void detachInterrupt(uint8_t pin) {
+  sim::isrs.erase(pin);
+  sim::findNextIsr();
+}
+void digitalWrite(uint8_t pin, uint8_t val) { (void)pin; (void)val; }
+
+static uint32_t rngState = 1;
+void randomSeed(unsigned long seed) { rngState = seed ? seed : 1; }
+long random(long max) {
+  rngState = rngState * 1103515245u + 12345u;
+  return max > 0 ? (long)((rngState >> 8) % (uint32_t)max) : 0;
+}
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+
+void EspClass::restart() {
+  sim::trace("R %lu restart", millis());
+  throw sim::Restart();
+}
+
+// ── WiFi ────────────────────────────────────────────────────
+wl_status_t WiFiClass::begin(const char* ssid, const char* pass) {
+  std::string expected;
+  bool ok = sim::networkPassword(ssid, expected) && expected == (pass ? pass : "");
+  connectAt_ = ok ? millis() + 1200 : 0; // Association + DHCP take ~1.2 s
+  return WL_DISCONNECTED;
+}
+
+wl_status_t WiFiClass::status() {
+  return connectAt_ && millis() >= connectAt_ ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+// ── Preferences ─────────────────────────────────────────────
+namespace {
+struct PrefValue { bool isInt; int32_t i; std::string bytes; };
+std::map<std::string, std::map<std::string, PrefValue>> nvs;
+struct NvsFull { int skip, fail; };
+std::map<unsigned long, NvsFull> nvsFull; // Script time -> writes to let through, then to fail
+
+// True (and one failure used up) when a scripted NVSFULL is due
+bool nvsWriteFails(const char* key) {
+  auto it = nvsFull.begin();
+  if (it == nvsFull.end() || it->first > millis()) return false;
+  if (it->second.skip > 0) { it->second.skip--; return false; }
+  if (--it->second.fail <= 0) nvsFull.erase(it);
+  sim::trace("N %lu full %s", millis(), key);
+  return true;
+}
+}
+
+void sim::scheduleNvsFull(unsigned long at, int writes, int skip) {
+  if (writes > 0) nvsFull[at] = NvsFull{ std::max(skip, 0), writes };
+}
+
+void sim::presetPref(const std::string& key, const std::string& value, bool isInt) {
+  nvs["btn"][key] = isInt ? PrefValue{true, (int32_t)atol(value.c_str()), ""} : PrefValue{false, 0, value};
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+  ns_ = name; open_ = true; readOnly_ = readOnly;
+  return true;
+}
+void Preferences::end() { open_ = false; }
+bool Preferences::clear() {
+  if (!open_ || readOnly_) return false;
+  nvs[ns_.c_str()].clear();
+  sim::trace("N %lu clear", millis());
+  return true;
+}
+bool Preferences::remove(const char* key) {
+  if (!open_ || readOnly_) return false;
+  if (nvs[ns_.c_str()].erase(key) == 0) return false;
+  sim::trace("N %lu remove %s", millis(), key);
+  return true;
+}
+bool Preferences::isKey(const char* key) {
+  return open_ && nvs[ns_.c_str()].count(key) > 0;
+}
+size_t Preferences::putInt(const char* key, int32_t value) {
+  if (!open_ || readOnly_ || nvsWriteFails(key)) return 0;
+  nvs[ns_.c_str()][key] = PrefValue{true, value, ""};
+  sim::trace("N %lu put %s 4", millis(), key);
+  return 4;
+}
+size_t Preferences::putString(const char* key, const String& value) {
+  if (!open_ || readOnly_ || nvsWriteFails(key)) return 0;
+  nvs[ns_.c_str()][key] = PrefValue{false, 0, value.c_str()};
+  sim::trace("N %lu put %s %u", millis(), key, value.length());
+  return value.length();
+}
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (!open_ || readOnly_ || nvsWriteFails(key)) return 0;
+  nvs[ns_.c_str()][key] = PrefValue{false, 0, std::string((const char*)value, len)};
+  sim::trace("N %lu put %s %zu", millis(), key, len);
+  return len;
+}
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+  auto& ns = nvs[ns_.c_str()];
+  auto it = ns.find(key);
+  return it != ns.end() && it->second.isInt ? it->second.i : defaultValue;
+}
+String Preferences::getString(const char* key, const String& defaultValue) {
+  auto& ns = nvs[ns_.c_str()];
+  auto it = ns.find(key);
+  return it != ns.end() && !it->second.isInt ? String(it->second.bytes) : defaultValue;
+}
+size_t Preferences::getBytesLength(const char* key) {
+  auto& ns = nvs[ns_.c_str()];
+  auto it = ns.find(key);
+  return it != ns.end() && !it->second.isInt ? it->second.bytes.size() : 0;
+}
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  size_t len = getBytesLength(key);
+  if (len == 0 || len > maxLen) return 0;
+  memcpy(buf, nvs[ns_.c_str()][key].bytes.data(), len);
+  return len;
+}
+
+// ── NeoPixel (GRB storage, same brightness math as the library) ─
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t pin, neoPixelType type)
+  : numLEDs_(n), numBytes_(n * 3), pin_(pin) {
+  (void)type;
+  pixels_ = (uint8_t*)calloc(numBytes_, 1);
+}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() { free(pixels_); }
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+  if (n >= numLEDs_) return;
+  if (brightness_) {
+    r = (r * brightness_) >> 8;
+    g = (g * brightness_) >> 8;
+    b = (b * brightness_) >> 8;
+  }
+  uint8_t* p = &pixels_[n * 3];
+  p[0] = g; p[1] = r; p[2] = b;
+}
+
+void Adafruit_NeoPixel::fill(uint32_t c, uint16_t first, uint16_t count) {
+  if (first >= numLEDs_) return;
+  uint16_t end = count == 0 ? numLEDs_ : std::min<uint16_t>(numLEDs_, first + count);
+  for (uint16_t i = first; i < end; i++) setPixelColor(i, c);
+}
+
+void Adafruit_NeoPixel::setBrightness(uint8_t b) {
+  uint8_t newBrightness = b + 1;
+  if (newBrightness == brightness_) return;
+  uint8_t oldBrightness = brightness_ - 1;
+  uint16_t scale;
+  if (oldBrightness == 0) scale = 0;
+  else if (b == 255) scale = 65535 / oldBrightness;
+  else scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+  for (uint16_t i = 0; i < numBytes_; i++) pixels_[i] = (pixels_[i] * scale) >> 8;
+  brightness_ = newBrightness;
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+  if (n >= numLEDs_) return 0;
+  const uint8_t* p = &pixels_[n * 3];
+  if (!brightness_) return Color(p[1], p[0], p[2]);
+  return Color((p[1] << 8) / brightness_, (p[0] << 8) / brightness_, (p[2] << 8) / brightness_);
+}
+
+void Adafruit_NeoPixel::show() {
+  if (!sim::tracing()) return;
+  char line[16 + 7 * 64];
+  int n = snprintf(line, sizeof(line), "p%d", pin_);
+  for (uint16_t i = 0; i < numLEDs_ && i < 64; i++) {
+    const uint8_t* p = &pixels_[i * 3];
+    n += snprintf(line + n, sizeof(line) - n, " %02x%02x%02x", p[1], p[0], p[2]);
+  }
+  sim::trace("F %lu %s", millis(), line);
+}
+
+// ── HID keyboard ────────────────────────────────────────────
+size_t USBHIDKeyboard::press(uint8_t k) { sim::trace("K %lu press 0x%02x", millis(), k); return 1; }
+size_t USBHIDKeyboard::release(uint8_t k) { sim::trace("K %lu release 0x%02x", millis(), k); return 1; }
+void USBHIDKeyboard::releaseAll() { sim::trace("K %lu releaseAll", millis()); }
+size_t USBHIDKeyboard::write(uint8_t c) {
+  if (c >= 0x20 && c < 0x7f && c != '\'') sim::trace("K %lu write '%c'", millis(), c);
+  else sim::trace("K %lu write 0x%02x", millis(), c);
+  return 1;
+}
+
+// ── WebServer ───────────────────────────────────────────────
+static std::string urlDecode(const std::string& s) {
+  std::string out;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '+') out += ' ';
+    else if (s[i] == '%' && i + 2 < s.size()) {
+      out += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    } else out += s[i];
+  }
+  return out;
+}
+
+static const char* methodName(HTTPMethod m) {
+  switch (m) {
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_OPTIONS: return "OPTIONS";
+    default: return "ANY";
+  }
+}
+
+// FNV-1a, so large bodies can be compared in golden traces without dumping them
+static uint32_t bodyHash(const char* p, size_t n) {
+  uint32_t h = 2166136261u;
+  while (n--) { h ^= (uint8_t)*p++; h *= 16777619u; }
+  return h;
+}
+
+static void traceResponse(unsigned long arrived, HTTPMethod m, const String& uri, int code,
+                          const char* body, size_t len, const String& location) {
+  unsigned long now = millis();
+  if (location.length())
+    sim::trace("H %lu +%lu %s %s %d -> %s", now, now - arrived, methodName(m), uri.c_str(), code, location.c_str());
+  else if (len <= 160 && !memchr(body, '\n', len))
+    sim::trace("H %lu +%lu %s %s %d %.*s", now, now - arrived, methodName(m), uri.c_str(), code, (int)len, body);
+  else
+    sim::trace("H %lu +%lu %s %s %d <%zu bytes #%08x>", now, now - arrived, methodName(m), uri.c_str(), code, len, bodyHash(body, len));
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn) {
+  routes_.push_back({uri, method, fn, nullptr});
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) {
+  routes_.push_back({uri, method, fn, ufn});
+}
+
+static String pendingLocation;
+
+static std::string base64(const std::string& in) {
+  static const char* ABC = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < in.size(); i += 3) {
+    uint32_t n = (uint8_t)in[i] << 16;
+    if (i + 1 < in.size()) n |= (uint8_t)in[i + 1] << 8;
+    if (i + 2 < in.size()) n |= (uint8_t)in[i + 2];
+    out += ABC[n >> 18 & 63];
+    out += ABC[n >> 12 & 63];
+    out += i + 1 < in.size() ? ABC[n >> 6 & 63] : '=';
+    out += i + 2 < in.size() ? ABC[n & 63] : '=';
+  }
+  return out;
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+  headerStore_.clear();
+  headerStore_.push_back({String("Authorization"), String()});
+  for (size_t i = 0; i < headerKeysCount; i++) headerStore_.push_back({String(headerKeys[i]), String()});
+  _currentHeaders = headerStore_.data();
+  _headerKeysCount = (int)headerStore_.size();
+}
+
+String WebServer::header(const String& name) {
+  for (int i = 0; i < _headerKeysCount; i++)
+    if (_currentHeaders[i].key.equalsIgnoreCase(name)) return _currentHeaders[i].value;
+  return String();
+}
+
+bool WebServer::hasHeader(const String& name) {
+  for (int i = 0; i < _headerKeysCount; i++)
+    if (_currentHeaders[i].key.equalsIgnoreCase(name)) return _currentHeaders[i].value.length() > 0;
+  return false;
+}
+
+void WebServer::handleClient() {
+  sim::Request req;
+  if (!sim::nextRequest(req)) return;
+
+  std::string path = req.uri, query = req.body;
+  size_t q = path.find('?');
+  if (q != std::string::npos) {
+    query = path.substr(q + 1) + (query.empty() ? "" : "&" + query);
+    path.erase(q);
+  }
+  argStore_.clear();
+  std::istringstream qs(query);
+  std::string pair;
+  while (std::getline(qs, pair, '&')) {
+    if (pair.empty()) continue;
+    size_t eq = pair.find('=');
+    std::string k = urlDecode(pair.substr(0, eq));
+    std::string v = eq == std::string::npos ? "" : urlDecode(pair.substr(eq + 1));
+    argStore_.push_back({String(k), String(v)});
+  }
+  _currentArgs = argStore_.data();
+  _currentArgCount = (int)argStore_.size();
+
+  currentUri_ = String(path);
+  currentMethod_ = req.method == "POST" ? HTTP_POST : req.method == "OPTIONS" ? HTTP_OPTIONS : HTTP_GET;
+  currentAuth_ = req.bearer.empty() ? String(req.auth) : String();
+  for (auto& h : headerStore_) {
+    std::string v;
+    if (h.key.equalsIgnoreCase("Authorization"))
+      v = !req.bearer.empty() ? "Bearer " + req.bearer : !req.auth.empty() ? "Basic " + base64(req.auth) : "";
+    else if (h.key.equalsIgnoreCase("Cookie"))
+      v = req.cookie;
+    else if (h.key.equalsIgnoreCase("If-None-Match"))
+      v = req.etag;
+    h.value = String(v);
+  }
+  arrivedAt_ = req.at;
+  _currentClient = WiFiClient((int)req.at);
+  sim::openClient((int)req.at, methodName(currentMethod_), currentUri_, req.at);
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  streaming_ = false;
+  pendingLocation = "";
+
+  clientContentLength_ = req.upload ? req.file.size() : req.body.size();
+
+  THandlerFunction handler = notFound_, uploader;
+  for (auto& r : routes_) {
+    if (r.uri == currentUri_ && (r.method == HTTP_ANY || r.method == currentMethod_)) {
+      handler = r.fn;
+      uploader = r.ufn;
+      break;
+    }
+  }
+  if (req.upload && uploader) {
+    // Same callback sequence as the device's multipart parser: START, one
+    // WRITE per full buffer (totalSize counts the bytes before it), END
+    sim::countAllocs(req.method + " " + path + " (upload)", [&]() {
+      sim::AllocPause pause;
+      upload_.filename = String(req.fileName);
+      upload_.name = "update";
+      upload_.type = "application/octet-stream";
+      upload_.totalSize = 0;
+      upload_.currentSize = 0;
+      upload_.status = UPLOAD_FILE_START;
+      { sim::AllocResume resume; uploader(); }
+      for (size_t off = 0; off < req.file.size(); off += HTTP_UPLOAD_BUFLEN) {
+        upload_.currentSize = std::min((size_t)HTTP_UPLOAD_BUFLEN, req.file.size() - off);
+        memcpy(upload_.buf, req.file.data() + off, upload_.currentSize);
+        upload_.status = UPLOAD_FILE_WRITE;
+        { sim::AllocResume resume; uploader(); }
+        upload_.totalSize += upload_.currentSize;
+      }
+      upload_.currentSize = 0;
+      upload_.status = UPLOAD_FILE_END;
+      { sim::AllocResume resume; uploader(); }
+    });
+  }
+  if (handler) sim::countAllocs(req.method + " " + path, handler);
+  if (streaming_) finishStream();
+  _currentArgs = nullptr;
+  _currentArgCount = 0;
+}
+
+String WebServer::arg(const String& name) {
+  for (int i = 0; i < _currentArgCount; i++)
+    if (_currentArgs[i].key == name) return _currentArgs[i].value;
+  return String();
+}
+
+String WebServer::arg(int i) { return i < _currentArgCount ? _currentArgs[i].value : String(); }
+String WebServer::argName(int i) { return i < _currentArgCount ? _currentArgs[i].key : String(); }
+
+bool WebServer::hasArg(const String& name) {
+  for (int i = 0; i < _currentArgCount; i++)
+    if (_currentArgs[i].key == name) return true;
+  return false;
+}
+
+bool WebServer::authenticate(const char* username, const char* password) {
+  sim::AllocPause pause;
+  return currentAuth_ == String(username) + ":" + password;
+}
+
+void WebServer::requestAuthentication(HTTPAuthMethod mode, const char* realm, const String& authFailMsg) {
+  (void)mode; (void)realm;
+  send(401, "text/html", authFailMsg);
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  sim::AllocPause pause;
+  (void)first;
+  if (name == "Location") pendingLocation = value;
+}
+
+void WebServer::send(int code, const char* content_type, const String& content) {
+  sim::AllocPause pause;
+  (void)content_type;
+  if (contentLength_ == CONTENT_LENGTH_UNKNOWN) {
+    streaming_ = true;
+    streamCode_ = code;
+    streamBody_.assign(content.c_str(), content.length());
+    return;
+  }
+  traceResponse(arrivedAt_, currentMethod_, currentUri_, code, content.c_str(), content.length(), pendingLocation);
+}
+
+void WebServer::send_P(int code, PGM_P content_type, PGM_P content) {
+  sim::AllocPause pause;
+  send(code, content_type, String(content));
+}
+
+void WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength) {
+  sim::AllocPause pause;
+  (void)content_type;
+  traceResponse(arrivedAt_, currentMethod_, currentUri_, code, content, contentLength, pendingLocation);
+}
+
+void WebServer::sendContent(const char* content, size_t len) {
+  sim::AllocPause pause;
+  if (!streaming_) return;
+  if (len == 0) { finishStream(); return; }
+  streamBody_.append(content, len);
+}
+
+void WebServer::finishStream() {
+  streaming_ = false;
+  traceResponse(arrivedAt_, currentMethod_, currentUri_, streamCode_, streamBody_.data(), streamBody_.size(), pendingLocation);
+}
+
+// ── WiFiClient ──────────────────────────────────────────────
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  sim::AllocPause pause;
+  return id_ ? sim::clientWrite(id_, buf, size) : 0;
+}
+bool WiFiClient::connected() { return id_ && sim::clientConnected(id_); }
+void WiFiClient::stop() { if (id_) sim::clientStop(id_); }
+
+// ── WiFiUDP ─────────────────────────────────────────────────
+int WiFiUDP::parsePacket() {
+  std::string next;
+  unsigned long at;
+  while (sim::nextDatagram(next, at)) {
+    if (!port_ || at < boundAt_) continue; // Nobody listening: the datagram is lost
+    packet_ = next;
+    readPos_ = 0;
+    return (int)packet_.size();
+  }
+  return 0;
+}
+
+int WiFiUDP::read(uint8_t* buf, size_t len) {
+  size_t n = std::min(len, packet_.size() - readPos_);
+  memcpy(buf, packet_.data() + readPos_, n);
+  readPos_ += n;
+  return (int)n;
+}
+
+// ── WebSocketsServer ────────────────────────────────────────
+void WebSocketsServer::loop() {
+  sim::Request msg;
+  if (!sim::nextSocketMessage(msg)) return;
+  arrivedAt_ = msg.at;
+
+  if (msg.method == "CLOSE") {
+    if (connected_) disconnect(0);
+    return;
+  }
+  if (!connected_) {
+    if (auth_.length() && auth_ != String(msg.auth)) {
+      sim::trace("W %lu +%lu 401", millis(), millis() - msg.at);
+      return;
+    }
+    connected_ = true;
+    sim::trace("W %lu +%lu connected", millis(), millis() - msg.at);
+    if (event_) event_(0, WStype_CONNECTED, nullptr, 0);
+  }
+  if (event_) {
+    std::string payload = msg.body;
+    sim::countAllocs("WS " + msg.method, [&]() {
+      event_(0, msg.method == "BIN" ? WStype_BIN : WStype_TEXT, (uint8_t*)&payload[0], payload.size());
+    });
+  }
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const char* payload, size_t length) {
+  sim::AllocPause pause;
+  (void)num;
+  if (!connected_) return false;
+  if (length == 0) length = strlen(payload);
+  unsigned long now = millis();
+  sim::trace("W %lu +%lu %.*s", now, now - arrivedAt_, (int)length, payload);
+  return true;
+}
+
+void WebSocketsServer::disconnect(uint8_t num) {
+  connected_ = false;
+  sim::trace("W %lu closed", millis());
+  if (event_) event_(num, WStype_DISCONNECTED, nullptr, 0);
+}
+
+// ── mbedTLS message digests (SHA-256) ───────────────────────
+static const uint32_t SHA256_K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t ror32(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+static void sha256Block(mbedtls_sha256_state& s, const uint8_t* p) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++) w[i] = (uint32_t)p[i * 4] << 24 | p[i * 4 + 1] << 16 | p[i * 4 + 2] << 8 | p[i * 4 + 3];
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = ror32(w[i - 15], 7) ^ ror32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = ror32(w[i - 2], 17) ^ ror32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = s.h[0], b = s.h[1], c = s.h[2], d = s.h[3], e = s.h[4], f = s.h[5], g = s.h[6], h = s.h[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t t1 = h + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+    uint32_t t2 = (ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+  }
+  s.h[0] += a; s.h[1] += b; s.h[2] += c; s.h[3] += d; s.h[4] += e; s.h[5] += f; s.h[6] += g; s.h[7] += h;
+}
+
+static void sha256Start(mbedtls_sha256_state& s) {
+  static const uint32_t IV[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+  memcpy(s.h, IV, sizeof(IV));
+  s.bytes = 0;
+}
+
+static void sha256Update(mbedtls_sha256_state& s, const uint8_t* p, size_t n) {
+  while (n--) {
+    s.block[s.bytes++ % 64] = *p++;
+    if (s.bytes % 64 == 0) sha256Block(s, s.block);
+  }
+}
+
+static void sha256Finish(mbedtls_sha256_state& s, uint8_t* out) {
+  uint64_t bits = s.bytes * 8;
+  uint8_t pad = 0x80;
+  sha256Update(s, &pad, 1);
+  pad = 0;
+  while (s.bytes % 64 != 56) sha256Update(s, &pad, 1);
+  for (int i = 7; i >= 0; i--) { uint8_t b = (uint8_t)(bits >> (i * 8)); sha256Update(s, &b, 1); }
+  for (int i = 0; i < 8; i++) {
+    out[i * 4] = s.h[i] >> 24; out[i * 4 + 1] = s.h[i] >> 16; out[i * 4 + 2] = s.h[i] >> 8; out[i * 4 + 3] = s.h[i];
+  }
+}
+
+static const mbedtls_md_info_t SHA256_INFO = { MBEDTLS_MD_SHA256, 32 };
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type) {
+  return type == MBEDTLS_MD_SHA256 ? &SHA256_INFO : nullptr;
+}
+void mbedtls_md_init(mbedtls_md_context_t* ctx) { memset(ctx, 0, sizeof(*ctx)); }
+void mbedtls_md_free(mbedtls_md_context_t* ctx) { memset(ctx, 0, sizeof(*ctx)); }
+int mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* info, int hmac) {
+  if (!info) return -1;
+  ctx->md_info = info;
+  ctx->hmac = hmac;
+  return 0;
+}
+int mbedtls_md_starts(mbedtls_md_context_t* ctx) { sha256Start(ctx->sha); return 0; }
+int mbedtls_md_update(mbedtls_md_context_t* ctx, const unsigned char* in, size_t n) { sha256Update(ctx->sha, in, n); return 0; }
+int mbedtls_md_finish(mbedtls_md_context_t* ctx, unsigned char* out) { sha256Finish(ctx->sha, out); return 0; }
+int mbedtls_md(const mbedtls_md_info_t* info, const unsigned char* in, size_t n, unsigned char* out) {
+  if (!info) return -1;
+  mbedtls_sha256_state s;
+  sha256Start(s);
+  sha256Update(s, in, n);
+  sha256Finish(s, out);
+  return 0;
+}
+int mbedtls_md_hmac_starts(mbedtls_md_context_t* ctx, const unsigned char* key, size_t keylen) {
+  if (!ctx->hmac) return -1;
+  uint8_t k[64] = {};
+  if (keylen > 64) mbedtls_md(ctx->md_info, key, keylen, k);
+  else memcpy(k, key, keylen);
+  for (int i = 0; i < 64; i++) { ctx->ipad[i] = k[i] ^ 0x36; ctx->opad[i] = k[i] ^ 0x5c; }
+  return mbedtls_md_hmac_reset(ctx);
+}
+int mbedtls_md_hmac_update(mbedtls_md_context_t* ctx, const unsigned char* in, size_t n) { return mbedtls_md_update(ctx, in, n); }
+int mbedtls_md_hmac_finish(mbedtls_md_context_t* ctx, unsigned char* out) {
+  uint8_t inner[32];
+  sha256Finish(ctx->sha, inner);
+  sha256Start(ctx->sha);
+  sha256Update(ctx->sha, ctx->opad, 64);
+  sha256Update(ctx->sha, inner, 32);
+  sha256Finish(ctx->sha, out);
+  return 0;
+}
+int mbedtls_md_hmac_reset(mbedtls_md_context_t* ctx) {
+  sha256Start(ctx->sha);
+  sha256Update(ctx->sha, ctx->ipad, 64);
+  return 0;
+}
+unsigned char mbedtls_md_get_size(const mbedtls_md_info_t* info) { return info ? info->size : 0; }
+
+// ── ROM inflater (tinfl) ────────────────────────────────────
+// A plain RFC 1950/1951 decoder in the style of zlib's contrib/puff. Each
+// tinfl_decompress() call inflates the whole buffered stream again; short
+// input and corrupt input are told apart by which exception ends the pass.
+namespace {
+
+struct InflateShort {};
+struct InflateBad {};
+struct InflateAdler {};
+
+struct Huffman {
+  short count[16];
+  short symbol[288];
+};
+
+struct Inflater {
+  const std::vector<uint8_t>& in;
+  std::vector<uint8_t>& out;
+  size_t pos = 0;
+  uint32_t bitBuf = 0;
+  int bitCnt = 0;
+
+  int bits(int n) {
+    uint32_t v = bitBuf;
+    while (bitCnt < n) {
+      if (pos >= in.size()) throw InflateShort();
+      v |= (uint32_t)in[pos++] << bitCnt;
+      bitCnt += 8;
+    }
+    bitBuf = v >> n;
+    bitCnt -= n;
+    return (int)(v & ((1u << n) - 1));
+  }
+
+  uint8_t byte() {
+    if (pos >= in.size()) throw InflateShort();
+    return in[pos++];
+  }
+
+  int decode(const Huffman& h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; len++) {
+      code |= bits(1);
+      int count = h.count[len];
+      if (code - count < first) return h.symbol[index + (code - first)];
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    throw InflateBad();
+  }
+
+  // Over-subscribed sets are rejected; incomplete ones are allowed as in puff
+  static void build(Huffman& h, const short* length, int n) {
+    short offs[16];
+    memset(h.count, 0, sizeof(h.count));
+    for (int s = 0; s < n; s++) h.count[length[s]]++;
+    if (h.count[0] == n) return;
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+      left = (left << 1) - h.count[len];
+      if (left < 0) throw InflateBad();
+    }
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + h.count[len];
+    for (int s = 0; s < n; s++)
+      if (length[s]) h.symbol[offs[length[s]]++] = (short)s;
+  }
+
+  void stored() {
+    bitBuf = 0;
+    bitCnt = 0;
+    unsigned len = byte();
+    len |= byte() << 8;
+    unsigned nlen = byte();
+    nlen |= byte() << 8;
+    if (len != (~nlen & 0xFFFF)) throw InflateBad();
+    while (len--) out.push_back(byte());
+  }
+
+  void codes(const Huffman& lencode, const Huffman& distcode) {
+    static const short LBASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                     35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const short LEXT[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const short DBASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                     193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                     6145, 8193, 12289, 16385, 24577 };
+    static const short DEXT[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    for (;;) {
+      int symbol = decode(lencode);
+      if (symbol < 256) { out.push_back((uint8_t)symbol); continue; }
+      if (symbol == 256) return;
+      symbol -= 257;
+      if (symbol >= 29) throw InflateBad();
+      size_t len = LBASE[symbol] + bits(LEXT[symbol]);
+      symbol = decode(distcode);
+      if (symbol >= 30) throw InflateBad();
+      size_t dist = DBASE[symbol] + bits(DEXT[symbol]);
+      if (dist > out.size()) throw InflateBad();
+      while (len--) out.push_back(out[out.size() - dist]);
+    }
+  }
+
+  void fixed() {
+    static Huffman lencode, distcode;
+    static bool built = false;
+    if (!built) {
+      short lengths[288];
+      int s = 0;
+      for (; s < 144; s++) lengths[s] = 8;
+      for (; s < 256; s++) lengths[s] = 9;
+      for (; s < 280; s++) lengths[s] = 7;
+      for (; s < 288; s++) lengths[s] = 8;
+      build(lencode, lengths, 288);
+      for (s = 0; s < 30; s++) lengths[s] = 5;
+      build(distcode, lengths, 30);
+      built = true;
+    }
+    codes(lencode, distcode);
+  }
+
+  void dynamic() {
+    static const short ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    short lengths[320];
+    int nlen = bits(5) + 257, ndist = bits(5) + 1, ncode = bits(4) + 4;
+    if (nlen > 286 || ndist > 30) throw InflateBad();
+    int i = 0;
+    for (; i < ncode; i++) lengths[ORDER[i]] = (short)bits(3);
+    for (; i < 19; i++) lengths[ORDER[i]] = 0;
+    Huffman lencode, distcode;
+    build(lencode, lengths, 19);
+    for (i = 0; i < nlen + ndist;) {
+      int symbol = decode(lencode);
+      if (symbol < 16) { lengths[i++] = (short)symbol; continue; }
+      short len = 0;
+      int repeat;
+      if (symbol == 16) {
+        if (i == 0) throw InflateBad();
+        len = lengths[i - 1];
+        repeat = 3 + bits(2);
+      } else if (symbol == 17) {
+        repeat = 3 + bits(3);
+      } else {
+        repeat = 11 + bits(7);
+      }
+      if (i + repeat > nlen + ndist) throw InflateBad();
+      while (repeat--) lengths[i++] = len;
+    }
+    if (lengths[256] == 0) throw InflateBad();
+    build(lencode, lengths, nlen);
+    build(distcode, lengths + nlen, ndist);
+    codes(lencode, distcode);
+  }
+
+  // Returns the offset just past the stream (and its Adler-32, for zlib)
+  size_t run(bool zlib, bool checkAdler) {
+    if (zlib) {
+      uint8_t cmf = byte(), flg = byte();
+      if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || (cmf << 8 | flg) % 31 || (flg & 0x20)) throw InflateBad();
+    }
+    int last;
+    do {
+      last = bits(1);
+      int type = bits(2);
+      if (type == 0) stored();
+      else if (type == 1) fixed();
+      else if (type == 2) dynamic();
+      else throw InflateBad();
+    } while (!last);
+    if (zlib) {
+      uint32_t want = (uint32_t)byte() << 24;
+      want |= (uint32_t)byte() << 16;
+      want |= (uint32_t)byte() << 8;
+      want |= byte();
+      uint32_t a = 1, b = 0;
+      for (uint8_t c : out) { a = (a + c) % 65521; b = (b + a) % 65521; }
+      if (checkAdler && want != (b << 16 | a)) throw InflateAdler();
+    }
+    return pos;
+  }
+};
+
+} // namespace
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const mz_uint8* pIn_buf_next, size_t* pIn_buf_size,
+                              mz_uint8* pOut_buf_start, mz_uint8* pOut_buf_next, size_t* pOut_buf_size,
+                              const mz_uint32 decomp_flags) {
+  sim::AllocPause pause;
+  (void)pOut_buf_start;
+  size_t given = *pIn_buf_size;
+  *pIn_buf_size = 0;
+  if (r->status == TINFL_STATUS_NEEDS_MORE_INPUT && given) {
+    r->in.insert(r->in.end(), pIn_buf_next, pIn_buf_next + given);
+    *pIn_buf_size = given;
+    r->out.clear();
+    Inflater inf{ r->in, r->out };
+    try {
+      size_t end = inf.run(decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER, decomp_flags & TINFL_FLAG_COMPUTE_ADLER32);
+      // Like the ROM, take up to 4 bytes past the end into the bit buffer
+      // and don't give them back
+      size_t ahead = std::min<size_t>(4, r->in.size() - end);
+      r->m_num_bits = (mz_uint32)ahead * 8;
+      *pIn_buf_size = given - (r->in.size() - end - ahead);
+      r->in.resize(end);
+      r->status = TINFL_STATUS_DONE;
+    } catch (InflateShort&) {
+      // Output stays partial; only what's safe to keep is handed out below
+    } catch (InflateBad&) {
+      r->status = TINFL_STATUS_FAILED;
+    } catch (InflateAdler&) {
+      r->status = TINFL_STATUS_ADLER32_MISMATCH;
+    }
+  }
+  if (r->status == TINFL_STATUS_FAILED || r->status == TINFL_STATUS_ADLER32_MISMATCH) {
+    *pOut_buf_size = 0;
+    return (tinfl_status)r->status;
+  }
+  size_t n = std::min(*pOut_buf_size, r->out.size() - r->returned);
+  memcpy(pOut_buf_next, r->out.data() + r->returned, n);
+  r->returned += n;
+  *pOut_buf_size = n;
+  if (r->returned < r->out.size()) return TINFL_STATUS_HAS_MORE_OUTPUT;
+  if (r->status == TINFL_STATUS_DONE) return TINFL_STATUS_DONE;
+  return (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED;
+}
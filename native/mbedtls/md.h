@@ -0,0 +1,41 @@
+/*
+ * Host stand-in for mbedTLS's generic message-digest API (env:native only).
+ *
+ * SHA-256 only, plain and HMAC, with the same call sequence as the real
+ * library so the firmware's digest code runs unchanged on the host.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+typedef enum { MBEDTLS_MD_NONE = 0, MBEDTLS_MD_SHA256 = 6 } mbedtls_md_type_t;
+
+struct mbedtls_md_info_t { mbedtls_md_type_t type; unsigned char size; };
+
+struct mbedtls_sha256_state {
+  uint32_t h[8];
+  uint64_t bytes;
+  uint8_t block[64];
+};
+
+typedef struct {
+  const mbedtls_md_info_t* md_info;
+  mbedtls_sha256_state sha;
+  uint8_t ipad[64], opad[64]; // HMAC key pads; only with hmac = 1
+  int hmac;
+} mbedtls_md_context_t;
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type);
+void mbedtls_md_init(mbedtls_md_context_t* ctx);
+void mbedtls_md_free(mbedtls_md_context_t* ctx);
+int mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* info, int hmac);
+int mbedtls_md_starts(mbedtls_md_context_t* ctx);
+int mbedtls_md_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t ilen);
+int mbedtls_md_finish(mbedtls_md_context_t* ctx, unsigned char* output);
+int mbedtls_md(const mbedtls_md_info_t* info, const unsigned char* input, size_t ilen, unsigned char* output);
+int mbedtls_md_hmac_starts(mbedtls_md_context_t* ctx, const unsigned char* key, size_t keylen);
+int mbedtls_md_hmac_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t ilen);
+int mbedtls_md_hmac_finish(mbedtls_md_context_t* ctx, unsigned char* output);
+int mbedtls_md_hmac_reset(mbedtls_md_context_t* ctx);
+unsigned char mbedtls_md_get_size(const mbedtls_md_info_t* info);
@@ -0,0 +1,56 @@
+/*
+ * Host stand-in for the ESP32 ROM's tinfl inflater (env:native only).
+ *
+ * Same calls, flags and statuses as the ROM's miniz.h. Unlike the ROM's
+ * fixed-size coroutine state, this keeps the compressed stream and inflates
+ * it again from the start on every call, handing out the bytes not yet
+ * returned. That is quadratic, but scenario images are small. At the end
+ * of the stream it swallows up to 4 bytes of what follows, as the ROM's
+ * bit buffer does, and reports them in m_num_bits.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+typedef uint8_t mz_uint8;
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+  TINFL_FLAG_HAS_MORE_INPUT = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+  TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_ADLER32_MISMATCH = -2,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+struct tinfl_decompressor {
+  std::vector<uint8_t> in;   // Everything passed in so far (up to the stream end)
+  std::vector<uint8_t> out;  // Inflated so far
+  size_t returned = 0;       // Bytes of out already handed out
+  int status = TINFL_STATUS_NEEDS_MORE_INPUT;
+  mz_uint32 m_num_bits = 0;  // Bits read ahead into the bit buffer
+};
+
+inline void tinfl_init(tinfl_decompressor* r) {
+  r->in.clear();
+  r->out.clear();
+  r->returned = 0;
+  r->m_num_bits = 0;
+  r->status = TINFL_STATUS_NEEDS_MORE_INPUT;
+}
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const mz_uint8* pIn_buf_next, size_t* pIn_buf_size,
+                              mz_uint8* pOut_buf_start, mz_uint8* pOut_buf_next, size_t* pOut_buf_size,
+                              const mz_uint32 decomp_flags);
@@ -0,0 +1,115 @@
+/*
+ * Native entry point: boots the firmware on the virtual clock and replays a
+ * scenario script against it.
+ *
+ *   program [script] [--trace FILE | --quiet] [--until MS] [--step-us US] [--serial] [--allocs]
+ *           [--frame-cost N]
+ *   program --fuzz N [--seed S] [--jobs J]
+ *
+ * The trace (stdout by default) is what native/golden/ holds; see
+ * native/check_golden.sh. --quiet drops it for perf/valgrind runs,
+ * --allocs reports heap allocations per request, and --frame-cost times N
+ * worst-case LED frames (every visible layer redrawn and composited) on the
+ * layers the script left on (see native/bench/). --fuzz replays N random
+ * button timelines against the tap/focus state machine (native/tap_fuzz.cpp).
+ */
+#include "sim.h"
+#include <chrono>
+#include <unistd.h>
+
+void setup();
+void loop();
+bool drawLayers(unsigned long now, bool redrawAll);
+void compositeLayers(uint8_t* out);
+int runTapFuzz(unsigned long cases, uint32_t seed, int jobs);
+
+int main(int argc, char** argv) {
+  const char* script = nullptr;
+  const char* tracePath = nullptr;
+  bool quiet = false, allocs = false;
+  unsigned long until = 0, frames = 0;
+  uint64_t stepUs = 0;
+  unsigned long fuzz = 0;
+  uint32_t seed = 1;
+  int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if (a == "--trace" && i + 1 < argc) tracePath = argv[++i];
+    else if (a == "--quiet") quiet = true;
+    else if (a == "--until" && i + 1 < argc) until = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--step-us" && i + 1 < argc) stepUs = strtoull(argv[++i], nullptr, 10);
+    else if (a == "--serial") sim::setSerialEcho(true);
+    else if (a == "--allocs") allocs = true;
+    else if (a == "--frame-cost" && i + 1 < argc) frames = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--fuzz" && i + 1 < argc) fuzz = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--seed" && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--jobs" && i + 1 < argc) jobs = atoi(argv[++i]);
+    else if (a[0] != '-' && !script) script = argv[i];
+    else {
+      fprintf(stderr, "usage: %s [script] [--trace FILE | --quiet] [--until MS] [--step-us US] [--serial] [--allocs] [--frame-cost N]\n"
+                      "       %s --fuzz N [--seed S] [--jobs J]\n", argv[0], argv[0]);
+      return 2;
+    }
+  }
+
+  if (fuzz) return runTapFuzz(fuzz, seed, jobs > 0 ? jobs : 1);
+
+  if (script) {
+    std::string err;
+    if (!sim::loadScript(script, err)) {
+      fprintf(stderr, "%s: %s\n", script, err.c_str());
+      return 2;
+    }
+  }
+  if (!until) until = script ? sim::scriptEnd() : 10000;
+  if (!stepUs) stepUs = sim::scriptStepUs() ? sim::scriptStepUs() : 1000;
+
+  FILE* traceFile = nullptr;
+  if (quiet) sim::setTrace(nullptr);
+  else if (tracePath) {
+    traceFile = fopen(tracePath, "w");
+    if (!traceFile) { perror(tracePath); return 2; }
+    sim::setTrace(traceFile);
+  }
+
+  auto wallStart = std::chrono::steady_clock::now();
+  unsigned long passes = 0;
+  try {
+    setup();
+    while (millis() < until) {
+      loop();
+      passes++;
+      sim::advanceUs(stepUs);
+    }
+  } catch (sim::Restart&) {
+    // ESP.restart() ends the scenario; the trace already has the "R" line
+  }
+  double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+
+  fprintf(stderr, "%lu virtual ms, %lu loop passes, %.1f ms wall (%.2f us/pass)\n",
+          millis(), passes, wallMs, passes ? wallMs * 1000.0 / passes : 0.0);
+  if (allocs) sim::printAllocReport(stderr);
+
+  if (frames) {
+    // Virtual time moves 20 ms a frame so every effect really animates
+    uint8_t out[64 * 3];
+    unsigned long t = millis();
+    auto frameStart = std::chrono::steady_clock::now();
+    for (unsigned long f = 0; f < frames; f++) {
+      drawLayers(t + f * 20, true);
+      compositeLayers(out);
+    }
+    double frameNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - frameStart).count();
+    uint64_t frameAllocs = sim::allocsDuring([&] {
+      for (unsigned long f = 0; f < frames; f++) {
+        drawLayers(t + f * 20, true);
+        compositeLayers(out);
+      }
+    });
+    fprintf(stderr, "%lu frames, %.0f ns/frame, %.2f heap allocations/frame\n",
+            frames, frameNs / frames, (double)frameAllocs / frames);
+  }
+  if (traceFile) fclose(traceFile);
+  return 0;
+}
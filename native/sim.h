@@ -0,0 +1,70 @@
+/*
+ * Host simulator behind the native HAL stand-ins (env:native only).
+ *
+ * Owns the virtual clock, the scripted inputs (button edges, HTTP requests,
+ * reachable WiFi networks, preset preferences) and the trace writer.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+struct Request {
+  unsigned long at;      // Virtual ms the request arrives
+  std::string method;    // GET, POST, OPTIONS
+  std::string uri;
+  std::string body;      // Form-encoded args (query string or POST body)
+  std::string auth;      // "user:pass" for Basic Auth, empty = none
+  std::string bearer;    // Authorization: Bearer token, overrides auth
+  std::string cookie;    // Cookie header value
+  std::string etag;      // If-None-Match header value
+  std::string file;      // Multipart file upload (UPLOAD), empty = none
+  std::string fileName;
+  bool upload = false;
+};
+// WebSocket messages reuse Request: method is TEXT, BIN or CLOSE and body
+// holds the payload (raw bytes for BIN).
+
+// Thrown by ESP.restart(); the runner stops the scenario when it sees it.
+struct Restart {};
+
+// Clock
+uint64_t nowUs();
+void advanceUs(uint64_t us);
+
+// Scripted inputs
+void scheduleEdge(unsigned long at, uint8_t pin, int level);
+void scheduleRequest(const Request& r);
+void scheduleSocket(const Request& r);
+void scheduleDatagram(unsigned long at, const std::string& bytes);
+void scheduleClient(unsigned long at, int id, bool hangup, size_t room); // STALL / HANGUP
+void scheduleNvsFull(unsigned long at, int writes, int skip); // NVSFULL
+void addNetwork(const std::string& ssid, const std::string& pass);
+void presetPref(const std::string& key, const std::string& value, bool isInt);
+bool loadScript(const char* path, std::string& err);
+unsigned long scriptEnd();
+uint64_t scriptStepUs(); // Loop pass cost from a "step" line, 0 = default
+
+// Trace output ("F" frames, "K" HID reports, "H" responses, "W" WebSocket
+// replies, "E" server-sent events, "N" NVS writes, "R" restarts)
+void setTrace(FILE* f);
+void trace(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+bool tracing();
+void setSerialEcho(bool on);
+void printAllocReport(FILE* out); // Heap allocations per route/WebSocket call
+uint64_t allocsDuring(const std::function<void()>& fn);
+
+// Used by the stand-ins
+int pinLevel(uint8_t pin);
+void attachPinInterrupt(uint8_t pin, void (*fn)(void), int mode);
+bool nextRequest(Request& out);
+bool nextSocketMessage(Request& out);
+bool nextDatagram(std::string& out, unsigned long& at);
+bool networkPassword(const std::string& ssid, std::string& pass);
+void openClient(int id, const char* method, const String& uri, unsigned long arrived);
+
+} // namespace sim
@@ -0,0 +1,380 @@
+/*
+ * Randomized button timelines against the tap/focus state machine (--fuzz).
+ *
+ * Boots the firmware once on the virtual clock, subscribes to GET /events,
+ * then forks a child per case from that snapshot. A child schedules random
+ * presses (contact bounce on both edges, long holds, the odd 10 s reset
+ * hold), HTTP calls in between and a random loop pass cost, runs them, and
+ * compares the button/focus/macro events it saw with a reference model of
+ * the gestures. Every event must also come within one loop pass of the time
+ * the model says it's due. A failing case prints as a script that replays
+ * it with the normal runner.
+ */
+#include "sim.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <random>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+namespace {
+
+// Same as src/main.cpp
+const unsigned long DEBOUNCE_MS = 50;
+const unsigned long TAP_WINDOW = 400;
+const unsigned long TAP_SETTLE = 600;
+const unsigned long SETUP_TIMEOUT = 10000;
+const unsigned long RESET_HOLD = 10000;
+
+const unsigned long SUBSCRIBE_AT = 100;
+const unsigned long SNAPSHOT_AT = 3000; // Boot indicator is off by now
+const unsigned long MARGIN = 3;         // Presses this close to a deadline are regenerated
+const char* MACRO = "TYPE x";           // Mode 1: a single tap runs it
+
+struct Press { unsigned long down, up; int bounceDown, bounceUp; };
+struct Event { unsigned long at; std::string what; };
+
+struct Case {
+  uint64_t stepUs = 1000;
+  std::vector<Press> presses;
+  std::vector<sim::Request> requests;
+  unsigned long end = 0;
+};
+
+// ── Reference model ─────────────────────────────────────────
+// What the firmware should do, from the press times alone. A press that
+// lands within MARGIN of a deadline makes the case ambiguous.
+enum State { IDLE, SETUP, ACTIVE };
+
+struct Model {
+  State state = IDLE;
+  int taps = 0;
+  unsigned long last = 0, setupStart = 0;
+  bool ambiguous = false;
+  std::vector<Event> out;
+
+  void emit(unsigned long at, const std::string& what) { out.push_back({at, what}); }
+
+  bool due(unsigned long& at) const {
+    if (taps > 0) { at = last + TAP_SETTLE + 1; return true; }
+    if (state == SETUP) { at = setupStart + SETUP_TIMEOUT + 1; return true; }
+    return false;
+  }
+
+  // Deadlines that pass before `t`
+  void runUntil(unsigned long t) {
+    unsigned long at;
+    while (due(at) && at <= t + MARGIN) {
+      if (at + MARGIN >= t) { ambiguous = true; return; }
+      if (taps > 0 && state == IDLE) {
+        emit(at, "button single");
+        emit(at, "macro start");
+      } else if (taps > 0 && state == SETUP) {
+        emit(at, "focus start " + std::to_string(taps * 20));
+        state = ACTIVE;
+      } else if (state == SETUP) {
+        emit(at, "focus end timeout");
+        state = IDLE;
+      }
+      taps = 0;
+    }
+  }
+
+  void press(unsigned long p) {
+    bool within = taps > 0 && p - last < TAP_WINDOW;
+    if (taps > 0 && (p - last + MARGIN >= TAP_WINDOW && p - last <= TAP_WINDOW + MARGIN)) ambiguous = true;
+    if (state == SETUP) {
+      taps++;
+      last = p;
+      emit(p, "button tap " + std::to_string(taps));
+    } else if (within) {
+      emit(p, "button double");
+      if (state == IDLE) {
+        emit(p, "focus setup");
+        state = SETUP;
+        setupStart = p;
+      } else {
+        emit(p, "focus end cancel");
+        state = IDLE;
+      }
+      taps = 0;
+      last = 0;
+    } else {
+      taps = 1;
+      last = p;
+    }
+  }
+
+  void run(const std::vector<Press>& presses) {
+    for (auto& pr : presses) {
+      runUntil(pr.down);
+      press(pr.down);
+      unsigned long holdAt = pr.down + RESET_HOLD + 1;
+      if (pr.up > holdAt) {
+        if (pr.up <= holdAt + MARGIN) ambiguous = true;
+        runUntil(holdAt);
+        emit(holdAt, "button hold");
+        return;
+      }
+    }
+    runUntil(ULONG_MAX - 2 * MARGIN);
+  }
+};
+
+// ── Case generator ──────────────────────────────────────────
+const char* const REQUESTS[][3] = {
+  { "GET", "/led", "" },
+  { "GET", "/state", "" },
+  { "GET", "/btn", "" },
+  { "GET", "/macro", "" },
+  { "POST", "/led", "color=red" },
+  { "POST", "/led", "color=blue&effect=spin" },
+  { "POST", "/led", "layer=notify&color=green&timeout=300" },
+};
+
+Case generate(std::minstd_rand& rng) {
+  auto pick = [&](unsigned long lo, unsigned long hi) {
+    return std::uniform_int_distribution<unsigned long>(lo, hi)(rng);
+  };
+  Case c;
+  // Mostly an idle loop; sometimes passes as slow as a busy handler
+  if (pick(0, 2) == 0) c.stepUs = pick(1, 60) * 1000;
+
+  int n = (int)pick(1, 9);
+  unsigned long t = SNAPSHOT_AT + pick(50, 500), lastUp = 0;
+  for (int i = 0; i < n; i++) {
+    if (i > 0) {
+      // Gap from the previous press: double-tap, the 400-600 ms dead zone,
+      // separate taps, or long enough for the setup timeout
+      unsigned long gap;
+      switch (pick(0, 11)) {
+        case 0: case 1: case 2: case 3: gap = pick(100, TAP_WINDOW); break;
+        case 4: case 5: gap = pick(TAP_WINDOW, TAP_SETTLE); break;
+        case 6: case 7: case 8: case 9: case 10: gap = pick(TAP_SETTLE, 2500); break;
+        default: gap = pick(2500, SETUP_TIMEOUT + 1500); break;
+      }
+      t = std::max(t + gap, lastUp + DEBOUNCE_MS + 20);
+    }
+    unsigned long hold = pick(0, 9) ? pick(DEBOUNCE_MS + 20, 250) : pick(250, 2000);
+    bool last = i == n - 1;
+    if (last && pick(0, 24) == 0) hold = pick(RESET_HOLD + 10, RESET_HOLD + 1500);
+    int bd = pick(0, 1) ? (int)pick(1, 4) : 0, bu = pick(0, 1) ? (int)pick(1, 4) : 0;
+    c.presses.push_back({t, t + hold, bd, bu});
+    lastUp = t + hold;
+  }
+
+  // A few HTTP calls anywhere among the presses
+  for (int i = (int)pick(0, 4); i > 0; i--) {
+    auto& r = REQUESTS[pick(0, sizeof(REQUESTS) / sizeof(REQUESTS[0]) - 1)];
+    sim::Request req;
+    req.at = pick(SNAPSHOT_AT, lastUp + 2000);
+    req.method = r[0];
+    req.uri = r[1];
+    req.body = r[2];
+    c.requests.push_back(req);
+  }
+  return c;
+}
+
+// Bounce: the contact chatters back and forth 1-3 ms apart before settling
+void scheduleEdges(const Press& p, std::minstd_rand& rng, std::vector<std::pair<unsigned long, int>>& out) {
+  auto chatter = [&](unsigned long at, int level, int times) {
+    out.push_back({at, level});
+    for (int i = 0; i < times; i++) {
+      at += 1 + rng() % 3;
+      out.push_back({at, !level});
+      at += 1 + rng() % 3;
+      out.push_back({at, level});
+    }
+  };
+  chatter(p.down, LOW, p.bounceDown);
+  chatter(p.up, HIGH, p.bounceUp);
+}
+
+// ── One case, in a forked child ─────────────────────────────
+// "E <ms> <client> <event> <json>" lines → "button double", "focus start 40"...
+std::string field(const std::string& json, const char* key) {
+  std::string k = std::string("\"") + key + "\":";
+  size_t at = json.find(k);
+  if (at == std::string::npos) return "";
+  at += k.size();
+  if (json[at] == '"') return json.substr(at + 1, json.find('"', at + 1) - at - 1);
+  return json.substr(at, json.find_first_of(",}", at) - at);
+}
+
+std::vector<Event> observed(const std::string& trace) {
+  std::vector<Event> out;
+  std::istringstream in(trace);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 2, "E ") != 0) continue;
+    std::istringstream ls(line.substr(2));
+    unsigned long at;
+    int client;
+    std::string name, json;
+    ls >> at >> client >> name;
+    std::getline(ls, json);
+    std::string what;
+    if (name == "button") {
+      what = "button " + field(json, "gesture");
+      if (!field(json, "count").empty()) what += " " + field(json, "count");
+    } else if (name == "focus") {
+      std::string state = field(json, "state");
+      if (state == "running") continue;
+      what = "focus " + state;
+      if (state == "start") what += " " + field(json, "minutes");
+      if (state == "end") what += " " + field(json, "reason");
+    } else if (name == "macro") {
+      if (field(json, "state") != "start") continue;
+      what = "macro start";
+    } else {
+      continue;
+    }
+    out.push_back({at, what});
+  }
+  return out;
+}
+
+std::string replayScript(const Case& c, const std::vector<std::pair<unsigned long, int>>& edges) {
+  std::ostringstream s;
+  s << "pref int mode 1\npref str macro " << MACRO << "\nstep " << c.stepUs << "\n"
+    << SUBSCRIBE_AT << " GET /events\n";
+  for (auto& e : edges) s << e.first << (e.second == LOW ? " press\n" : " release\n");
+  for (auto& r : c.requests) s << r.at << " " << r.method << " " << r.uri << (r.body.empty() ? "" : " ") << r.body << "\n";
+  s << c.end << " end\n";
+  return s.str();
+}
+
+// Writes "ok <worst ms late>" or a failure report to fd
+int runCase(uint32_t seed, unsigned long index, int fd) {
+  std::minstd_rand rng(seed * 1000003u + (uint32_t)index + 1);
+  Case c;
+  Model m;
+  do {
+    c = generate(rng);
+    m = Model();
+    m.run(c.presses);
+  } while (m.ambiguous);
+
+  std::vector<std::pair<unsigned long, int>> edges;
+  for (auto& p : c.presses) scheduleEdges(p, rng, edges);
+  for (auto& e : edges) sim::scheduleEdge(e.first, 0, e.second);
+  for (auto& r : c.requests) sim::scheduleRequest(r);
+  unsigned long lastEdge = edges.back().first;
+  c.end = std::max(lastEdge, m.out.empty() ? 0 : m.out.back().at) + c.stepUs / 1000 + 300;
+
+  char* buf = nullptr;
+  size_t len = 0;
+  FILE* trace = open_memstream(&buf, &len);
+  sim::setTrace(trace);
+  try {
+    while (millis() < c.end) {
+      loop();
+      sim::advanceUs(c.stepUs);
+    }
+  } catch (sim::Restart&) {
+  }
+  fclose(trace);
+  std::vector<Event> got = observed(std::string(buf, len));
+  free(buf);
+
+  // Edge-driven events may trail by a pass; deadline-driven ones by the
+  // pass that notices the deadline
+  unsigned long bound = (c.stepUs + 999) / 1000 + 2, worst = 0;
+  std::string why;
+  for (size_t i = 0; i < std::max(got.size(), m.out.size()) && why.empty(); i++) {
+    if (i >= got.size()) why = "missing \"" + m.out[i].what + "\" due at " + std::to_string(m.out[i].at);
+    else if (i >= m.out.size()) why = "unexpected \"" + got[i].what + "\" at " + std::to_string(got[i].at);
+    else if (got[i].what != m.out[i].what)
+      why = "got \"" + got[i].what + "\" at " + std::to_string(got[i].at) + ", expected \"" + m.out[i].what +
+            "\" due at " + std::to_string(m.out[i].at);
+    else if (got[i].at < m.out[i].at || got[i].at - m.out[i].at > bound)
+      why = "\"" + got[i].what + "\" at " + std::to_string(got[i].at) + ", due at " + std::to_string(m.out[i].at) +
+            " (allowed +" + std::to_string(bound) + " ms)";
+    else worst = std::max(worst, got[i].at - m.out[i].at);
+  }
+
+  std::string report;
+  if (why.empty()) {
+    report = "ok " + std::to_string(worst) + "\n";
+  } else {
+    report = "case " + std::to_string(index) + ": " + why + "\n  expected:";
+    for (auto& e : m.out) report += " " + std::to_string(e.at) + " " + e.what + ";";
+    report += "\n  got:     ";
+    for (auto& e : got) report += " " + std::to_string(e.at) + " " + e.what + ";";
+    report += "\n  replay:\n" + replayScript(c, edges);
+  }
+  for (size_t off = 0; off < report.size();) {
+    ssize_t n = write(fd, report.data() + off, report.size() - off);
+    if (n <= 0) return 1;
+    off += n;
+  }
+  return why.empty() ? 0 : 1;
+}
+
+struct Child { pid_t pid; int fd; unsigned long index; };
+
+} // namespace
+
+// Cases run `jobs` at a time; returns nonzero if any failed
+int runTapFuzz(unsigned long cases, uint32_t seed, int jobs) {
+  sim::presetPref("mode", "1", true);
+  sim::presetPref("macro", MACRO, false);
+  sim::Request sub;
+  sub.at = SUBSCRIBE_AT;
+  sub.method = "GET";
+  sub.uri = "/events";
+  sim::scheduleRequest(sub);
+  sim::setTrace(nullptr);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  setup();
+  while (millis() < SNAPSHOT_AT) {
+    loop();
+    sim::advanceUs(1000);
+  }
+  fflush(nullptr);
+
+  std::vector<Child> running;
+  unsigned long next = 0, failed = 0, worst = 0;
+  while (next < cases || !running.empty()) {
+    while (next < cases && (int)running.size() < jobs) {
+      int fds[2];
+      if (pipe(fds) != 0) { perror("pipe"); return 2; }
+      pid_t pid = fork();
+      if (pid < 0) { perror("fork"); return 2; }
+      if (pid == 0) {
+        close(fds[0]);
+        _exit(runCase(seed, next, fds[1]));
+      }
+      close(fds[1]);
+      running.push_back({pid, fds[0], next++});
+    }
+    // A finished child's report is already in its pipe (they're short)
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    auto ch = std::find_if(running.begin(), running.end(), [&](const Child& c) { return c.pid == pid; });
+    if (ch == running.end()) continue;
+    std::string out;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(ch->fd, buf, sizeof(buf))) > 0) out.append(buf, n);
+    close(ch->fd);
+    if (WIFEXITED(status) && out.compare(0, 3, "ok ") == 0) {
+      worst = std::max(worst, strtoul(out.c_str() + 3, nullptr, 10));
+    } else if (failed++ < 3) {
+      fputs(out.empty() ? ("case " + std::to_string(ch->index) + ": crashed\n").c_str() : out.c_str(), stderr);
+    }
+    running.erase(ch);
+  }
+
+  double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+  fprintf(stderr, "%lu cases (seed %u), %lu failed, worst %lu ms after due, %.0f ms wall (%.0f cases/s)\n",
+          cases, seed, failed, worst, wallMs, cases * 1000.0 / wallMs);
+  return failed ? 1 : 0;
+}
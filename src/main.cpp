@@ -10,13 +10,24 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <WiFiUdp.h>
 #include <WebServer.h>
 #include <Update.h>
 #include <Preferences.h>
 #include <ESPmDNS.h>
 #include <Adafruit_NeoPixel.h>
+#include <WebSocketsServer.h>
+#include <atomic>
+#include <esp_timer.h>
+#if defined(ESP32)
+#include <lwip/sockets.h>
+#endif
+#include "mbedtls/md.h"
+#include "rom/miniz.h"
+#include <new>
 #include "USB.h"
 #include "USBHIDKeyboard.h"
+#include "web_pages.h"
 
 // ── Defaults ────────────────────────────────────────────────
 #define FW_VERSION       "2.4.1"
@@ -30,12 +41,183 @@
 #define TAP_WINDOW       400    // Max ms between taps for multi-tap
 #define TAP_SETTLE       600    // Ms after last tap before processing
 #define SETUP_TIMEOUT    10000  // Focus setup timeout (10s)
+#define RESET_HOLD       10000  // Hold this long for a factory reset (10s)
+#define WS_PORT          81     // Persistent LED command channel
+#define DDP_PORT         4048   // Realtime frames (UDP, DDP)
+#define RT_TIMEOUT       2500   // Default ms of silence before /led state returns
+#define SESSION_TTL      86400  // Default seconds a /login token lives
+#define SESSION_TTL_MAX  (30 * 86400UL)
+
+// ── Text spans ──────────────────────────────────────────────
+// Borrowed view of request text (an arg value, a WebSocket payload), so
+// hot-path parsing never copies into a String
+struct Span {
+  const char* p = "";
+  size_t n = 0;
+};
+
+inline bool spanEq(Span s, const char* lit) { return strlen(lit) == s.n && memcmp(s.p, lit, s.n) == 0; }
+
+Span spanTrim(Span s) {
+  while (s.n && isspace((unsigned char)s.p[0])) { s.p++; s.n--; }
+  while (s.n && isspace((unsigned char)s.p[s.n - 1])) s.n--;
+  return s;
+}
+
+// Same rules as atol(): leading blanks, a sign, then digits
+long spanToLong(Span s) {
+  size_t i = 0;
+  while (i < s.n && isspace((unsigned char)s.p[i])) i++;
+  bool neg = i < s.n && s.p[i] == '-';
+  if (i < s.n && (s.p[i] == '-' || s.p[i] == '+')) i++;
+  long v = 0;
+  for (; i < s.n && s.p[i] >= '0' && s.p[i] <= '9'; i++) v = v * 10 + (s.p[i] - '0');
+  return neg ? -v : v;
+}
+
+// ── Metrics ─────────────────────────────────────────────────
+// Fixed-size counters and histograms for GET /metrics. Each one has a
+// single writer (main task, or the render task for strip timing); the
+// atomics only make scrapes from the other core see whole values.
+#define HIST_MAX_BUCKETS 12
+#define MAX_ROUTES       48
+#define RECENT_REQUESTS  16
+
+struct Histogram {
+  const uint32_t* bounds;  // Bucket upper bounds in µs, ascending
+  uint8_t buckets;
+  std::atomic<uint32_t> counts[HIST_MAX_BUCKETS + 1]; // Last one is +Inf
+  std::atomic<uint32_t> total;
+  std::atomic<uint64_t> sumUs;
+
+  Histogram(const uint32_t* b = nullptr, uint8_t n = 0) : bounds(b), buckets(n), counts{}, total{0}, sumUs{0} {}
+};
+
+void observe(Histogram& h, uint32_t us) {
+  uint8_t i = 0;
+  while (i < h.buckets && us > h.bounds[i]) i++;
+  h.counts[i].fetch_add(1, std::memory_order_relaxed);
+  h.total.fetch_add(1, std::memory_order_relaxed);
+  h.sumUs.fetch_add(us, std::memory_order_relaxed);
+}
+
+const uint32_t REQUEST_BOUNDS[] = { 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000 };
+const uint32_t LOOP_BOUNDS[]    = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000, 250000 };
+const uint32_t SHOW_BOUNDS[]    = { 100, 200, 300, 500, 1000, 2500, 10000 };
+#define BUCKETS(b) (uint8_t)(sizeof(b) / sizeof(b[0]))
+
+Histogram loopTime(LOOP_BOUNDS, BUCKETS(LOOP_BOUNDS));
+Histogram showTime(SHOW_BOUNDS, BUCKETS(SHOW_BOUNDS));
+std::atomic<uint32_t> focusSessions{0};
+std::atomic<uint32_t> macroRuns{0};
+std::atomic<uint32_t> staReconnects{0};
+
+// One slot per registered route; slot 0 collects unmatched requests
+struct RouteMetrics {
+  const char* uri;
+  HTTPMethod method;
+  std::atomic<uint32_t> byClass[4]; // 2xx, 3xx, 4xx, 5xx
+  Histogram latency;
+};
+RouteMetrics routeMetrics[MAX_ROUTES];
+uint8_t routeCount = 1;
+
+struct RecentRequest { uint8_t route; uint16_t status; uint32_t us; unsigned long at; };
+RecentRequest recentRequests[RECENT_REQUESTS];
+uint32_t recentNext = 0; // Total recorded; slot is recentNext % RECENT_REQUESTS
+
+void initRouteMetrics(int id, const char* uri, HTTPMethod method) {
+  RouteMetrics& r = routeMetrics[id];
+  r.uri = uri;
+  r.method = method;
+  r.latency.bounds = REQUEST_BOUNDS;
+  r.latency.buckets = BUCKETS(REQUEST_BOUNDS);
+}
+
+int addRouteMetrics(const char* uri, HTTPMethod method) {
+  if (routeCount >= MAX_ROUTES) return 0; // Counted with the unmatched ones
+  initRouteMetrics(routeCount, uri, method);
+  return routeCount++;
+}
+
+// WebServer that times every handler and remembers the status it sent.
+// on()/send() shadow the base versions, so routes and handlers are
+// written exactly as before.
+class MetricsWebServer : public WebServer {
+public:
+  using WebServer::WebServer;
+
+  void on(const char* uri, HTTPMethod method, THandlerFunction fn) {
+    int id = addRouteMetrics(uri, method);
+    WebServer::on(uri, method, [this, id, fn]() { timed(id, fn); });
+  }
+  void on(const char* uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) {
+    int id = addRouteMetrics(uri, method);
+    WebServer::on(uri, method, [this, id, fn]() { timed(id, fn); }, ufn);
+  }
+  void onNotFound(THandlerFunction fn) {
+    initRouteMetrics(0, "other", HTTP_ANY);
+    WebServer::onNotFound([this, fn]() { timed(0, fn); });
+  }
+
+  template <typename... Args> void send(int code, Args&&... args) {
+    status = code;
+    WebServer::send(code, std::forward<Args>(args)...);
+  }
+  template <typename... Args> void send_P(int code, Args&&... args) {
+    status = code;
+    WebServer::send_P(code, std::forward<Args>(args)...);
+  }
+  void requestAuthentication() {
+    status = 401;
+    WebServer::requestAuthentication();
+  }
+
+  // Takes over the connection (GET /events). The server forgets it rather
+  // than waiting up to 2 s for it to close before serving anyone else.
+  WiFiClient detachClient() {
+    status = 200;
+    WiFiClient c = _currentClient;
+    _currentClient = WiFiClient();
+    return c;
+  }
+
+  // Request argument without copying it into a String; empty if absent
+  Span argSpan(const char* name) {
+    for (int i = 0; i < _currentArgCount; i++)
+      if (_currentArgs[i].key == name) return { _currentArgs[i].value.c_str(), _currentArgs[i].value.length() };
+    return {};
+  }
+
+  // Collected header value without copying it into a String
+  const char* headerValue(const char* name) {
+    for (int i = 0; i < _headerKeysCount; i++)
+      if (strcasecmp(_currentHeaders[i].key.c_str(), name) == 0) return _currentHeaders[i].value.c_str();
+    return nullptr;
+  }
+
+private:
+  int status = 0;
+
+  void timed(int id, const THandlerFunction& fn) {
+    status = 0;
+    uint32_t start = micros();
+    fn();
+    uint32_t us = micros() - start;
+    RouteMetrics& r = routeMetrics[id];
+    r.byClass[constrain(status / 100, 2, 5) - 2].fetch_add(1, std::memory_order_relaxed);
+    observe(r.latency, us);
+    recentRequests[recentNext++ % RECENT_REQUESTS] = { (uint8_t)id, (uint16_t)status, us, millis() };
+  }
+};
 
 // ── Globals ─────────────────────────────────────────────────
-WebServer server(80);
+MetricsWebServer server(80);
+WebSocketsServer webSocket(WS_PORT);
+WiFiUDP ddp;
 Preferences prefs;
 USBHIDKeyboard Keyboard;
-Adafruit_NeoPixel* strip = nullptr;
+Adafruit_NeoPixel* strip = nullptr; // Owned by the renderer
 
 int ledPin, btnPin;
 int currentMode = 0;
@@ -46,15 +228,45 @@ String authPassword = ""; // Empty = no auth required
 
 bool lastBtnState = HIGH;
 unsigned long lastDebounce = 0;
-unsigned long ledAutoOff = 0;
 bool staConnected = false;
 
-// Animation state
-enum LedEffect { EFFECT_SOLID, EFFECT_SPIN, EFFECT_PULSE, EFFECT_PARTY, EFFECT_FOCUS_START, EFFECT_FOCUS };
-LedEffect currentEffect = EFFECT_SOLID;
-uint8_t effectR = 0, effectG = 0, effectB = 0;
-unsigned long lastEffectUpdate = 0;
-int effectPos = 0;
+// LED layers (main task; handed to the renderer by publishLeds). Each
+// layer runs its own effect; the renderer blends the ones that are on,
+// bottom to top, into one frame.
+enum LedEffect { EFFECT_SOLID, EFFECT_SPIN, EFFECT_PULSE, EFFECT_PARTY, EFFECT_FOCUS_START, EFFECT_FOCUS, EFFECT_FRAME, EFFECT_TIMELINE };
+const char* const EFFECT_NAMES[] = {"solid", "spin", "pulse", "party", "focus", "focus", "frame", "timeline"};
+enum LedLayer {
+  LAYER_STATUS,   // Top of the /led status stack
+  LAYER_LOCAL,    // Boot, WiFi, party, macros, pin tests, OTA
+  LAYER_REALTIME, // UDP frames
+  LAYER_FOCUS,    // Focus setup and countdown
+  LAYER_ALARM,    // Focus time's up
+  LAYER_NOTIFY,   // /led layer=notify, factory reset
+  LAYER_COUNT
+};
+const char* const LAYER_NAMES[LAYER_COUNT] = {"status", "local", "realtime", "focus", "alarm", "notify"};
+enum LayerBlend : uint8_t { BLEND_REPLACE, BLEND_ADD, BLEND_ALPHA };
+#define ALL_PIXELS ((1u << NUM_LEDS) - 1)
+
+struct Layer {
+  bool on;
+  LedEffect effect;
+  LayerBlend blend;
+  uint8_t alpha;               // BLEND_ALPHA opacity, 255 = opaque
+  uint32_t mask;               // Bit i set = the layer covers LED i
+  uint8_t r, g, b;
+  uint8_t timeline;            // Slot played by EFFECT_TIMELINE (status layer only)
+  uint8_t frame[NUM_LEDS][3];  // Explicit pixels for EFFECT_FRAME
+};
+Layer layers[LAYER_COUNT];
+uint32_t layerGen[LAYER_COUNT]; // Bumped on every change; restarts that layer's animation
+int ledOutPin = DEFAULT_LED_PIN; // Data pin the renderer drives
+
+// Realtime frames (UDP) shown over the effect until the sender goes quiet
+bool realtimeEnabled = false;
+int realtimeTimeout = RT_TIMEOUT;
+bool realtimeActive = false;
+uint8_t realtimeFrame[NUM_LEDS][3];
 
 // Focus timer state
 unsigned long focusStartTime = 0;
@@ -67,202 +279,1020 @@ int tapCount = 0;
 unsigned long lastTapTime = 0;
 unsigned long focusSetupStart = 0;
 
+// ── Scheduler ───────────────────────────────────────────────
+// loop() does one pass, then sleeps until the earliest deadline any
+// subsystem asked for with wakeAt(), a button edge, or IDLE_POLL_MS. The
+// web server, WebSocket and UDP listeners can only be polled, so the cap
+// bounds their latency; everything with a timer wakes exactly on time.
+#define IDLE_POLL_MS     10
+#define REALTIME_POLL_MS 2    // While DDP frames are streaming in
+
+unsigned long schedNext = 0;     // Earliest deadline registered this pass
+uint32_t loopWakeups = 0;
+uint64_t loopIdleUs = 0;         // Time spent blocked between passes
+uint32_t wakeupsPerSec = 0;      // Over the last full second
+uint8_t idlePct = 0;
+unsigned long schedWindowStart = 0;
+uint32_t schedWindowWakeups = 0;
+uint64_t schedWindowIdleUs = 0;
+#if defined(ESP32)
+TaskHandle_t loopTaskHandle = nullptr;
+#else
+volatile bool schedWoken = false;
+#endif
+
+// Deadline in millis(); the pass that runs at `at` must find the timer due
+void wakeAt(unsigned long at) {
+  if ((long)(at - schedNext) < 0) schedNext = at;
+}
+
+// Cuts the current sleep short (button ISR)
+void IRAM_ATTR schedWakeFromIsr() {
+#if defined(ESP32)
+  if (!loopTaskHandle) return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(loopTaskHandle, &woken);
+  if (woken) portYIELD_FROM_ISR();
+#else
+  schedWoken = true;
+#endif
+}
+
+// Blocks until the deadlines registered by the previous pass are due.
+// The native build sleeps in 1ms slices so an edge can end it early.
+void schedWait() {
+  long wait = (long)(schedNext - millis());
+  if (wait > 0) {
+    uint32_t start = micros();
+#if defined(ESP32)
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+#else
+    while (wait-- > 0 && !schedWoken) delay(1);
+    schedWoken = false; // Taken, like the notification (one given mid-pass ends the next sleep at once)
+#endif
+    loopIdleUs += (uint32_t)(micros() - start);
+  }
+  loopWakeups++;
+  unsigned long now = millis();
+  schedNext = now + IDLE_POLL_MS;
+
+  unsigned long span = now - schedWindowStart;
+  if (span >= 1000) {
+    wakeupsPerSec = (loopWakeups - schedWindowWakeups) * 1000UL / span;
+    idlePct = (uint8_t)std::min<uint64_t>(100, (loopIdleUs - schedWindowIdleUs) / (span * 10));
+    schedWindowStart = now;
+    schedWindowWakeups = loopWakeups;
+    schedWindowIdleUs = loopIdleUs;
+  }
+}
+
 // ── Color helpers ───────────────────────────────────────────
 struct NamedColor { const char* name; uint8_t r, g, b; };
-const NamedColor COLORS[] = {
+constexpr NamedColor COLORS[] = {
   {"red",255,0,0}, {"green",0,255,0}, {"blue",0,0,255},
   {"yellow",255,255,0}, {"magenta",255,0,255}, {"cyan",0,255,255},
   {"white",255,255,255}, {"orange",255,165,0}, {"purple",128,0,128},
   {"emerald",16,185,129}, {"off",0,0,0},
 };
+constexpr int BUILTIN_COLORS = sizeof(COLORS) / sizeof(COLORS[0]);
 
-void setAllLeds(uint8_t r, uint8_t g, uint8_t b) {
-  if (!strip) return;
-  for (int i = 0; i < NUM_LEDS; i++)
-    strip->setPixelColor(i, strip->Color(r, g, b));
-  strip->show();
+// User palette: extra names saved in config (POST /palette)
+#define PALETTE_MAX    16
+#define COLOR_NAME_MAX 15
+struct PaletteColor { char name[COLOR_NAME_MAX + 1]; uint8_t r, g, b; };
+PaletteColor palette[PALETTE_MAX];
+int paletteCount = 0;
+
+// Names resolve through one open-addressed table. The built-ins are placed
+// at compile time with a hash seed searched so each gets its own slot (a
+// perfect hash: one probe, one compare); palette names are added at runtime
+// and probe on from their hash. Slot values: 0 empty, 1..BUILTIN_COLORS a
+// built-in, PALETTE_SLOT + i palette entry i.
+#define COLOR_SLOTS  64 // Power of two
+#define PALETTE_SLOT 0x80
+
+constexpr char lowerAscii(char c) { return c >= 'A' && c <= 'Z' ? c + 32 : c; }
+
+constexpr size_t nameLength(const char* s) {
+  size_t n = 0;
+  while (s[n]) n++;
+  return n;
+}
+
+// FNV-1a over the lowercased name
+constexpr uint32_t colorHash(const char* s, size_t n, uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;
+  for (size_t i = 0; i < n; i++) { h ^= (uint8_t)lowerAscii(s[i]); h *= 16777619u; }
+  return h;
+}
+
+constexpr uint32_t findColorSeed() {
+  for (uint32_t seed = 0;; seed++) {
+    bool used[COLOR_SLOTS] = {};
+    bool clash = false;
+    for (const NamedColor& c : COLORS) {
+      uint32_t slot = colorHash(c.name, nameLength(c.name), seed) & (COLOR_SLOTS - 1);
+      clash |= used[slot];
+      used[slot] = true;
+    }
+    if (!clash) return seed;
+  }
+}
+
+struct ColorSlots { uint8_t slot[COLOR_SLOTS]; };
+
+constexpr uint32_t COLOR_SEED = findColorSeed();
+
+constexpr ColorSlots makeColorSlots() {
+  ColorSlots t{};
+  for (int i = 0; i < BUILTIN_COLORS; i++)
+    t.slot[colorHash(COLORS[i].name, nameLength(COLORS[i].name), COLOR_SEED) & (COLOR_SLOTS - 1)] = i + 1;
+  return t;
+}
+
+constexpr ColorSlots BUILTIN_COLOR_SLOTS = makeColorSlots();
+ColorSlots colorSlots = BUILTIN_COLOR_SLOTS; // Plus the palette
+
+bool nameMatches(const char* name, Span s) {
+  for (size_t i = 0; i < s.n; i++)
+    if (name[i] != lowerAscii(s.p[i])) return false; // Stops at the terminator too
+  return name[s.n] == 0;
+}
+
+// Built-in or palette color by name, case-insensitive
+bool findColor(Span name, uint8_t& r, uint8_t& g, uint8_t& b) {
+  if (name.n == 0 || name.n > COLOR_NAME_MAX) return false;
+  uint32_t h = colorHash(name.p, name.n, COLOR_SEED);
+  for (int i = 0; i < COLOR_SLOTS; i++) {
+    uint8_t e = colorSlots.slot[(h + i) & (COLOR_SLOTS - 1)];
+    if (e == 0) return false;
+    if (e >= PALETTE_SLOT) {
+      const PaletteColor& c = palette[e - PALETTE_SLOT];
+      if (nameMatches(c.name, name)) { r = c.r; g = c.g; b = c.b; return true; }
+    } else {
+      const NamedColor& c = COLORS[e - 1];
+      if (nameMatches(c.name, name)) { r = c.r; g = c.g; b = c.b; return true; }
+    }
+  }
+  return false;
 }
 
-bool parseColor(String s, uint8_t &r, uint8_t &g, uint8_t &b) {
-  s.trim(); s.toLowerCase();
-  for (auto &c : COLORS) {
-    if (s == c.name) { r = c.r; g = c.g; b = c.b; return true; }
+// Call after any change to palette[]
+void rebuildColorSlots() {
+  colorSlots = BUILTIN_COLOR_SLOTS;
+  for (int i = 0; i < paletteCount; i++) {
+    uint32_t h = colorHash(palette[i].name, strlen(palette[i].name), COLOR_SEED);
+    while (colorSlots.slot[h & (COLOR_SLOTS - 1)]) h++;
+    colorSlots.slot[h & (COLOR_SLOTS - 1)] = PALETTE_SLOT + i;
   }
-  if (s.startsWith("#") && s.length() == 7) {
-    long v = strtol(s.substring(1).c_str(), nullptr, 16);
+}
+
+bool parseColor(Span s, uint8_t &r, uint8_t &g, uint8_t &b) {
+  s = spanTrim(s);
+  if (findColor(s, r, g, b)) return true;
+  if (s.n == 7 && s.p[0] == '#') {
+    char hex[7];
+    memcpy(hex, s.p + 1, 6);
+    hex[6] = 0;
+    long v = strtol(hex, nullptr, 16);
     r = (v >> 16) & 0xFF; g = (v >> 8) & 0xFF; b = v & 0xFF;
     return true;
   }
-  if (s.startsWith("rgb,") || s.startsWith("rgb(")) {
-    int c1 = s.indexOf(',');
-    int c2 = s.indexOf(',', c1 + 1);
-    int c3 = s.indexOf(',', c2 + 1);
-    if (c2 > 0 && c3 > 0) {
-      r = s.substring(c1+1, c2).toInt();
-      g = s.substring(c2+1, c3).toInt();
-      b = s.substring(c3+1).toInt();
+  if (s.n >= 4 && lowerAscii(s.p[0]) == 'r' && lowerAscii(s.p[1]) == 'g' && lowerAscii(s.p[2]) == 'b' &&
+      (s.p[3] == ',' || s.p[3] == '(')) {
+    const char* end = s.p + s.n;
+    const char* c1 = (const char*)memchr(s.p, ',', s.n);
+    const char* c2 = c1 ? (const char*)memchr(c1 + 1, ',', end - c1 - 1) : nullptr;
+    const char* c3 = c2 ? (const char*)memchr(c2 + 1, ',', end - c2 - 1) : nullptr;
+    if (c3) {
+      r = spanToLong({ c1 + 1, (size_t)(c2 - c1 - 1) });
+      g = spanToLong({ c2 + 1, (size_t)(c3 - c2 - 1) });
+      b = spanToLong({ c3 + 1, (size_t)(end - c3 - 1) });
       return true;
     }
   }
   return false;
 }
 
-// ── LED effects ─────────────────────────────────────────────
-void spinEffect(int ms) {
-  unsigned long start = millis();
-  int pos = 0;
-  while (millis() - start < (unsigned long)ms) {
+inline bool parseColor(const String& s, uint8_t &r, uint8_t &g, uint8_t &b) {
+  return parseColor(Span{ s.c_str(), s.length() }, r, g, b);
+}
+
+// ── Timelines ───────────────────────────────────────────────
+// Keyframe animations uploaded once to a slot and played back by the
+// renderer without further network traffic. Source text, one keyframe
+// per line or ';':  <ms> [step|linear|ease] <color> [<color> ...]
+// with one color for every pixel or one per pixel. Each keyframe fades
+// from the previous one over <ms> (step switches at the start and
+// holds); the first fades from the last, or from black on the first pass.
+// Compiled layout:
+//   [version][loops, 0 = forever][keyframe count]
+//   per keyframe: [duration u16][interp | TL_UNIFORM][RGB x1 or xNUM_LEDS]
+#define TIMELINE_VERSION  1
+#define TIMELINE_SLOTS    4
+#define TIMELINE_MAX_KEYS 16
+#define TIMELINE_MAX      (3 + TIMELINE_MAX_KEYS * (3 + NUM_LEDS * 3))
+#define TL_UNIFORM        0x80
+
+enum TimelineInterp : uint8_t { TL_STEP, TL_LINEAR, TL_EASE };
+
+inline uint16_t tlDuration(const uint8_t* key) { return key[0] | key[1] << 8; }
+inline size_t tlKeySize(const uint8_t* key) { return 3 + ((key[2] & TL_UNIFORM) ? 3 : NUM_LEDS * 3); }
+inline const uint8_t* tlColor(const uint8_t* key, int i) {
+  return key + 3 + ((key[2] & TL_UNIFORM) ? 0 : i * 3);
+}
+
+// Checks a stored blob before anything walks it
+bool timelineValid(const uint8_t* tl, size_t len) {
+  if (len < 3 || tl[0] != TIMELINE_VERSION || tl[2] == 0 || tl[2] > TIMELINE_MAX_KEYS) return false;
+  size_t pos = 3;
+  for (int k = 0; k < tl[2]; k++) {
+    if (pos + 3 > len || pos + tlKeySize(tl + pos) > len) return false;
+    if ((tl[pos + 2] & ~TL_UNIFORM) > TL_EASE) return false;
+    pos += tlKeySize(tl + pos);
+  }
+  return pos == len;
+}
+
+uint32_t timelineLength(const uint8_t* tl) {
+  uint32_t total = 0;
+  const uint8_t* key = tl + 3;
+  for (int k = 0; k < tl[2]; k++, key += tlKeySize(key)) total += tlDuration(key);
+  return total;
+}
+
+// Pixels `elapsed` ms after the timeline started
+void timelineFrame(const uint8_t* tl, unsigned long elapsed, uint8_t out[][3]) {
+  const uint8_t* keys[TIMELINE_MAX_KEYS];
+  uint32_t total = 0;
+  const uint8_t* key = tl + 3;
+  for (int k = 0; k < tl[2]; k++, key += tlKeySize(key)) {
+    keys[k] = key;
+    total += tlDuration(key);
+  }
+  const uint8_t* last = keys[tl[2] - 1];
+  uint32_t pass = total ? elapsed / total : 0;
+
+  // Finished (or nothing to animate): hold the last keyframe
+  if (total == 0 || (tl[1] && pass >= tl[1])) {
+    for (int i = 0; i < NUM_LEDS; i++) memcpy(out[i], tlColor(last, i), 3);
+    return;
+  }
+
+  uint32_t t = elapsed % total;
+  const uint8_t* from = pass ? last : nullptr;
+  for (int k = 0; ; k++) {
+    uint16_t d = tlDuration(keys[k]);
+    if (t >= d) { t -= d; from = keys[k]; continue; }
+
+    uint32_t w = t * 256 / d; // 0..255, 8.8 progress through this keyframe
+    uint8_t interp = keys[k][2] & ~TL_UNIFORM;
+    if (interp == TL_STEP) w = 256;
+    else if (interp == TL_EASE) w = (w * w * (768 - 2 * w)) >> 16; // Smoothstep
     for (int i = 0; i < NUM_LEDS; i++) {
-      strip->setPixelColor(i, (i == pos) ? strip->Color(0,255,0) : strip->Color(0,30,0));
+      const uint8_t* to = tlColor(keys[k], i);
+      for (int c = 0; c < 3; c++) {
+        uint8_t a = from ? tlColor(from, i)[c] : 0;
+        out[i][c] = (a * (256 - w) + to[c] * w) >> 8;
+      }
     }
-    strip->show();
-    pos = (pos + 1) % NUM_LEDS;
-    delay(100);
+    return;
+  }
+}
+
+// Returns the compiled size, or 0 with `error` set
+size_t compileTimeline(const String& src, int loops, uint8_t* out, size_t cap, String& error) {
+  size_t len = 3;
+  int count = 0;
+  int start = 0;
+  while (start <= (int)src.length()) {
+    int end = start;
+    while (end < (int)src.length() && src[end] != ';' && src[end] != '\n') end++;
+    String line = src.substring(start, end);
+    start = end + 1;
+    line.trim();
+    if (line.length() == 0) continue;
+
+    String prefix = "keyframe " + String(count + 1) + ": ";
+    if (count == TIMELINE_MAX_KEYS) { error = "more than " + String(TIMELINE_MAX_KEYS) + " keyframes"; return 0; }
+
+    // Split on whitespace
+    String tok[2 + NUM_LEDS];
+    int n = 0;
+    int pos = 0;
+    while (pos < (int)line.length()) {
+      while (pos < (int)line.length() && isspace((unsigned char)line[pos])) pos++;
+      int tokEnd = pos;
+      while (tokEnd < (int)line.length() && !isspace((unsigned char)line[tokEnd])) tokEnd++;
+      if (tokEnd == pos) break;
+      if (n == 2 + NUM_LEDS) { error = prefix + "too many colors"; return 0; }
+      tok[n++] = line.substring(pos, tokEnd);
+      pos = tokEnd;
+    }
+
+    long duration = tok[0].toInt();
+    if (duration < 0 || duration > 60000 || (duration == 0 && tok[0] != "0")) {
+      error = prefix + "duration must be 0-60000 ms";
+      return 0;
+    }
+    int first = 1;
+    uint8_t interp = TL_LINEAR;
+    if (n > 1 && tok[1] == "step")   { interp = TL_STEP; first = 2; }
+    if (n > 1 && tok[1] == "linear") { interp = TL_LINEAR; first = 2; }
+    if (n > 1 && tok[1] == "ease")   { interp = TL_EASE; first = 2; }
+    int colors = n - first;
+    if (colors != 1 && colors != NUM_LEDS) {
+      error = prefix + "need 1 or " + String(NUM_LEDS) + " colors";
+      return 0;
+    }
+
+    size_t size = 3 + colors * 3;
+    if (len + size > cap) { error = "timeline too large"; return 0; }
+    out[len] = duration & 0xFF;
+    out[len + 1] = duration >> 8;
+    out[len + 2] = interp | (colors == 1 ? TL_UNIFORM : 0);
+    for (int c = 0; c < colors; c++) {
+      uint8_t* px = out + len + 3 + c * 3;
+      if (!parseColor(tok[first + c], px[0], px[1], px[2])) {
+        error = prefix + "bad color '" + tok[first + c] + "'";
+        return 0;
+      }
+    }
+    len += size;
+    count++;
   }
+  if (count == 0) { error = "no keyframes"; return 0; }
+  out[0] = TIMELINE_VERSION;
+  out[1] = constrain(loops, 0, 255);
+  out[2] = count;
+  return len;
+}
+
+// ── Event stream (SSE) ──────────────────────────────────────
+// GET /events holds the connection open and pushes what changes: LED
+// effect and color, focus phases, button gestures, macro runs and, with
+// ?frames=<ms>, the frame on the strip at most that often. Events are
+// serialized once into a shared ring and each subscriber keeps its own
+// read position. Writes never block; a subscriber that falls a whole ring
+// behind is dropped.
+#define SSE_CLIENTS      4
+#define SSE_RING         2048  // Power of two
+#define SSE_EVENT_MAX    192   // One serialized event
+#define SSE_FRAME_MIN_MS 20
+#define SSE_PING_MS      15000 // Comment line so dead peers show up
+
+struct SseClient {
+  bool used;
+  WiFiClient client;
+  uint32_t cursor;            // Ring bytes sent, counted like sseHead
+  uint16_t frameMs;           // 0 = no frame events
+  unsigned long lastFrame;
+  uint32_t frameSeq;          // mirrorSeq of the last frame event
+  char own[SSE_EVENT_MAX];    // Event for this subscriber only (greeting, frames)
+  uint8_t ownLen, ownOff;
+};
+SseClient sseClients[SSE_CLIENTS];
+char sseRing[SSE_RING];
+uint32_t sseHead = 0;         // Bytes ever appended; wraps harmlessly
+int sseSubscribers = 0;
+unsigned long sseLastPing = 0;
+
+// Last frame the strip got, in strip byte order (renderer writes)
+uint8_t mirrorFrame[NUM_LEDS * 3];
+std::atomic<uint32_t> mirrorSeq{0}; // Odd while the renderer writes
+
+bool readMirror(uint8_t* out, uint32_t& seq) {
+  seq = mirrorSeq.load(std::memory_order_acquire);
+  if (seq & 1) return false; // Next pass will see it
+  memcpy(out, mirrorFrame, sizeof(mirrorFrame));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return mirrorSeq.load(std::memory_order_relaxed) == seq;
+}
+
+// Takes what the socket buffer has room for right now
+size_t sseWrite(WiFiClient& c, const char* p, size_t n) {
+#if defined(ESP32)
+  int sent = send(c.fd(), p, n, MSG_DONTWAIT);
+  return sent > 0 ? sent : 0;
+#else
+  return c.write((const uint8_t*)p, n);
+#endif
 }
 
-void pulseEffect(uint8_t r, uint8_t g, uint8_t b, int ms) {
-  unsigned long start = millis();
-  while (millis() - start < (unsigned long)ms) {
-    float t = (millis() - start) % 1000 / 1000.0;
-    float bright = (sin(t * 2 * PI) + 1.0) / 2.0;
-    setAllLeds(r * bright, g * bright, b * bright);
-    delay(20);
+void sseDrop(SseClient& c) {
+  c.client.stop();
+  c.client = WiFiClient();
+  c.used = false;
+  sseSubscribers--;
+}
+
+// This subscriber's own event first (it was queued while caught up), then the ring
+void sseFlush(SseClient& c) {
+  if (c.ownOff < c.ownLen) {
+    c.ownOff += sseWrite(c.client, c.own + c.ownOff, c.ownLen - c.ownOff);
+    if (c.ownOff < c.ownLen) return;
+  }
+  while (c.cursor != sseHead) {
+    uint32_t at = c.cursor & (SSE_RING - 1);
+    size_t n = std::min<uint32_t>(sseHead - c.cursor, SSE_RING - at);
+    size_t sent = sseWrite(c.client, sseRing + at, n);
+    c.cursor += sent;
+    if (sent < n) return;
   }
 }
 
-// ── Rainbow color from wheel position (0-255) ──────────────
-uint32_t colorWheel(uint8_t pos) {
-  pos = 255 - pos;
-  if (pos < 85)  return strip->Color(255 - pos*3, 0, pos*3);
-  if (pos < 170) { pos -= 85; return strip->Color(0, pos*3, 255 - pos*3); }
-  pos -= 170;
-  return strip->Color(pos*3, 255 - pos*3, 0);
+void sseAppend(const char* p, size_t n) {
+  for (auto& c : sseClients)
+    if (c.used && sseHead + n - c.cursor > SSE_RING) sseDrop(c); // Would lose unread events
+  for (size_t i = 0; i < n; i++) sseRing[(sseHead + i) & (SSE_RING - 1)] = p[i];
+  sseHead += n;
+  for (auto& c : sseClients)
+    if (c.used) sseFlush(c);
 }
 
-// ── Animation tick (called from loop) ───────────────────────
-void tickEffect() {
-  if (currentEffect == EFFECT_SOLID || !strip) return;
+// Formats "event: <name>\ndata: <json>\n\n" into out; 0 if it doesn't fit
+size_t sseFormat(char* out, const char* name, const char* fmt, va_list ap) {
+  int n = snprintf(out, SSE_EVENT_MAX, "event: %s\ndata: ", name);
+  int d = vsnprintf(out + n, SSE_EVENT_MAX - n, fmt, ap);
+  if (d < 0 || n + d + 2 >= SSE_EVENT_MAX) return 0; // Never send half an event
+  memcpy(out + n + d, "\n\n", 2);
+  return n + d + 2;
+}
+
+__attribute__((format(printf, 2, 3))) void sseEvent(const char* name, const char* fmt, ...) {
+  if (!sseSubscribers) return;
+  char ev[SSE_EVENT_MAX];
+  va_list ap;
+  va_start(ap, fmt);
+  size_t n = sseFormat(ev, name, fmt, ap);
+  va_end(ap);
+  if (n) sseAppend(ev, n);
+}
+
+__attribute__((format(printf, 3, 4))) void sseOwnEvent(SseClient& c, const char* name, const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  c.ownLen = sseFormat(c.own, name, fmt, ap);
+  c.ownOff = 0;
+  va_end(ap);
+}
+
+// Topmost layer that's on, its effect and base color
+void ledSummary(char* out, size_t cap) {
+  int top = LAYER_COUNT - 1;
+  while (top >= 0 && !layers[top].on) top--;
+  if (top < 0) {
+    snprintf(out, cap, "{\"layer\":null,\"effect\":\"off\"}");
+    return;
+  }
+  const Layer& L = layers[top];
+  snprintf(out, cap, "{\"layer\":\"%s\",\"effect\":\"%s\",\"color\":\"#%02x%02x%02x\"}",
+           LAYER_NAMES[top], EFFECT_NAMES[L.effect], L.r, L.g, L.b);
+}
+
+// New frames and animation steps aren't changes; only the summary counts
+char sseLedLast[96];
+
+void sseLedChanged() {
+  if (!sseSubscribers) return;
+  char now[sizeof(sseLedLast)];
+  ledSummary(now, sizeof(now));
+  if (strcmp(now, sseLedLast) == 0) return;
+  memcpy(sseLedLast, now, sizeof(now));
+  sseEvent("led", "%s", now);
+}
+
+void tickEvents() {
+  if (!sseSubscribers) return;
   unsigned long now = millis();
+  if (now - sseLastPing >= SSE_PING_MS) {
+    sseLastPing = now;
+    sseAppend(": ping\n\n", 8);
+  }
+  wakeAt(sseLastPing + SSE_PING_MS);
+  uint8_t px[NUM_LEDS * 3];
+  uint32_t seq;
+  bool havePx = readMirror(px, seq);
+  for (auto& c : sseClients) {
+    if (!c.used) continue;
+    if (!c.client.connected()) { sseDrop(c); continue; }
+    sseFlush(c);
+    if (!c.frameMs || !havePx || seq == c.frameSeq || c.cursor != sseHead || c.ownOff < c.ownLen) continue;
+    if (now - c.lastFrame < c.frameMs) { wakeAt(c.lastFrame + c.frameMs); continue; }
+    char hex[NUM_LEDS * 6 + 1];
+    for (int i = 0; i < NUM_LEDS; i++) // Strip bytes are GRB
+      snprintf(hex + i * 6, 7, "%02x%02x%02x", px[i * 3 + 1], px[i * 3], px[i * 3 + 2]);
+    sseOwnEvent(c, "frame", "{\"px\":\"%s\"}", hex);
+    c.lastFrame = now;
+    c.frameSeq = seq;
+    sseFlush(c);
+  }
+}
 
-  // Spin: colored trail chasing around the ring
-  if (currentEffect == EFFECT_SPIN && now - lastEffectUpdate > 80) {
-    lastEffectUpdate = now;
-    for (int i = 0; i < NUM_LEDS; i++) {
-      int dist = (effectPos - i + NUM_LEDS) % NUM_LEDS;
-      if (dist == 0)      strip->setPixelColor(i, strip->Color(effectR, effectG, effectB));
-      else if (dist == 1) strip->setPixelColor(i, strip->Color(effectR/3, effectG/3, effectB/3));
-      else if (dist == 2) strip->setPixelColor(i, strip->Color(effectR/8, effectG/8, effectB/8));
-      else                strip->setPixelColor(i, 0);
+// ── LED state hand-off ──────────────────────────────────────
+// Rendering runs in its own FreeRTOS task on the app core, so a slow HTTP
+// client, a blocking handler or a WiFi reconnect can't stall animations.
+// The main task owns the layers above and publishes a snapshot
+// with publishLeds(); the renderer picks it up under a sequence lock and
+// never blocks the writer. Only the renderer touches the strip.
+#if defined(ESP32)
+#define RENDER_TASK      1
+#define RENDER_CORE      1   // WiFi and lwIP run on core 0
+#define RENDER_PRIORITY  2   // Above loopTask (1)
+#else
+#define RENDER_TASK      0   // Native build: render inline from loop()
+#endif
+
+struct LedState {
+  Layer layer[LAYER_COUNT];
+  uint32_t gen[LAYER_COUNT];
+  uint8_t timeline[TIMELINE_MAX]; // Keyframes for the status layer
+  int pin;
+  unsigned long focusSetupStart, focusStartTime, focusDuration;
+};
+LedState ledShared;
+uint8_t timelineSlot[TIMELINE_SLOTS][TIMELINE_MAX];
+size_t timelineLen[TIMELINE_SLOTS]; // 0 = empty slot
+std::atomic<uint32_t> ledSeq{0};   // Odd while a publish is in progress
+#if RENDER_TASK
+TaskHandle_t renderTaskHandle = nullptr;
+#endif
+void renderTick();
+
+// Layers whose generation moved restart their animation from the first frame
+void publishLeds() {
+  uint32_t seq = ledSeq.load(std::memory_order_relaxed);
+  ledSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(ledShared.layer, layers, sizeof(layers));
+  memcpy(ledShared.gen, layerGen, sizeof(layerGen));
+  const Layer& status = layers[LAYER_STATUS];
+  if (status.on && status.effect == EFFECT_TIMELINE)
+    memcpy(ledShared.timeline, timelineSlot[status.timeline], timelineLen[status.timeline]);
+  ledShared.pin = ledOutPin;
+  ledShared.focusSetupStart = focusSetupStart;
+  ledShared.focusStartTime = focusStartTime;
+  ledShared.focusDuration = focusDuration;
+  ledSeq.store(seq + 2, std::memory_order_release);
+  sseLedChanged();
+#if RENDER_TASK
+  if (renderTaskHandle) xTaskNotifyGive(renderTaskHandle);
+#else
+  renderTick();
+#endif
+}
+
+// Turns a layer on as an opaque effect over all pixels (EFFECT_FRAME
+// shows its frame[]); callers adjust blend/mask before publishLeds()
+Layer& setLayer(LedLayer l, LedEffect effect, uint8_t r = 0, uint8_t g = 0, uint8_t b = 0) {
+  Layer& L = layers[l];
+  L.on = true;
+  L.effect = effect;
+  L.r = r; L.g = g; L.b = b;
+  L.blend = BLEND_REPLACE;
+  L.alpha = 255;
+  L.mask = ALL_PIXELS;
+  layerGen[l]++;
+  return L;
+}
+
+void showLayer(LedLayer l, LedEffect effect, uint8_t r = 0, uint8_t g = 0, uint8_t b = 0) {
+  setLayer(l, effect, r, g, b);
+  publishLeds();
+}
+
+void dropLayer(LedLayer l) {
+  layers[l].on = false;
+  layerGen[l]++;
+}
+
+void clearLayer(LedLayer l) {
+  dropLayer(l);
+  publishLeds();
+}
+
+// Device effects go on the local layer, over the status stack
+void setLocalLeds(uint8_t r, uint8_t g, uint8_t b) { showLayer(LAYER_LOCAL, EFFECT_SOLID, r, g, b); }
+
+// Show the local layer's frame as-is until the next change
+void publishLocalFrame() { showLayer(LAYER_LOCAL, EFFECT_FRAME); }
+
+// One frame of the macro SPIN animation: bright green head, dim green ring
+void drawSpinFrame(int pos) {
+  uint8_t (*frame)[3] = layers[LAYER_LOCAL].frame;
+  for (int i = 0; i < NUM_LEDS; i++) {
+    frame[i][0] = 0;
+    frame[i][1] = (i == pos) ? 255 : 30;
+    frame[i][2] = 0;
+  }
+  publishLocalFrame();
+}
+
+// ── Lookup tables (built at compile time) ──────────────────
+// Effects index these instead of calling sin() or branching per pixel.
+// Breathing curves are 8.8 fixed point (256 = full) and gamma-shaped:
+// the wave is eased in perceptual space (gamma 2.2) but keeps the same
+// floor and peak as the old linear curves, so the dim end moves gently.
+constexpr double tableSin(double x) {
+  while (x > PI) x -= 2 * PI;
+  while (x < -PI) x += 2 * PI;
+  double term = x, sum = x;
+  for (int n = 1; n < 12; n++) {
+    term *= -x * x / ((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+// x^2.2 for 0 <= x <= 1, as x^2 * fifthroot(x)
+constexpr double tableGamma(double x) {
+  if (x <= 0) return 0;
+  double y = 1;
+  for (int i = 0; i < 40; i++) y -= (y * y * y * y * y - x) / (5 * y * y * y * y);
+  return x * x * y;
+}
+
+constexpr double tableInvGamma(double x) {
+  double lo = 0, hi = 1;
+  for (int i = 0; i < 40; i++) {
+    double mid = (lo + hi) / 2;
+    if (tableGamma(mid) < x) lo = mid; else hi = mid;
+  }
+  return lo;
+}
+
+struct BreathTable { uint16_t level[256]; };
+
+constexpr BreathTable makeBreath(double floor) {
+  BreathTable t{};
+  double lo = tableInvGamma(floor);
+  for (int i = 0; i < 256; i++) {
+    double wave = (tableSin(i * 2 * PI / 256) + 1) / 2;
+    t.level[i] = (uint16_t)(tableGamma(lo + (1 - lo) * wave) * 256 + 0.5);
+  }
+  return t;
+}
+
+struct WheelTable { uint32_t color[256]; };
+
+constexpr WheelTable makeWheel() {
+  WheelTable t{};
+  for (int i = 0; i < 256; i++) {
+    int pos = 255 - i;
+    uint32_t r = 0, g = 0, b = 0;
+    if (pos < 85)       { r = 255 - pos*3; g = 0; b = pos*3; }
+    else if (pos < 170) { pos -= 85; r = 0; g = pos*3; b = 255 - pos*3; }
+    else                { pos -= 170; r = pos*3; g = 255 - pos*3; b = 0; }
+    t.color[i] = (r << 16) | (g << 8) | b;
+  }
+  return t;
+}
+
+constexpr BreathTable PULSE_CURVE = makeBreath(0.15);  // API pulse, focus setup
+constexpr BreathTable FOCUS_CURVE = makeBreath(0.3);   // Focus countdown
+constexpr WheelTable  WHEEL = makeWheel();
+
+// Phase of a breathing cycle as a table index
+inline uint8_t breathIndex(unsigned long now, unsigned long period) {
+  return (uint8_t)((now % period) * 256 / period);
+}
+
+// Layer pixels are kept in strip byte order (NEO_GRB) with LED_BRIGHTNESS
+// applied, exactly as the library's setPixelColor() stores them, so
+// compositing is byte math and a lone opaque layer shows unchanged.
+inline void putPixel(uint8_t* px, int i, uint8_t r, uint8_t g, uint8_t b) {
+  uint8_t* p = px + i * 3;
+  p[0] = (g * (LED_BRIGHTNESS + 1)) >> 8;
+  p[1] = (r * (LED_BRIGHTNESS + 1)) >> 8;
+  p[2] = (b * (LED_BRIGHTNESS + 1)) >> 8;
+}
+
+inline void putPixel(uint8_t* px, int i, uint32_t c) { putPixel(px, i, c >> 16, c >> 8, c); }
+
+// Folds the 8.8 level and LED_BRIGHTNESS into a single rounding step (the
+// library would otherwise truncate twice and make the dim end uneven).
+inline void setPixelLevel(uint8_t* px, int i, uint8_t r, uint8_t g, uint8_t b, uint16_t level) {
+  uint32_t scale = (uint32_t)level * (LED_BRIGHTNESS + 1);
+  uint8_t* p = px + i * 3;
+  p[0] = (g * scale) >> 16;
+  p[1] = (r * scale) >> 16;
+  p[2] = (b * scale) >> 16;
+}
+
+// ── Rainbow color from wheel position (0-255) ──────────────
+inline uint32_t colorWheel(uint8_t pos) {
+  return WHEEL.color[pos];
+}
+
+// ── Renderer ────────────────────────────────────────────────
+// Everything renders into the strip buffer (back buffer); showFrame()
+// only transmits when it differs from sentFrame, the last frame actually
+// sent. A WS2812 write blocks interrupts, so flat stretches cost nothing.
+uint8_t sentFrame[NUM_LEDS * 3];
+bool sentFrameValid = false;
+std::atomic<uint32_t> framesRendered{0}, framesSent{0};
+
+void showFrame() {
+  framesRendered++;
+  const uint8_t* px = strip->getPixels();
+  if (sentFrameValid && memcmp(px, sentFrame, sizeof(sentFrame)) == 0) return;
+  memcpy(sentFrame, px, sizeof(sentFrame));
+  sentFrameValid = true;
+  uint32_t m = mirrorSeq.load(std::memory_order_relaxed);
+  mirrorSeq.store(m + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(mirrorFrame, px, sizeof(mirrorFrame));
+  mirrorSeq.store(m + 2, std::memory_order_release);
+  framesSent++;
+  uint32_t start = micros();
+  strip->show();
+  observe(showTime, micros() - start);
+}
+
+// Renderer-private copy of the published state
+LedState led;
+uint32_t ledSeen = 0;
+int stripPin = -1;
+
+// Per-layer animation state and last drawn pixels (strip byte order)
+struct LayerRender {
+  uint32_t gen;
+  bool visible;
+  bool drawn;                 // Static effects draw once
+  unsigned long lastUpdate, start;
+  int pos;
+  uint32_t cover;             // Pixels the effect drew (the focus countdown frees some)
+  uint8_t px[NUM_LEDS * 3];
+};
+LayerRender layerRender[LAYER_COUNT];
+
+// One attempt per tick: if the main task is mid-publish, keep drawing the
+// old state and pick the new one up next time. Never waits on the writer.
+bool takeLedState() {
+  uint32_t seq = ledSeq.load(std::memory_order_acquire);
+  if (seq == ledSeen || (seq & 1)) return false;
+  LedState next;
+  memcpy(&next, &ledShared, sizeof(next));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (ledSeq.load(std::memory_order_relaxed) != seq) return false;
+  led = next;
+  ledSeen = seq;
+  return true;
+}
+
+// Frame period of an animated effect in ms; 0 = static, drawn once
+unsigned long effectPeriod(LedEffect effect) {
+  switch (effect) {
+    case EFFECT_SPIN:        return 80;
+    case EFFECT_PULSE:       return 20;
+    case EFFECT_PARTY:       return 30;
+    case EFFECT_TIMELINE:    return 20;
+    case EFFECT_FOCUS_START: return 40;
+    case EFFECT_FOCUS:       return 30;
+    default:                 return 0;
+  }
+}
+
+// Pixels a layer paints over completely as of its last frame; a layer
+// with every pixel painted over is not drawn at all
+inline uint32_t opaquePixels(const Layer& L, const LayerRender& R) {
+  return L.blend == BLEND_REPLACE ? L.mask & R.cover : 0;
+}
+
+// Draws layer l if its next frame is due; true if its pixels changed
+bool drawLayer(int l, unsigned long now) {
+  const Layer& L = led.layer[l];
+  LayerRender& R = layerRender[l];
+  uint8_t* px = R.px;
+  unsigned long period = effectPeriod(L.effect);
+  if (period == 0 ? R.drawn : now - R.lastUpdate <= period) return false;
+  R.cover = ALL_PIXELS;
+
+  switch (L.effect) {
+    case EFFECT_SOLID:
+      for (int i = 0; i < NUM_LEDS; i++) putPixel(px, i, L.r, L.g, L.b);
+      break;
+
+    case EFFECT_FRAME:
+      for (int i = 0; i < NUM_LEDS; i++) putPixel(px, i, L.frame[i][0], L.frame[i][1], L.frame[i][2]);
+      break;
+
+    // Spin: colored trail chasing around the ring
+    case EFFECT_SPIN:
+      for (int i = 0; i < NUM_LEDS; i++) {
+        int dist = (R.pos - i + NUM_LEDS) % NUM_LEDS;
+        if (dist == 0)      putPixel(px, i, L.r, L.g, L.b);
+        else if (dist == 1) putPixel(px, i, L.r/3, L.g/3, L.b/3);
+        else if (dist == 2) putPixel(px, i, L.r/8, L.g/8, L.b/8);
+        else                putPixel(px, i, 0);
+      }
+      R.pos = (R.pos + 1) % NUM_LEDS;
+      break;
+
+    // Pulse: breathing effect
+    case EFFECT_PULSE: {
+      uint16_t level = PULSE_CURVE.level[breathIndex(now, 1200)];
+      for (int i = 0; i < NUM_LEDS; i++) setPixelLevel(px, i, L.r, L.g, L.b, level);
+      break;
     }
-    strip->show();
-    effectPos = (effectPos + 1) % NUM_LEDS;
-  }
-
-  // Pulse: breathing effect
-  if (currentEffect == EFFECT_PULSE && now - lastEffectUpdate > 20) {
-    lastEffectUpdate = now;
-    float t = (now % 1200) / 1200.0;
-    float bright = (sin(t * 2 * PI) + 1.0) / 2.0;
-    bright = 0.15 + bright * 0.85;
-    setAllLeds(effectR * bright, effectG * bright, effectB * bright);
-  }
-
-  // Party: rotating flashes with strobes and random colors
-  if (currentEffect == EFFECT_PARTY && now - lastEffectUpdate > 30) {
-    lastEffectUpdate = now;
-    effectPos++;
-    int phase = (effectPos / 25) % 4; // Switch every ~0.75s
-
-    if (phase == 0) {
-      // Fast rainbow spin
-      for (int i = 0; i < NUM_LEDS; i++)
-        strip->setPixelColor(i, colorWheel(((i * 256 / NUM_LEDS) + effectPos * 10) & 255));
-    } else if (phase == 1) {
-      // Strobe: all LEDs flash bright color then off
-      if (effectPos % 4 < 2) {
-        uint32_t c = colorWheel((effectPos * 37) & 255);
-        for (int i = 0; i < NUM_LEDS; i++) strip->setPixelColor(i, c);
+
+    // Party: rotating flashes with strobes and random colors
+    case EFFECT_PARTY: {
+      int pos = ++R.pos;
+      int phase = (pos / 25) % 4; // Switch every ~0.75s
+
+      if (phase == 0) {
+        // Fast rainbow spin
+        for (int i = 0; i < NUM_LEDS; i++)
+          putPixel(px, i, colorWheel(((i * 256 / NUM_LEDS) + pos * 10) & 255));
+      } else if (phase == 1) {
+        // Strobe: all LEDs flash bright color then off
+        uint32_t c = pos % 4 < 2 ? colorWheel((pos * 37) & 255) : 0;
+        for (int i = 0; i < NUM_LEDS; i++) putPixel(px, i, c);
+      } else if (phase == 2) {
+        // Each LED a different random shifting color
+        for (int i = 0; i < NUM_LEDS; i++)
+          putPixel(px, i, colorWheel(((i * 97 + pos * 13) & 255)));
       } else {
-        for (int i = 0; i < NUM_LEDS; i++) strip->setPixelColor(i, 0);
-      }
-    } else if (phase == 2) {
-      // Each LED a different random shifting color
-      for (int i = 0; i < NUM_LEDS; i++)
-        strip->setPixelColor(i, colorWheel(((i * 97 + effectPos * 13) & 255)));
-    } else {
-      // Ping-pong bounce with trail
-      int pos = effectPos % (NUM_LEDS * 2 - 2);
-      if (pos >= NUM_LEDS) pos = NUM_LEDS * 2 - 2 - pos;
-      for (int i = 0; i < NUM_LEDS; i++) {
-        int dist = abs(i - pos);
-        if (dist == 0)      strip->setPixelColor(i, colorWheel((effectPos * 8) & 255));
-        else if (dist == 1) strip->setPixelColor(i, colorWheel(((effectPos * 8) + 80) & 255));
-        else                strip->setPixelColor(i, 0);
+        // Ping-pong bounce with trail
+        int at = pos % (NUM_LEDS * 2 - 2);
+        if (at >= NUM_LEDS) at = NUM_LEDS * 2 - 2 - at;
+        for (int i = 0; i < NUM_LEDS; i++) {
+          int dist = abs(i - at);
+          if (dist == 0)      putPixel(px, i, colorWheel((pos * 8) & 255));
+          else if (dist == 1) putPixel(px, i, colorWheel(((pos * 8) + 80) & 255));
+          else                putPixel(px, i, 0);
+        }
       }
+      break;
     }
-    strip->show();
-  }
 
-  // Focus start: 5-second clockwise confirmation animation
-  if (currentEffect == EFFECT_FOCUS_START) {
-    unsigned long elapsed = now - focusSetupStart;
-    if (elapsed >= 5000) {
-      // Confirmation done — start actual focus timer
-      focusStartTime = millis();
-      currentEffect = EFFECT_FOCUS;
-      lastEffectUpdate = 0;
-    } else if (now - lastEffectUpdate > 40) {
-      lastEffectUpdate = now;
+    // Timeline: uploaded keyframes, interpolated per pixel
+    case EFFECT_TIMELINE: {
+      uint8_t frame[NUM_LEDS][3];
+      timelineFrame(led.timeline, now - R.start, frame);
+      for (int i = 0; i < NUM_LEDS; i++) putPixel(px, i, frame[i][0], frame[i][1], frame[i][2]);
+      break;
+    }
+
+    // Focus start: 5-second clockwise confirmation animation
+    // (tickFocus() in the main loop moves on to EFFECT_FOCUS)
+    case EFFECT_FOCUS_START: {
+      unsigned long elapsed = now - led.focusSetupStart;
+      if (elapsed >= 5000) return false;
       // Clockwise wipe: LEDs light up one by one over 5 seconds
-      int lit = (int)((float)elapsed / 5000.0f * NUM_LEDS);
+      int lit = elapsed * NUM_LEDS / 5000;
       // Spinning bright trail on top
-      int trail = (effectPos++) % NUM_LEDS;
+      int trail = (R.pos++) % NUM_LEDS;
       for (int i = 0; i < NUM_LEDS; i++) {
-        if (i <= lit) {
-          // Already-filled LEDs: bright emerald
-          strip->setPixelColor(i, strip->Color(16, 255, 160));
-        } else if (i == trail) {
-          // Spinning head: white flash
-          strip->setPixelColor(i, strip->Color(255, 255, 255));
-        } else {
-          strip->setPixelColor(i, 0);
-        }
+        if (i <= lit)        putPixel(px, i, 16, 255, 160);  // Already filled: bright emerald
+        else if (i == trail) putPixel(px, i, 255, 255, 255); // Spinning head: white flash
+        else                 putPixel(px, i, 0);
       }
-      strip->show();
+      break;
     }
-  }
 
-  // Focus: pulsing emerald with countdown (LEDs turn off one by one)
-  if (currentEffect == EFFECT_FOCUS && now - lastEffectUpdate > 30) {
-    lastEffectUpdate = now;
-    unsigned long elapsed = now - focusStartTime;
+    // Focus: pulsing emerald with countdown. Spent LEDs are left to the
+    // layers below, so the status stack shows there (dark if it's empty).
+    case EFFECT_FOCUS: {
+      unsigned long elapsed = now - led.focusStartTime;
+      if (elapsed >= led.focusDuration) return false; // Alarm is up to tickFocus()
 
-    if (elapsed >= focusDuration) {
-      // Timer expired — switch to party alarm
-      uiState = UI_FOCUS_ALARM;
-      currentEffect = EFFECT_PARTY;
-      effectPos = 0;
-      return;
-    }
+      // How many LEDs should still be on (countdown)
+      int ledsOn = NUM_LEDS - (int)((uint64_t)elapsed * NUM_LEDS / led.focusDuration);
+      if (ledsOn < 1) ledsOn = 1;
 
-    // How many LEDs should still be on (countdown)
-    int ledsOn = NUM_LEDS - (int)((float)elapsed / focusDuration * NUM_LEDS);
-    if (ledsOn < 1) ledsOn = 1;
+      // Pulse brightness (bright so it's visible through green cover)
+      uint16_t level = FOCUS_CURVE.level[breathIndex(now, 2000)];
+      for (int i = 0; i < ledsOn; i++) setPixelLevel(px, i, 30, 255, 180, level); // Bright emerald
+      R.cover = (1u << ledsOn) - 1;
+      break;
+    }
+  }
+  R.lastUpdate = now;
+  R.drawn = true;
+  return true;
+}
 
-    // Pulse brightness (bright so it's visible through green cover)
-    float t = (now % 2000) / 2000.0;
-    float bright = (sin(t * 2 * PI) + 1.0) / 2.0;
-    bright = 0.3 + bright * 0.7;
+// Draws every visible layer that is due, top down, skipping covered ones;
+// true if the composite needs redoing. A layer restarts its animation when
+// it changes or comes back into view. `redrawAll` draws every visible
+// layer now (native --frame-cost times the worst case with it).
+bool drawLayers(unsigned long now, bool redrawAll) {
+  bool dirty = false;
+  uint32_t covered = 0;
+  for (int l = LAYER_COUNT - 1; l >= 0; l--) {
+    const Layer& L = led.layer[l];
+    LayerRender& R = layerRender[l];
+    bool visible = L.on && (covered & ALL_PIXELS) != ALL_PIXELS;
+    if (R.gen != led.gen[l] || (visible && !R.visible)) {
+      R.gen = led.gen[l];
+      R.pos = 0;
+      R.lastUpdate = 0;
+      R.start = now;
+      R.drawn = false;
+      dirty = true;
+    }
+    if (R.visible != visible) {
+      R.visible = visible;
+      dirty = true;
+    }
+    if (!visible) continue;
+    if (redrawAll) { R.drawn = false; R.lastUpdate = now - effectPeriod(L.effect) - 1; }
+    dirty |= drawLayer(l, now);
+    covered |= opaquePixels(L, R);
+  }
+  return dirty;
+}
 
-    uint8_t r = 30 * bright, g = 255 * bright, b = 180 * bright; // Bright emerald
+// Blends the visible layers bottom-up into `out` (strip byte order).
+// 8-bit fixed point: add saturates, alpha weighs 0-256.
+void compositeLayers(uint8_t* out) {
+  memset(out, 0, NUM_LEDS * 3);
+  for (int l = 0; l < LAYER_COUNT; l++) {
+    const Layer& L = led.layer[l];
+    const LayerRender& R = layerRender[l];
+    if (!R.visible) continue;
+    uint32_t mask = L.mask & R.cover;
+    uint16_t a = L.alpha + (L.alpha >> 7);
     for (int i = 0; i < NUM_LEDS; i++) {
-      if (i < ledsOn) strip->setPixelColor(i, strip->Color(r, g, b));
-      else            strip->setPixelColor(i, 0);
+      if (!(mask & (1u << i))) continue;
+      uint8_t* d = out + i * 3;
+      const uint8_t* s = R.px + i * 3;
+      for (int c = 0; c < 3; c++) {
+        if (L.blend == BLEND_ADD)        d[c] = std::min(255, d[c] + s[c]);
+        else if (L.blend == BLEND_ALPHA) d[c] = (s[c] * a + d[c] * (256 - a)) >> 8;
+        else                             d[c] = s[c];
+      }
+    }
+  }
+}
+
+void renderTick() {
+  bool changed = takeLedState();
+  if (ledSeen == 0) return; // Nothing published yet
+
+  // One strip for the life of the firmware; a pin change just moves it
+  if (led.pin != stripPin) {
+    if (!strip) {
+      strip = new Adafruit_NeoPixel(NUM_LEDS, led.pin, NEO_GRB + NEO_KHZ800);
+      strip->begin();
+      strip->setBrightness(LED_BRIGHTNESS);
+    } else {
+      strip->clear();
+      strip->setPin(led.pin);
     }
     strip->show();
+    stripPin = led.pin;
+    sentFrameValid = false; // New strip: next frame always goes out
+    changed = true;
+  }
+
+  if (!drawLayers(millis(), false) && !changed) return;
+  compositeLayers(strip->getPixels());
+  showFrame();
+}
+
+// When the next animation frame is due; false while every visible layer
+// is static, which only changes on a publish
+bool renderNextDue(unsigned long& at) {
+  if (ledSeen == 0) return false;
+  bool any = false;
+  for (int l = 0; l < LAYER_COUNT; l++) {
+    const LayerRender& R = layerRender[l];
+    unsigned long period = effectPeriod(led.layer[l].effect);
+    if (!R.visible || period == 0) continue;
+    unsigned long due = R.lastUpdate + period + 1;
+    if (!any || (long)(due - at) < 0) at = due;
+    any = true;
+  }
+  return any;
+}
+
+#if RENDER_TASK
+// Wakes on every publish and when the next frame is due; sleeps until the
+// next publish while the LEDs are static
+void renderTask(void*) {
+  for (;;) {
+    renderTick();
+    unsigned long due;
+    TickType_t wait = portMAX_DELAY;
+    if (renderNextDue(due)) {
+      long ms = (long)(due - millis());
+      wait = pdMS_TO_TICKS(ms > 0 ? ms : 0);
+    }
+    ulTaskNotifyTake(pdTRUE, wait);
   }
 }
+#endif
+
+// Picks up whatever setup() has published so far
+void startRenderer() {
+#if RENDER_TASK
+  xTaskCreatePinnedToCore(renderTask, "render", 4096, nullptr, RENDER_PRIORITY,
+                          &renderTaskHandle, RENDER_CORE);
+#endif
+}
 
 // ── HID key mapping ────────────────────────────────────────
 uint8_t mapSpecialKey(String key) {
@@ -286,132 +1316,351 @@ uint8_t mapSpecialKey(String key) {
   return 0;
 }
 
-// ── Macro executor ──────────────────────────────────────────
-void execLine(String line) {
-  line.trim();
-  if (line.length() == 0 || line.startsWith("//")) return;
+// ── Macro compiler ──────────────────────────────────────────
+// Macros are compiled once when saved, so a press runs a tight interpreter
+// with no parsing or heap allocation. Layout:
+//   [version][pool offset u16][ops...][OP_END][text pool]
+// Each op is [opcode][source line u16][args]; TYPE/PRINT text is interned
+// in the pool and referenced by offset + length.
+#define MACRO_BC_VERSION 1
+#define MACRO_BC_MAX     4096
+#define MACRO_MAX_ERRORS 8
 
-  // Strip inline comments
-  int commentPos = line.indexOf(" //");
+enum MacroOp : uint8_t { OP_END, OP_TYPE, OP_PRINT, OP_KEY, OP_COMBO, OP_LED, OP_DELAY, OP_SPIN };
+enum MacroMod : uint8_t { MOD_CTRL = 1, MOD_ALT = 2, MOD_SHIFT = 4, MOD_GUI = 8 };
+
+struct MacroError { int line; const char* msg; };
+
+uint8_t macroBc[MACRO_BC_MAX];
+size_t macroBcLen = 0;
+
+struct MacroCompiler {
+  uint8_t* out;
+  size_t cap, len = 3;
+  char pool[MACRO_BC_MAX];
+  size_t poolLen = 0;
+  MacroError* errors;
+  int errorCount = 0;
+  bool overflow = false;
+
+  void error(int line, const char* msg) {
+    if (errorCount < MACRO_MAX_ERRORS) errors[errorCount] = {line, msg};
+    errorCount++;
+  }
+  void emit8(uint8_t v) {
+    if (len < cap) out[len++] = v; else overflow = true;
+  }
+  void emit16(uint16_t v) { emit8(v & 0xFF); emit8(v >> 8); }
+  void op(MacroOp code, int line) { emit8(code); emit16(line); }
+
+  // Reuse an identical string already in the pool, else append it
+  uint16_t intern(const String& s) {
+    size_t n = s.length();
+    for (size_t i = 0; n > 0 && i + n <= poolLen; i++)
+      if (memcmp(pool + i, s.c_str(), n) == 0) return i;
+    if (poolLen + n > sizeof(pool)) { overflow = true; return 0; }
+    memcpy(pool + poolLen, s.c_str(), n);
+    poolLen += n;
+    return poolLen - n;
+  }
+  void text(MacroOp code, int line, const String& s) {
+    op(code, line);
+    emit16(intern(s));
+    emit16(s.length());
+  }
+};
+
+void compileLine(MacroCompiler& c, int lineNo, String line) {
+  line.trim();
+  if (line.length() == 0 || line.startsWith("//")) return;
+
+  // Strip inline comments
+  int commentPos = line.indexOf(" //");
   if (commentPos > 0) line = line.substring(0, commentPos);
   line.trim();
 
   if (line.startsWith("TYPE ")) {
-    Keyboard.print(line.substring(5));
+    c.text(OP_TYPE, lineNo, line.substring(5));
   }
   else if (line.startsWith("PRINT ")) {
-    Keyboard.println(line.substring(6));
+    c.text(OP_PRINT, lineNo, line.substring(6));
   }
   else if (line.startsWith("KEY ")) {
     uint8_t k = mapSpecialKey(line.substring(4));
-    if (k) { Keyboard.press(k); delay(30); Keyboard.releaseAll(); }
+    if (!k) { c.error(lineNo, "unknown key"); return; }
+    c.op(OP_KEY, lineNo);
+    c.emit8(k);
   }
   else if (line.startsWith("COMBO ")) {
     String combo = line.substring(6);
     combo.trim();
     int lastPlus = combo.lastIndexOf('+');
-    if (lastPlus > 0) {
-      String mods = combo.substring(0, lastPlus);
-      String key  = combo.substring(lastPlus + 1);
-      mods.toUpperCase();
-      if (mods.indexOf("CTRL") >= 0)  Keyboard.press(KEY_LEFT_CTRL);
-      if (mods.indexOf("ALT") >= 0)   Keyboard.press(KEY_LEFT_ALT);
-      if (mods.indexOf("SHIFT") >= 0) Keyboard.press(KEY_LEFT_SHIFT);
-      if (mods.indexOf("GUI") >= 0)   Keyboard.press(KEY_LEFT_GUI);
-      uint8_t sk = mapSpecialKey(key);
-      if (sk) Keyboard.press(sk);
-      else if (key.length() == 1) Keyboard.press(key.charAt(0));
-      delay(50);
-      Keyboard.releaseAll();
-    }
+    if (lastPlus <= 0) { c.error(lineNo, "COMBO needs MOD+key"); return; }
+    String mods = combo.substring(0, lastPlus);
+    String key  = combo.substring(lastPlus + 1);
+    mods.toUpperCase();
+    uint8_t mask = 0;
+    if (mods.indexOf("CTRL") >= 0)  mask |= MOD_CTRL;
+    if (mods.indexOf("ALT") >= 0)   mask |= MOD_ALT;
+    if (mods.indexOf("SHIFT") >= 0) mask |= MOD_SHIFT;
+    if (mods.indexOf("GUI") >= 0)   mask |= MOD_GUI;
+    uint8_t sk = mapSpecialKey(key);
+    if (!sk && key.length() == 1) sk = key.charAt(0);
+    if (!sk) { c.error(lineNo, "unknown key"); return; }
+    c.op(OP_COMBO, lineNo);
+    c.emit8(mask);
+    c.emit8(sk);
   }
   else if (line.startsWith("LED ")) {
-    String cs = line.substring(4); cs.trim();
-    if (cs.startsWith("RGB,") || cs.startsWith("rgb,")) {
-      int c1 = cs.indexOf(',');
-      int c2 = cs.indexOf(',', c1+1);
-      int c3 = cs.indexOf(',', c2+1);
-      if (c2 > 0 && c3 > 0)
-        setAllLeds(cs.substring(c1+1,c2).toInt(), cs.substring(c2+1,c3).toInt(), cs.substring(c3+1).toInt());
-    } else {
-      uint8_t r,g,b;
-      if (parseColor(cs, r, g, b)) setAllLeds(r, g, b);
-    }
+    uint8_t r, g, b;
+    if (!parseColor(line.substring(4), r, g, b)) { c.error(lineNo, "unknown color"); return; }
+    c.op(OP_LED, lineNo);
+    c.emit8(r); c.emit8(g); c.emit8(b);
   }
-  else if (line.startsWith("DELAY ")) {
-    int ms = line.substring(6).toInt();
-    if (ms > 0 && ms <= 30000) delay(ms);
-  }
-  else if (line.startsWith("SPIN ")) {
-    int ms = line.substring(5).toInt();
-    if (ms > 0 && ms <= 30000) spinEffect(ms);
+  else if (line.startsWith("DELAY ") || line.startsWith("SPIN ")) {
+    bool spin = line.startsWith("SPIN ");
+    int ms = line.substring(spin ? 5 : 6).toInt();
+    if (ms <= 0 || ms > 30000) { c.error(lineNo, "duration must be 1-30000 ms"); return; }
+    c.op(spin ? OP_SPIN : OP_DELAY, lineNo);
+    c.emit16(ms);
   }
   // Backward compat: [CTRL]+[SHIFT]+key
   else if (line.startsWith("[")) {
-    // Parse old-style [MOD]+[MOD]+key
-    bool ctrl = line.indexOf("[CTRL]") >= 0;
-    bool shift = line.indexOf("[SHIFT]") >= 0;
-    bool alt = line.indexOf("[ALT]") >= 0;
-    bool gui = line.indexOf("[GUI]") >= 0 || line.indexOf("[CMD]") >= 0;
-    // Get the last segment after the last +
+    uint8_t mask = 0;
+    if (line.indexOf("[CTRL]") >= 0)  mask |= MOD_CTRL;
+    if (line.indexOf("[SHIFT]") >= 0) mask |= MOD_SHIFT;
+    if (line.indexOf("[ALT]") >= 0)   mask |= MOD_ALT;
+    if (line.indexOf("[GUI]") >= 0 || line.indexOf("[CMD]") >= 0) mask |= MOD_GUI;
+    // Get the last segment after the last +, brackets removed
     int lp = line.lastIndexOf('+');
     String key = (lp >= 0) ? line.substring(lp+1) : "";
     key.trim();
-    // Remove brackets if present
     key.replace("[", ""); key.replace("]", "");
-    if (ctrl)  Keyboard.press(KEY_LEFT_CTRL);
-    if (shift) Keyboard.press(KEY_LEFT_SHIFT);
-    if (alt)   Keyboard.press(KEY_LEFT_ALT);
-    if (gui)   Keyboard.press(KEY_LEFT_GUI);
-    if (key.length() == 1) Keyboard.press(key.charAt(0));
-    delay(50);
-    Keyboard.releaseAll();
+    c.op(OP_COMBO, lineNo);
+    c.emit8(mask);
+    c.emit8(key.length() == 1 ? key.charAt(0) : 0);
+  }
+  else {
+    c.error(lineNo, "unknown command");
   }
 }
 
-void execMacro(String macro) {
-  int start = 0;
-  while (start < (int)macro.length()) {
-    int end = macro.indexOf('\n', start);
-    if (end < 0) end = macro.length();
-    execLine(macro.substring(start, end));
+// Compiles src into out; returns the bytecode length (0 if it doesn't fit).
+// Bad lines are reported in errors and left out of the program.
+size_t compileMacro(const String& src, uint8_t* out, size_t cap, MacroError* errors, int& errorCount) {
+  static MacroCompiler c;
+  c.out = out; c.cap = cap; c.len = 3; c.poolLen = 0;
+  c.errors = errors; c.errorCount = 0; c.overflow = false;
+
+  int start = 0, lineNo = 1;
+  while (start < (int)src.length()) {
+    int end = src.indexOf('\n', start);
+    if (end < 0) end = src.length();
+    compileLine(c, lineNo++, src.substring(start, end));
     start = end + 1;
   }
+  c.emit8(OP_END);
+
+  size_t poolOffset = c.len;
+  if (c.overflow || poolOffset + c.poolLen > cap) {
+    c.error(0, "macro too long");
+    errorCount = c.errorCount;
+    return 0;
+  }
+  memcpy(out + poolOffset, c.pool, c.poolLen);
+  out[0] = MACRO_BC_VERSION;
+  out[1] = poolOffset & 0xFF;
+  out[2] = poolOffset >> 8;
+  errorCount = c.errorCount;
+  return poolOffset + c.poolLen;
+}
+
+// ── Macro executor ──────────────────────────────────────────
+// Macros run cooperatively: macroStep() is called once per loop() pass,
+// performs at most one action and then parks on a deadline instead of
+// delay(), so HTTP, animations and the button stay live while it runs.
+enum MacroWait { MACRO_READY, MACRO_SLEEP, MACRO_RELEASE, MACRO_TYPE, MACRO_SPIN };
+
+struct MacroRun {
+  bool running = false;
+  uint16_t pc = 0;          // Offset of the next op in macroBc
+  uint16_t line = 0;        // Source line of the op executing
+  MacroWait wait = MACRO_READY;
+  unsigned long deadline = 0;
+  unsigned long started = 0;
+  const char* typing = nullptr; // Pending TYPE/PRINT characters (in the pool)
+  uint16_t typeLeft = 0;
+  uint8_t crlfLeft = 0;     // PRINT ends with "\r\n"
+  int spinPos = 0;
+  unsigned long spinEnd = 0;
+};
+MacroRun macro;
+
+bool deadlinePassed(unsigned long deadline) {
+  return (long)(millis() - deadline) >= 0;
+}
+
+void macroSleep(MacroWait wait, unsigned long ms) {
+  macro.wait = wait;
+  macro.deadline = millis() + ms;
+}
+
+void pressMods(uint8_t mask) {
+  if (mask & MOD_CTRL)  Keyboard.press(KEY_LEFT_CTRL);
+  if (mask & MOD_ALT)   Keyboard.press(KEY_LEFT_ALT);
+  if (mask & MOD_SHIFT) Keyboard.press(KEY_LEFT_SHIFT);
+  if (mask & MOD_GUI)   Keyboard.press(KEY_LEFT_GUI);
+}
+
+uint16_t bcRead16(uint16_t at) { return macroBc[at] | (macroBc[at + 1] << 8); }
+
+// Decodes and starts the op at macro.pc; returns false at OP_END
+bool execOp() {
+  uint16_t pc = macro.pc;
+  uint8_t op = macroBc[pc];
+  if (op == OP_END || pc >= macroBcLen) return false;
+  macro.line = bcRead16(pc + 1);
+  pc += 3;
+
+  switch (op) {
+    case OP_TYPE:
+    case OP_PRINT:
+      macro.typing = (const char*)macroBc + bcRead16(1) + bcRead16(pc);
+      macro.typeLeft = bcRead16(pc + 2);
+      macro.crlfLeft = op == OP_PRINT ? 2 : 0;
+      macro.wait = MACRO_TYPE;
+      pc += 4;
+      break;
+    case OP_KEY:
+      Keyboard.press(macroBc[pc]);
+      macroSleep(MACRO_RELEASE, 30);
+      pc += 1;
+      break;
+    case OP_COMBO:
+      pressMods(macroBc[pc]);
+      if (macroBc[pc + 1]) Keyboard.press(macroBc[pc + 1]);
+      macroSleep(MACRO_RELEASE, 50);
+      pc += 2;
+      break;
+    case OP_LED:
+      setLocalLeds(macroBc[pc], macroBc[pc + 1], macroBc[pc + 2]);
+      pc += 3;
+      break;
+    case OP_DELAY:
+      macroSleep(MACRO_SLEEP, bcRead16(pc));
+      pc += 2;
+      break;
+    case OP_SPIN:
+      macro.spinPos = 0;
+      macro.spinEnd = millis() + bcRead16(pc);
+      macroSleep(MACRO_SPIN, 0);
+      pc += 2;
+      break;
+    default:
+      return false; // Corrupt program
+  }
+  macro.pc = pc;
+  return true;
+}
+
+void macroStart() {
+  if (macro.running || macroBcLen == 0) return;
+  macro.running = true;
+  macro.pc = 3;
+  macro.line = 0;
+  macro.wait = MACRO_READY;
+  macro.started = millis();
+  macroRuns.fetch_add(1, std::memory_order_relaxed);
+  sseEvent("macro", "{\"state\":\"start\"}");
+}
+
+void macroFinish(bool aborted = false) {
+  macro.running = false;
+  macro.wait = MACRO_READY;
+  sseEvent("macro", "{\"state\":\"end\",\"aborted\":%s,\"elapsedMs\":%lu}",
+           aborted ? "true" : "false", millis() - macro.started);
+}
+
+void macroAbort() {
+  if (!macro.running) return;
+  Keyboard.releaseAll(); // Never leave a modifier stuck down
+  macroFinish(true);
+}
+
+// Advance the running macro by at most one action
+void macroStep() {
+  if (!macro.running) return;
+
+  switch (macro.wait) {
+    case MACRO_SLEEP:
+      if (!deadlinePassed(macro.deadline)) { wakeAt(macro.deadline); return; }
+      macro.wait = MACRO_READY;
+      break;
+    case MACRO_RELEASE:
+      if (!deadlinePassed(macro.deadline)) { wakeAt(macro.deadline); return; }
+      Keyboard.releaseAll();
+      macro.wait = MACRO_READY;
+      return;
+    case MACRO_TYPE:
+      if (macro.typeLeft > 0) {
+        Keyboard.write(*macro.typing++);
+        macro.typeLeft--;
+      } else if (macro.crlfLeft > 0) {
+        Keyboard.write(macro.crlfLeft-- == 2 ? '\r' : '\n');
+      }
+      if (macro.typeLeft == 0 && macro.crlfLeft == 0) macro.wait = MACRO_READY;
+      wakeAt(millis()); // One keystroke per pass
+      return;
+    case MACRO_SPIN:
+      if (deadlinePassed(macro.spinEnd)) { macro.wait = MACRO_READY; break; }
+      if (deadlinePassed(macro.deadline)) {
+        drawSpinFrame(macro.spinPos); // Focus layers above it win while they are on
+        macro.spinPos = (macro.spinPos + 1) % NUM_LEDS;
+        macro.deadline += 100;
+      }
+      wakeAt(macro.deadline);
+      wakeAt(macro.spinEnd);
+      return;
+    case MACRO_READY:
+      break;
+  }
+
+  if (!execOp()) macroFinish();
+  else wakeAt(millis()); // Next op, or the wait it just set, on the next pass
 }
 
 // ── Tap-based button actions ─────────────────────────────────
 void handleSinglePress() {
   if (currentMode == 1) {
-    // Custom macro
-    execMacro(macroText);
+    // Custom macro (runs from loop() via macroStep)
+    macroStart();
   } else {
-    // Party toggle (default for mode 0 and any unknown mode)
-    if (currentEffect == EFFECT_PARTY) {
-      currentEffect = EFFECT_SOLID;
-      setAllLeds(0, 0, 0);
-    } else {
-      currentEffect = EFFECT_PARTY;
-      effectPos = 0;
-      lastEffectUpdate = 0;
-    }
+    // Party toggle (default for mode 0 and any unknown mode); off shows
+    // the status stack again
+    const Layer& local = layers[LAYER_LOCAL];
+    if (local.on && local.effect == EFFECT_PARTY) clearLayer(LAYER_LOCAL);
+    else showLayer(LAYER_LOCAL, EFFECT_PARTY);
   }
 }
 
-void enterFocusSetup() {
+void enterFocusSetup(unsigned long now) {
   uiState = UI_FOCUS_SETUP;
-  focusSetupStart = millis();
+  focusSetupStart = now; // The second press, so a slow pass doesn't stretch the timeout
+  sseEvent("focus", "{\"state\":\"setup\"}");
+  dropLayer(LAYER_LOCAL); // Focus ends party and macro lights
   // Blue pulse = "waiting for duration taps"
-  currentEffect = EFFECT_PULSE;
-  effectR = 0; effectG = 100; effectB = 255;
-  lastEffectUpdate = 0;
+  showLayer(LAYER_FOCUS, EFFECT_PULSE, 0, 100, 255);
 }
 
 void onFocusTapRegistered(int count) {
   // Show tap count: light up N LEDs in emerald, rest off
-  if (!strip) return;
-  for (int i = 0; i < NUM_LEDS; i++)
-    strip->setPixelColor(i, i < count ? strip->Color(16, 185, 129) : 0);
-  strip->show();
+  uint8_t (*frame)[3] = layers[LAYER_FOCUS].frame;
+  for (int i = 0; i < NUM_LEDS; i++) {
+    frame[i][0] = i < count ? 16 : 0;
+    frame[i][1] = i < count ? 185 : 0;
+    frame[i][2] = i < count ? 129 : 0;
+  }
+  showLayer(LAYER_FOCUS, EFFECT_FRAME);
 }
 
 void startFocusTimer(int minutes) {
@@ -421,275 +1670,1617 @@ void startFocusTimer(int minutes) {
   // Start 5-second confirmation animation, then timer begins
   focusSetupStart = millis();
   uiState = UI_FOCUS_ACTIVE;
-  currentEffect = EFFECT_FOCUS_START;
-  effectPos = 0;
-  lastEffectUpdate = 0;
+  showLayer(LAYER_FOCUS, EFFECT_FOCUS_START);
+  focusSessions.fetch_add(1, std::memory_order_relaxed);
+  sseEvent("focus", "{\"state\":\"start\",\"minutes\":%d}", minutes);
 }
 
-void cancelFocusTimer() {
-  uiState = UI_IDLE;
-  currentEffect = EFFECT_SOLID;
-  setAllLeds(0, 0, 0);
+// Once when the countdown starts, then every FOCUS_REPORT_MS while anyone listens
+#define FOCUS_REPORT_MS 60000
+unsigned long focusNextReport = 0; // Countdown ms of the next progress event
+
+void reportFocusProgress(unsigned long now) {
+  unsigned long elapsed = now - focusStartTime;
+  if (elapsed >= focusNextReport) {
+    sseEvent("focus", "{\"state\":\"running\",\"elapsedMs\":%lu,\"remainingMs\":%lu}",
+             elapsed, focusDuration - elapsed);
+    focusNextReport = (elapsed / FOCUS_REPORT_MS + 1) * FOCUS_REPORT_MS;
+  }
+  if (sseSubscribers) wakeAt(focusStartTime + focusNextReport);
+}
+
+// Focus phase changes are UI state, so they happen here rather than in
+// the renderer, which only draws whatever phase it was handed.
+void tickFocus() {
+  unsigned long now = millis();
+  const Layer& focus = layers[LAYER_FOCUS];
+  if (!focus.on) return;
+  if (focus.effect == EFFECT_FOCUS_START && now - focusSetupStart >= 5000) {
+    // Confirmation done — start actual focus timer
+    focusStartTime = now;
+    focusNextReport = 0;
+    showLayer(LAYER_FOCUS, EFFECT_FOCUS);
+  } else if (focus.effect == EFFECT_FOCUS && now - focusStartTime >= focusDuration) {
+    // Timer expired — switch to party alarm
+    uiState = UI_FOCUS_ALARM;
+    dropLayer(LAYER_FOCUS);
+    showLayer(LAYER_ALARM, EFFECT_PARTY);
+    sseEvent("focus", "{\"state\":\"alarm\"}");
+    return;
+  }
+  if (focus.effect == EFFECT_FOCUS) reportFocusProgress(now);
+  if (focus.effect == EFFECT_FOCUS_START) wakeAt(focusSetupStart + 5000);
+  else if (focus.effect == EFFECT_FOCUS) wakeAt(focusStartTime + focusDuration);
 }
 
-void dismissFocusAlarm() {
+// Back to whatever the /led status stack says (off when it's empty)
+void endFocus(const char* reason) {
   uiState = UI_IDLE;
-  currentEffect = EFFECT_SOLID;
-  setAllLeds(0, 0, 0);
+  dropLayer(LAYER_FOCUS);
+  clearLayer(LAYER_ALARM);
+  sseEvent("focus", "{\"state\":\"end\",\"reason\":\"%s\"}", reason);
 }
 
-// ── Preferences ─────────────────────────────────────────────
-void loadPrefs() {
-  prefs.begin("btn", true);
+void cancelFocusTimer() { endFocus("cancel"); }
+void dismissFocusAlarm() { endFocus("dismiss"); }
+
+// ── Button edges ────────────────────────────────────────────
+// A CHANGE interrupt timestamps every edge into a single-producer /
+// single-consumer ring; loop() drains it and runs debounce and the tap
+// state machine against the edge times, so taps that land while the loop
+// is busy are still seen, and TAP_WINDOW is measured between the presses
+// themselves rather than between the passes that noticed them.
+#define BTN_RING 64 // Power of two
+
+struct ButtonEdge { uint32_t us; uint8_t level; };
+ButtonEdge btnRing[BTN_RING];
+std::atomic<uint32_t> btnHead{0}; // Written by the ISR only
+std::atomic<uint32_t> btnTail{0}; // Written by loop() only
+volatile uint32_t btnDropped = 0; // Edges lost to a full ring
+bool btnLastSeen = HIGH;          // Level of the newest edge taken
+unsigned long btnDownAt = 0;      // Debounced press time (factory reset hold)
+
+void IRAM_ATTR onButtonIsr() {
+  uint32_t head = btnHead.load(std::memory_order_relaxed);
+  if (head - btnTail.load(std::memory_order_acquire) >= BTN_RING) {
+    btnDropped = btnDropped + 1;
+    return;
+  }
+  btnRing[head & (BTN_RING - 1)] = { (uint32_t)micros(), (uint8_t)digitalRead(btnPin) };
+  btnHead.store(head + 1, std::memory_order_release);
+  schedWakeFromIsr();
+}
+
+void attachButton() {
+  pinMode(btnPin, INPUT_PULLUP);
+  lastBtnState = btnLastSeen = digitalRead(btnPin);
+  btnDownAt = millis();
+  attachInterrupt(digitalPinToInterrupt(btnPin), onButtonIsr, CHANGE);
+}
+
+// A debounced level change at `now` (ms, on the millis() clock)
+void onButtonEdge(bool state, unsigned long now) {
+  lastDebounce = now;
+  lastBtnState = state;
+  if (state != LOW) return; // Only presses count (active low with pullup)
+  btnDownAt = now;
+  if (uiState == UI_IDLE) {
+    if (tapCount > 0 && now - lastTapTime < TAP_WINDOW) {
+      // Second tap within window → double-tap → focus setup
+      tapCount = 0;
+      lastTapTime = 0;
+      sseEvent("button", "{\"gesture\":\"double\"}");
+      enterFocusSetup(now);
+    } else {
+      tapCount = 1;
+      lastTapTime = now;
+    }
+  } else if (uiState == UI_FOCUS_SETUP) {
+    tapCount++;
+    lastTapTime = now;
+    sseEvent("button", "{\"gesture\":\"tap\",\"count\":%d}", tapCount);
+    onFocusTapRegistered(tapCount);
+  } else if (uiState == UI_FOCUS_ACTIVE) {
+    // Double-tap to cancel (ignore single taps)
+    if (tapCount > 0 && now - lastTapTime < TAP_WINDOW) {
+      tapCount = 0;
+      lastTapTime = 0;
+      sseEvent("button", "{\"gesture\":\"double\"}");
+      cancelFocusTimer();
+    } else {
+      tapCount = 1;
+      lastTapTime = now;
+    }
+  } else if (uiState == UI_FOCUS_ALARM) {
+    sseEvent("button", "{\"gesture\":\"press\"}");
+    dismissFocusAlarm();
+  }
+}
+
+// Timeouts that run out between presses: the single tap, the duration
+// taps, the focus setup timeout and the reset hold. pollButton() also runs
+// this at each edge's own time before taking the edge, so a slow pass
+// can't let a later press or release overtake a deadline that had passed.
+void buttonDeadlines(unsigned long now) {
+  // Process single tap after settle (in IDLE state)
+  if (uiState == UI_IDLE && tapCount > 0 && (long)(now - lastTapTime) > TAP_SETTLE) {
+    sseEvent("button", "{\"gesture\":\"single\"}");
+    handleSinglePress();
+    tapCount = 0;
+  }
+
+  // Process duration taps after settle (in FOCUS_SETUP state)
+  if (uiState == UI_FOCUS_SETUP && tapCount > 0 && (long)(now - lastTapTime) > TAP_SETTLE) {
+    startFocusTimer(tapCount * 20);
+    tapCount = 0;
+  }
+
+  // Reset stale single tap during focus (so it doesn't linger)
+  if (uiState == UI_FOCUS_ACTIVE && tapCount > 0 && (long)(now - lastTapTime) > TAP_SETTLE) {
+    tapCount = 0;
+  }
+
+  // Focus setup timeout (no taps within 10 seconds → exit)
+  if (uiState == UI_FOCUS_SETUP && tapCount == 0 && (long)(now - focusSetupStart) > SETUP_TIMEOUT) {
+    endFocus("timeout");
+  }
+
+  // Factory reset: hold button for 10 seconds
+  if (lastBtnState == LOW && (long)(now - btnDownAt) > RESET_HOLD) {
+    sseEvent("button", "{\"gesture\":\"hold\"}");
+    showLayer(LAYER_NOTIFY, EFFECT_SOLID, 255, 0, 0);
+    prefs.begin("btn", false);
+    prefs.clear();
+    prefs.end();
+    delay(1000);
+    ESP.restart();
+  }
+}
+
+void pollButton() {
+  uint32_t tail = btnTail.load(std::memory_order_relaxed);
+  uint32_t head = btnHead.load(std::memory_order_acquire);
+  unsigned long nowMs = millis();
+  uint32_t nowUs = micros();
+  for (; tail != head; tail++) {
+    ButtonEdge e = btnRing[tail & (BTN_RING - 1)];
+    btnTail.store(tail + 1, std::memory_order_release);
+    unsigned long at = nowMs - (nowUs - e.us) / 1000;
+    btnLastSeen = e.level;
+    if (e.level != lastBtnState && (long)(at - lastDebounce) > DEBOUNCE_MS) {
+      buttonDeadlines(at);
+      onButtonEdge(e.level, at);
+    }
+  }
+  // The edge that ended a bounce burst was inside the debounce window:
+  // take it once the window has passed
+  if (btnLastSeen != lastBtnState) {
+    if (millis() - lastDebounce > DEBOUNCE_MS) {
+      buttonDeadlines(millis());
+      onButtonEdge(btnLastSeen, millis());
+    } else {
+      wakeAt(lastDebounce + DEBOUNCE_MS + 1);
+    }
+  }
+}
+
+// ── Config store ────────────────────────────────────────────
+// The globals above are the in-RAM config. Handlers change them, mark
+// the record dirty with configTouch() and call configCommit() once per
+// request. A commit only writes records whose bytes actually changed.
+//
+// Records: "cfg" holds the settings; the macro (source + bytecode), each
+// timeline slot and the color palette are blobs kept under two keys, A and B. A commit
+// writes changed blobs to their idle key first, then rewrites "cfg" with
+// the flipped A/B bits: that single NVS write is the commit point, so a
+// reboot mid-save leaves either the old config or the new one.
+#define CONFIG_VERSION      1
+#define CONFIG_SETTINGS_MAX 320
+#define WIFI_SSID_MAX       32  // 802.11 limit
+#define WIFI_PASS_MAX       63  // WPA2 passphrase limit
+#define PASSWORD_MAX        64
+// 18 fixed bytes (header, pins, flags, string lengths) plus the strings
+static_assert(18 + WIFI_SSID_MAX + WIFI_PASS_MAX + PASSWORD_MAX <= CONFIG_SETTINGS_MAX, "settings record too small");
+
+enum ConfigRecord { CFG_SETTINGS, CFG_MACRO, CFG_TIMELINE0, CFG_PALETTE = CFG_TIMELINE0 + TIMELINE_SLOTS, CFG_RECORDS };
+
+uint16_t configDirty = 0;
+uint32_t configHash[CFG_RECORDS];  // FNV-1a of what flash holds (0 = unknown)
+uint8_t configSides = 0;           // Live key of each blob record, bit per record
+uint32_t configCommits = 0;        // Persisted; counts commits that wrote to NVS
+uint32_t configWrites = 0, configSkipped = 0;
+unsigned long configLastCommitUs = 0;
+
+void configTouch(ConfigRecord r) { configDirty |= 1 << r; }
+
+uint32_t fnv1a(const uint8_t* p, size_t n, uint32_t h = 2166136261u) {
+  while (n--) { h ^= *p++; h *= 16777619u; }
+  return h;
+}
+
+String configKey(ConfigRecord r, int side) {
+  String key = r == CFG_MACRO ? "macro" : r == CFG_PALETTE ? "pal" : "tl" + String(r - CFG_TIMELINE0);
+  return key + (side ? "B" : "A");
+}
+
+struct BlobWriter {
+  uint8_t* p;
+  size_t len, cap;
+  void bytes(const void* src, size_t n) {
+    if (len + n <= cap) memcpy(p + len, src, n);
+    len += n;
+  }
+  void u8(uint8_t v) { bytes(&v, 1); }
+  void u16(uint16_t v) { uint8_t b[2] = { (uint8_t)v, (uint8_t)(v >> 8) }; bytes(b, 2); }
+  void u32(uint32_t v) { u16(v); u16(v >> 16); }
+  void str(const String& s) { u16(s.length()); bytes(s.c_str(), s.length()); }
+};
+
+struct BlobReader {
+  const uint8_t* p;
+  size_t len, pos;
+  bool ok;
+  uint8_t u8() { if (pos + 1 > len) { ok = false; return 0; } return p[pos++]; }
+  uint16_t u16() { uint16_t lo = u8(); return lo | u8() << 8; }
+  uint32_t u32() { uint32_t lo = u16(); return lo | (uint32_t)u16() << 16; }
+  String str() {
+    size_t n = u16();
+    if (!ok || pos + n > len) { ok = false; return String(); }
+    String s;
+    s.reserve(n);
+    for (size_t i = 0; i < n; i++) s += (char)p[pos + i];
+    pos += n;
+    return s;
+  }
+};
+
+// Settings record; the commit counter is left out of the change check
+size_t configSettings(uint8_t* out, size_t cap, uint32_t commits) {
+  BlobWriter w = { out, 0, cap };
+  w.u8(CONFIG_VERSION);
+  w.u8(configSides);
+  w.u32(commits);
+  w.u8(ledPin); w.u8(btnPin);
+  w.u8(currentMode);
+  w.u8(realtimeEnabled);
+  w.u16(realtimeTimeout);
+  w.str(wifiSSID); w.str(wifiPass); w.str(authPassword);
+  return w.len;
+}
+
+bool parseSettings(const uint8_t* p, size_t len) {
+  BlobReader r = { p, len, 0, true };
+  if (r.u8() != CONFIG_VERSION) return false;
+  configSides = r.u8();
+  configCommits = r.u32();
+  ledPin = r.u8(); btnPin = r.u8();
+  currentMode = r.u8();
+  realtimeEnabled = r.u8();
+  realtimeTimeout = r.u16();
+  wifiSSID = r.str(); wifiPass = r.str(); authPassword = r.str();
+  return r.ok;
+}
+
+// Blob record bytes (len 0 = nothing stored); caller frees. False when
+// out of memory, so a failed allocation never reads as "record deleted".
+bool configBlob(ConfigRecord r, uint8_t*& buf, size_t& len) {
+  if (r == CFG_MACRO) {
+    len = 2 + macroBcLen + macroText.length();
+    buf = (uint8_t*)malloc(len);
+    if (!buf) return false;
+    BlobWriter w = { buf, 0, len };
+    w.u16(macroBcLen);
+    w.bytes(macroBc, macroBcLen);
+    w.bytes(macroText.c_str(), macroText.length());
+    return true;
+  }
+  if (r == CFG_PALETTE) {
+    // [count] then per color: [name length][name][r][g][b]
+    len = 0;
+    buf = nullptr;
+    if (paletteCount == 0) return true;
+    len = 1;
+    for (int i = 0; i < paletteCount; i++) len += 4 + strlen(palette[i].name);
+    buf = (uint8_t*)malloc(len);
+    if (!buf) return false;
+    BlobWriter w = { buf, 0, len };
+    w.u8(paletteCount);
+    for (int i = 0; i < paletteCount; i++) {
+      const PaletteColor& c = palette[i];
+      w.u8(strlen(c.name));
+      w.bytes(c.name, strlen(c.name));
+      w.u8(c.r); w.u8(c.g); w.u8(c.b);
+    }
+    return true;
+  }
+  int slot = r - CFG_TIMELINE0;
+  len = timelineLen[slot];
+  buf = nullptr;
+  if (len == 0) return true;
+  buf = (uint8_t*)malloc(len);
+  if (!buf) return false;
+  memcpy(buf, timelineSlot[slot], len);
+  return true;
+}
+
+void parseBlob(ConfigRecord r, const uint8_t* p, size_t len) {
+  if (r == CFG_MACRO) {
+    BlobReader rd = { p, len, 0, true };
+    size_t bcLen = rd.u16();
+    if (!rd.ok || bcLen > sizeof(macroBc) || 2 + bcLen > len) return;
+    memcpy(macroBc, p + 2, bcLen);
+    macroBcLen = bcLen > 3 && macroBc[0] == MACRO_BC_VERSION ? bcLen : 0;
+    macroText = "";
+    macroText.reserve(len - 2 - bcLen);
+    for (size_t i = 2 + bcLen; i < len; i++) macroText += (char)p[i];
+    return;
+  }
+  if (r == CFG_PALETTE) {
+    BlobReader rd = { p, len, 0, true };
+    int count = std::min<int>(rd.u8(), PALETTE_MAX);
+    paletteCount = 0;
+    for (int i = 0; i < count && rd.ok; i++) {
+      PaletteColor& c = palette[paletteCount];
+      size_t n = rd.u8();
+      if (n == 0 || n > COLOR_NAME_MAX || rd.pos + n > len) break;
+      memcpy(c.name, p + rd.pos, n);
+      c.name[n] = 0;
+      rd.pos += n;
+      c.r = rd.u8(); c.g = rd.u8(); c.b = rd.u8();
+      if (rd.ok) paletteCount++;
+    }
+    return;
+  }
+  int slot = r - CFG_TIMELINE0;
+  if (len <= TIMELINE_MAX && timelineValid(p, len)) {
+    memcpy(timelineSlot[slot], p, len);
+    timelineLen[slot] = len;
+  }
+}
+
+void configCommit() {
+  if (!configDirty) return;
+  unsigned long start = micros();
+  uint16_t dirty = configDirty;
+  configDirty = 0;
+  uint32_t previousHash[CFG_RECORDS];
+  memcpy(previousHash, configHash, sizeof(configHash));
+  uint8_t sides = configSides;
+  uint16_t removeOld = 0, removeBoth = 0;
+  bool wrote = false;
+
+  prefs.begin("btn", false);
+  for (int r = CFG_MACRO; r < CFG_RECORDS; r++) {
+    if (!(dirty & (1 << r))) continue;
+    size_t len;
+    uint8_t* blob;
+    if (!configBlob((ConfigRecord)r, blob, len)) { configDirty |= 1 << r; continue; } // Retry next commit
+    uint32_t h = fnv1a(blob, len);
+    if (h == configHash[r]) { free(blob); configSkipped++; continue; }
+    int bit = 1 << (r - CFG_MACRO);
+    if (len == 0) {
+      removeBoth |= 1 << r; // Dropped after the commit point
+    } else {
+      int side = (sides & bit) ? 0 : 1;
+      if (prefs.putBytes(configKey((ConfigRecord)r, side).c_str(), blob, len) < len) {
+        Serial.println("Config write failed, record kept on its old side");
+        free(blob);
+        configDirty |= 1 << r; // Retry next commit
+        continue;
+      }
+      configWrites++;
+      sides ^= bit;
+      removeOld |= 1 << r;
+    }
+    free(blob);
+    configHash[r] = h;
+    wrote = true;
+  }
+
+  uint8_t settings[CONFIG_SETTINGS_MAX];
+  uint8_t previousSides = configSides;
+  configSides = sides;
+  size_t len = configSettings(settings, sizeof(settings), 0);
+  uint32_t h = fnv1a(settings, len);
+  bool failed = len > sizeof(settings);
+  if (failed) {
+    Serial.println("Config too large, not saved");
+  } else if (wrote || h != configHash[CFG_SETTINGS]) {
+    len = configSettings(settings, sizeof(settings), configCommits + 1);
+    failed = prefs.putBytes("cfg", settings, len) < len; // Commit point
+    if (failed) {
+      Serial.println("Config write failed, not saved");
+    } else {
+      configCommits++;
+      configWrites++;
+      configHash[CFG_SETTINGS] = h;
+      for (int r = CFG_MACRO; r < CFG_RECORDS; r++) {
+        int bit = 1 << (r - CFG_MACRO);
+        if (removeOld & (1 << r)) prefs.remove(configKey((ConfigRecord)r, (previousSides & bit) ? 1 : 0).c_str());
+        if (removeBoth & (1 << r)) {
+          prefs.remove(configKey((ConfigRecord)r, 0).c_str());
+          prefs.remove(configKey((ConfigRecord)r, 1).c_str());
+        }
+      }
+    }
+  } else {
+    configSkipped++;
+  }
+  if (failed) { // The record on flash still points at the old blobs; keep them
+    configSides = previousSides; // Blobs written so far stay unreferenced
+    memcpy(configHash, previousHash, sizeof(configHash)); // Nothing new is persisted
+    configDirty |= dirty;
+  }
+  prefs.end();
+  configLastCommitUs = micros() - start;
+}
+
+// Pre-store firmware kept one key per setting; read those once and
+// rewrite them as records
+const char* const LEGACY_KEYS[] = {
+  "ledPin", "btnPin", "mode", "macro", "macroBc", "wifiSSID", "wifiPass", "authPass",
+  "rtEnable", "rtTimeout", "tl0", "tl1", "tl2", "tl3",
+};
+
+void loadLegacyPrefs() {
   ledPin     = prefs.getInt("ledPin", DEFAULT_LED_PIN);
   btnPin     = prefs.getInt("btnPin", DEFAULT_BTN_PIN);
   currentMode = prefs.getInt("mode", 0);
-  if (currentMode == 3) currentMode = 1; // Migrate old macro mode
-  if (currentMode > 1) currentMode = 0;  // Default to party
   macroText  = prefs.getString("macro", "LED GREEN\nDELAY 1000\nLED OFF");
   wifiSSID   = prefs.getString("wifiSSID", "");
   wifiPass   = prefs.getString("wifiPass", "");
   authPassword = prefs.getString("authPass", "");
+  realtimeEnabled = prefs.getInt("rtEnable", 0) == 1;
+  realtimeTimeout = prefs.getInt("rtTimeout", RT_TIMEOUT);
+  for (int i = 0; i < TIMELINE_SLOTS; i++) {
+    String key = "tl" + String(i);
+    if (!prefs.isKey(key.c_str())) continue;
+    size_t len = prefs.getBytes(key.c_str(), timelineSlot[i], TIMELINE_MAX);
+    if (timelineValid(timelineSlot[i], len)) timelineLen[i] = len;
+  }
+  if (prefs.isKey("macroBc")) {
+    size_t len = prefs.getBytes("macroBc", macroBc, sizeof(macroBc));
+    if (len > 3 && macroBc[0] == MACRO_BC_VERSION) macroBcLen = len;
+  }
+}
+
+void loadPrefs() {
+  macroText = "LED GREEN\nDELAY 1000\nLED OFF";
+  macroBcLen = 0;
+  paletteCount = 0;
+  for (int i = 0; i < TIMELINE_SLOTS; i++) timelineLen[i] = 0;
+
+  prefs.begin("btn", true);
+  bool stored = false, legacy = false;
+  size_t len = prefs.getBytesLength("cfg");
+  if (len > 0 && len <= CONFIG_SETTINGS_MAX) {
+    uint8_t settings[CONFIG_SETTINGS_MAX];
+    prefs.getBytes("cfg", settings, len);
+    stored = parseSettings(settings, len);
+  }
+  if (stored) {
+    for (int r = CFG_MACRO; r < CFG_RECORDS; r++) {
+      String key = configKey((ConfigRecord)r, (configSides >> (r - CFG_MACRO)) & 1);
+      size_t blobLen = prefs.getBytesLength(key.c_str());
+      if (blobLen == 0) continue;
+      uint8_t* blob = (uint8_t*)malloc(blobLen);
+      if (!blob) continue;
+      prefs.getBytes(key.c_str(), blob, blobLen);
+      parseBlob((ConfigRecord)r, blob, blobLen);
+      free(blob);
+    }
+  } else {
+    for (const char* key : LEGACY_KEYS) legacy |= prefs.isKey(key);
+    loadLegacyPrefs(); // Also fills in defaults on a fresh device
+  }
   prefs.end();
+  rebuildColorSlots(); // Before the macro compile below, which may name them
+
+  if (currentMode == 3) currentMode = 1; // Migrate old macro mode
+  if (currentMode > 1) currentMode = 0;  // Default to party
+
+  // No (or outdated) saved bytecode: compile the source, skipping bad lines
+  if (macroBcLen == 0) {
+    MacroError errors[MACRO_MAX_ERRORS];
+    int errorCount;
+    macroBcLen = compileMacro(macroText, macroBc, sizeof(macroBc), errors, errorCount);
+  }
+
+  // Remember what flash holds so unchanged records are never rewritten
+  if (stored) {
+    uint8_t settings[CONFIG_SETTINGS_MAX];
+    size_t n = configSettings(settings, sizeof(settings), 0);
+    configHash[CFG_SETTINGS] = fnv1a(settings, n);
+    for (int r = CFG_MACRO; r < CFG_RECORDS; r++) {
+      size_t blobLen;
+      uint8_t* blob;
+      if (!configBlob((ConfigRecord)r, blob, blobLen)) continue;
+      configHash[r] = fnv1a(blob, blobLen);
+      free(blob);
+    }
+  } else if (legacy) {
+    for (int r = 0; r < CFG_RECORDS; r++) configTouch((ConfigRecord)r);
+    configCommit();
+    if (configDirty == 0 && configHash[CFG_SETTINGS] != 0) { // Only once the records are safe
+      prefs.begin("btn", false);
+      for (const char* key : LEGACY_KEYS) prefs.remove(key);
+      prefs.end();
+    }
+  }
+}
+
+// ── Reinitialize LEDs with new pin ──────────────────────────
+// The renderer rebuilds the strip on its side when it sees the new pin
+void initLeds(int pin) {
+  ledOutPin = pin;
+  publishLeds();
+}
+
+// ── Boot & WiFi station ─────────────────────────────────────
+// setup() only starts things; the STA join and the boot indicator are
+// advanced from loop(), so the AP, web server and button are live right
+// away. bootMark() records when each stage was reached (GET /boot).
+enum BootMark { BOOT_PREFS, BOOT_LEDS, BOOT_USB, BOOT_AP, BOOT_HTTP, BOOT_LOOP, BOOT_FIRST_REQUEST, BOOT_STA, BOOT_MARKS };
+const char* const BOOT_MARK_NAMES[BOOT_MARKS] = {
+  "prefs", "leds", "usb", "ap", "http", "loop", "firstRequest", "sta",
+};
+unsigned long bootMarkUs[BOOT_MARKS]; // 0 = not reached yet
+
+void bootMark(BootMark m) {
+  if (!bootMarkUs[m]) bootMarkUs[m] = micros() | 1;
+}
+
+#define STA_TIMEOUT 15000
+
+enum StaState { STA_OFF, STA_CONNECTING, STA_CONNECTED, STA_FAILED };
+const char* const STA_STATE_NAMES[] = { "off", "connecting", "connected", "failed" };
+StaState staState = STA_OFF;
+unsigned long staStarted = 0;
+
+// Status shown while joining: blue, then green (or red on failure, if
+// asked) for holdMs. Gives up the LEDs as soon as anything else sets them.
+struct StaIndicator {
+  bool active;
+  bool result;      // Showing the outcome, waiting for `until`
+  bool redOnFail;
+  uint16_t holdMs;
+  unsigned long until;
+  uint32_t seq;     // Local layer generation after our own publish
+};
+StaIndicator staLed = {};
+
+void staIndicate(uint8_t r, uint8_t g, uint8_t b) {
+  setLocalLeds(r, g, b);
+  staLed.seq = layerGen[LAYER_LOCAL];
+}
+
+void staBegin(uint16_t holdMs, bool redOnFail) {
+  staLed = { true, false, redOnFail, holdMs, 0, 0 };
+  if (wifiSSID.length() == 0) {
+    staState = STA_OFF;
+  } else {
+    WiFi.begin(wifiSSID.c_str(), wifiPass.c_str());
+    staState = STA_CONNECTING;
+    staStarted = millis();
+  }
+  staIndicate(0, 100, 255); // Blue while connecting
+}
+
+void tickSta() {
+  if (staState == STA_CONNECTING) {
+    if (WiFi.status() == WL_CONNECTED) {
+      staState = STA_CONNECTED;
+      staConnected = true;
+      bootMark(BOOT_STA);
+      Serial.print("WiFi connected: "); Serial.println(WiFi.localIP());
+    } else if (millis() - staStarted > STA_TIMEOUT) {
+      staState = STA_FAILED;
+      bootMark(BOOT_STA);
+      Serial.println("WiFi connection failed, AP only");
+    } else {
+      wakeAt(staStarted + STA_TIMEOUT + 1); // Joining itself is seen by the poll
+    }
+  } else if (staState == STA_CONNECTED) {
+    // The WiFi driver reconnects on its own; just follow it
+    bool up = WiFi.status() == WL_CONNECTED;
+    if (staConnected && !up) {
+      staConnected = false;
+      Serial.println("WiFi lost, reconnecting");
+    } else if (!staConnected && up) {
+      staConnected = true;
+      staReconnects.fetch_add(1, std::memory_order_relaxed);
+      Serial.print("WiFi reconnected: "); Serial.println(WiFi.localIP());
+    }
+  }
+
+  if (!staLed.active) return;
+  if (layerGen[LAYER_LOCAL] != staLed.seq) { staLed.active = false; return; } // Someone else owns the LEDs
+  if (!staLed.result && staState != STA_CONNECTING) {
+    if (staState == STA_FAILED && staLed.redOnFail) staIndicate(255, 0, 0);
+    else staIndicate(0, 255, 0);
+    staLed.result = true;
+    staLed.until = millis() + staLed.holdMs;
+  } else if (staLed.result && (long)(millis() - staLed.until) >= 0) {
+    staLed.active = false;
+    clearLayer(LAYER_LOCAL);
+  }
+  if (staLed.active && staLed.result) wakeAt(staLed.until);
+}
+
+// ── Session tokens ──────────────────────────────────────────
+// POST /login trades the password for a token once; hooks then send it as
+// "Authorization: Bearer <token>" or the cg_session cookie. A token is the
+// expiry (uptime seconds, 8 hex) followed by a 128-bit HMAC-SHA256 of it
+// (32 hex), so nothing is stored per session. The key is derived from the
+// password and a per-boot salt: a reboot or password change revokes all.
+#define TOKEN_LEN      40
+#define SESSION_COOKIE "cg_session"
+
+mbedtls_md_context_t sessionMac; // Keyed once; reset per token
+bool sessionReady = false;
+uint8_t sessionSalt[16];
+
+uint32_t uptimeSec() { return (uint32_t)(esp_timer_get_time() / 1000000); }
+
+void sessionRekey() {
+  if (!sessionReady) {
+    for (auto& b : sessionSalt) b = random(256); // Hardware RNG on the device
+    mbedtls_md_init(&sessionMac);
+    mbedtls_md_setup(&sessionMac, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    sessionReady = true;
+  }
+  uint8_t key[32];
+  mbedtls_md_hmac_starts(&sessionMac, (const uint8_t*)authPassword.c_str(), authPassword.length());
+  mbedtls_md_hmac_update(&sessionMac, (const uint8_t*)"clickgit-session", 16);
+  mbedtls_md_hmac_update(&sessionMac, sessionSalt, sizeof(sessionSalt));
+  mbedtls_md_hmac_finish(&sessionMac, key);
+  mbedtls_md_hmac_starts(&sessionMac, key, sizeof(key));
+}
+
+// Writes TOKEN_LEN chars plus a terminator
+void sessionSign(uint32_t expires, char* out) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  uint8_t msg[4] = { (uint8_t)(expires >> 24), (uint8_t)(expires >> 16), (uint8_t)(expires >> 8), (uint8_t)expires };
+  uint8_t mac[32];
+  mbedtls_md_hmac_reset(&sessionMac);
+  mbedtls_md_hmac_update(&sessionMac, msg, sizeof(msg));
+  mbedtls_md_hmac_finish(&sessionMac, mac);
+  for (int i = 0; i < 4; i++) { *out++ = HEX_DIGITS[msg[i] >> 4]; *out++ = HEX_DIGITS[msg[i] & 15]; }
+  for (int i = 0; i < 16; i++) { *out++ = HEX_DIGITS[mac[i] >> 4]; *out++ = HEX_DIGITS[mac[i] & 15]; }
+  *out = 0;
+}
+
+// Same work for every well-formed token, and the MAC compare never exits early
+bool sessionValid(const char* token, size_t len) {
+  if (len != TOKEN_LEN) return false;
+  uint32_t expires = 0;
+  for (int i = 0; i < 8; i++) {
+    char c = token[i];
+    int v = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    if (v < 0) return false;
+    expires = expires << 4 | v;
+  }
+  char want[TOKEN_LEN + 1];
+  sessionSign(expires, want);
+  uint8_t diff = 0;
+  for (int i = 8; i < TOKEN_LEN; i++) diff |= want[i] ^ token[i];
+  return diff == 0 && expires > uptimeSec();
+}
+
+// Time depends only on the submitted length, never on where it differs
+bool passwordMatches(const String& given) {
+  size_t n = given.length(), have = authPassword.length();
+  uint8_t diff = n != have;
+  for (size_t i = 0; i < n; i++) diff |= (uint8_t)given[i] ^ (uint8_t)(i < have ? authPassword[i] : 0);
+  return diff == 0;
+}
+
+// Token from a Bearer header or the session cookie, checked in place
+bool sessionFromRequest() {
+  const char* auth = server.headerValue("Authorization");
+  if (auth && strncasecmp(auth, "Bearer ", 7) == 0) return sessionValid(auth + 7, strlen(auth + 7));
+  const char* cookie = server.headerValue("Cookie");
+  if (!cookie) return false;
+  for (const char* p = cookie; (p = strstr(p, SESSION_COOKIE "=")); p++) {
+    if (p != cookie && p[-1] != ' ' && p[-1] != ';') continue;
+    p += sizeof(SESSION_COOKIE);
+    return sessionValid(p, strcspn(p, "; "));
+  }
+  return false;
+}
+
+// ── Authentication ──────────────────────────────────────────
+bool isAuthorized() {
+  if (authPassword.length() == 0) return true; // No password set — open access
+  return sessionFromRequest() || server.authenticate("admin", authPassword.c_str());
+}
+
+bool checkAuth() {
+  bootMark(BOOT_FIRST_REQUEST);
+  if (!isAuthorized()) {
+    server.requestAuthentication();
+    return false;
+  }
+  return true;
+}
+
+// ── Web: LED API (the main new feature) ─────────────────────
+void handleLedGet() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  server.send(200, "application/json",
+    "{\"firmware\":\"" FW_VERSION "\",\"leds\":" + String(NUM_LEDS) +
+    ",\"pin\":" + String(ledPin) +
+    ",\"frames\":{\"rendered\":" + String(framesRendered.load()) + ",\"sent\":" + String(framesSent.load()) + "}}");
+}
+
+// ── LED commands (shared by POST /led and the WebSocket) ────
+const char LED_REPLY_OK[]     = "{\"ok\":true}";
+const char LED_REPLY_HIDDEN[] = "{\"ok\":true,\"shown\":false}";
+const char LED_REPLY_FOCUS[]  = "{\"ok\":true,\"focus\":true}";
+const char LED_REPLY_BAD[]    = "{\"error\":\"bad color\"}";
+const char LED_REPLY_EMPTY[]  = "{\"error\":\"empty timeline slot\"}";
+const char LED_REPLY_PIXELS[] = "{\"error\":\"bad pixels\"}";
+const char LED_REPLY_LAYER[]  = "{\"error\":\"bad layer\"}";
+
+inline bool ledReplyIsError(const char* reply) {
+  return reply == LED_REPLY_BAD || reply == LED_REPLY_EMPTY || reply == LED_REPLY_PIXELS ||
+         reply == LED_REPLY_LAYER;
+}
+
+LedEffect parseEffect(Span s) {
+  if (spanEq(s, "spin")) return EFFECT_SPIN;
+  if (spanEq(s, "pulse")) return EFFECT_PULSE;
+  return EFFECT_SOLID;
+}
+
+LayerBlend parseBlend(Span s, LayerBlend fallback) {
+  if (spanEq(s, "replace")) return BLEND_REPLACE;
+  if (spanEq(s, "add")) return BLEND_ADD;
+  if (spanEq(s, "alpha")) return BLEND_ALPHA;
+  return fallback;
+}
+
+// LED list like "0,2-4" as a bit mask; empty = every LED
+bool parsePixels(Span s, uint32_t& mask) {
+  s = spanTrim(s);
+  if (s.n == 0) { mask = ALL_PIXELS; return true; }
+  mask = 0;
+  size_t i = 0;
+  while (i <= s.n) {
+    int bounds[2] = {-1, -1}, k = 0;
+    for (; i < s.n && s.p[i] != ','; i++) {
+      char c = s.p[i];
+      if (c == '-' && k == 0 && bounds[0] >= 0) { k = 1; continue; }
+      if (c < '0' || c > '9' || bounds[k] >= NUM_LEDS) return false;
+      bounds[k] = (bounds[k] < 0 ? 0 : bounds[k] * 10) + (c - '0');
+    }
+    i++; // Past the comma
+    if (k == 0) bounds[1] = bounds[0];
+    if (bounds[0] < 0 || bounds[1] < bounds[0] || bounds[1] >= NUM_LEDS) return false;
+    for (int p = bounds[0]; p <= bounds[1]; p++) mask |= 1u << p;
+  }
+  return true;
+}
+
+// ── Status stack ────────────────────────────────────────────
+// Every /led command is a status entry of its owner (one per owner; a new
+// command replaces it). The highest-priority live entry is shown, the
+// newest on a tie; when it expires or is cleared the next one shows, and
+// an empty stack turns the LEDs off. Commands without an owner share the
+// "" entry, so single clients keep last-command-wins. Local effects
+// (party, macros, focus) draw over the stack until its top next changes.
+#define STATUS_SLOTS     8
+#define STATUS_OWNER_MAX 15
+
+struct StatusEntry {
+  bool used;
+  char owner[STATUS_OWNER_MAX + 1];
+  uint8_t priority;
+  LedEffect effect;
+  uint8_t r, g, b;
+  uint8_t timeline;
+  uint32_t mask;         // LEDs it lights; the others stay dark
+  unsigned long expires; // millis(); 0 = until replaced or cleared
+  uint32_t seq;          // Command order, for ties
+};
+StatusEntry statusStack[STATUS_SLOTS];
+uint32_t statusSeq = 0;
+int statusShown = -1; // Slot last put on the LEDs, -1 = none
+
+inline bool focusOwnsLeds() { return uiState == UI_FOCUS_ACTIVE || uiState == UI_FOCUS_ALARM; }
+
+inline bool statusOutranks(const StatusEntry& a, const StatusEntry& b) {
+  return a.priority > b.priority || (a.priority == b.priority && a.seq > b.seq);
+}
+
+int statusTop() {
+  int top = -1;
+  for (int i = 0; i < STATUS_SLOTS; i++) {
+    const StatusEntry& e = statusStack[i];
+    if (!e.used) continue;
+    if (top < 0 || statusOutranks(e, statusStack[top])) top = i;
+  }
+  return top;
+}
+
+// A new top also ends whatever the local layer shows (party, macro
+// lights); focus stays on top of it
+void statusShowTop() {
+  statusShown = statusTop();
+  dropLayer(LAYER_LOCAL);
+  const StatusEntry* e = statusShown >= 0 ? &statusStack[statusShown] : nullptr;
+  if (!e || (e->effect == EFFECT_TIMELINE && timelineLen[e->timeline] == 0)) {
+    clearLayer(LAYER_STATUS);
+    return;
+  }
+  Layer& L = setLayer(LAYER_STATUS, e->effect, e->r, e->g, e->b);
+  L.timeline = e->timeline;
+  L.mask = e->mask;
+  publishLeds();
+}
+
+// Slot of `owner`, else a free one, else the least important entry
+int statusSlotFor(Span owner) {
+  int free = -1, weakest = 0;
+  for (int i = 0; i < STATUS_SLOTS; i++) {
+    const StatusEntry& e = statusStack[i];
+    if (!e.used) { if (free < 0) free = i; continue; }
+    if (strlen(e.owner) == owner.n && memcmp(e.owner, owner.p, owner.n) == 0) return i;
+    const StatusEntry& w = statusStack[weakest];
+    if (!w.used || statusOutranks(w, e)) weakest = i;
+  }
+  return free >= 0 ? free : weakest;
+}
+
+// Removes expired entries and shows the next one if the top went
+void tickStatus() {
+  unsigned long now = millis();
+  bool topGone = false;
+  unsigned long next = 0;
+  for (int i = 0; i < STATUS_SLOTS; i++) {
+    StatusEntry& e = statusStack[i];
+    if (!e.used || e.expires == 0) continue;
+    if ((long)(now - e.expires) > 0) {
+      e.used = false;
+      topGone |= i == statusShown;
+    } else if (next == 0 || (long)(e.expires - next) < 0) {
+      next = e.expires;
+    }
+  }
+  if (topGone) statusShowTop();
+  if (next) wakeAt(next + 1);
+}
+
+// owner "*" clears every entry
+const char* statusClear(Span owner) {
+  bool topGone = false;
+  for (int i = 0; i < STATUS_SLOTS; i++) {
+    StatusEntry& e = statusStack[i];
+    if (!e.used) continue;
+    if (spanEq(owner, "*") || (strlen(e.owner) == owner.n && memcmp(e.owner, owner.p, owner.n) == 0)) {
+      e.used = false;
+      topGone |= i == statusShown;
+    }
+  }
+  if (topGone) statusShowTop();
+  return LED_REPLY_OK;
+}
+
+// Drops the entries that play timeline `slot` once it's emptied, so the
+// stack can't fall back to a blank timeline
+void statusDropTimeline(int slot) {
+  bool topGone = false;
+  for (int i = 0; i < STATUS_SLOTS; i++) {
+    StatusEntry& e = statusStack[i];
+    if (!e.used || e.effect != EFFECT_TIMELINE || e.timeline != slot) continue;
+    e.used = false;
+    topGone |= i == statusShown;
+  }
+  if (topGone) statusShowTop();
+}
+
+// Returns the JSON reply; during focus mode the entry is stored but the
+// focus visuals stay until it ends.
+const char* applyLedCommand(uint8_t r, uint8_t g, uint8_t b, LedEffect effect, long timeout,
+                            int timeline = 0, Span owner = {}, uint8_t priority = 0,
+                            uint32_t mask = ALL_PIXELS) {
+  if (effect == EFFECT_TIMELINE &&
+      (timeline < 0 || timeline >= TIMELINE_SLOTS || timelineLen[timeline] == 0))
+    return LED_REPLY_EMPTY;
+
+  // Owners are echoed by GET /led/stack, so keep them JSON-safe
+  char name[STATUS_OWNER_MAX + 1];
+  size_t n = std::min(owner.n, (size_t)STATUS_OWNER_MAX);
+  for (size_t i = 0; i < n; i++)
+    name[i] = (owner.p[i] == '"' || owner.p[i] == '\\' || (uint8_t)owner.p[i] < 0x20) ? '_' : owner.p[i];
+  name[n] = 0;
+  int slot = statusSlotFor({name, n});
+  StatusEntry& e = statusStack[slot];
+  e.used = true;
+  memcpy(e.owner, name, n + 1);
+  e.priority = priority;
+  e.effect = effect;
+  e.r = r; e.g = g; e.b = b;
+  e.timeline = timeline;
+  e.mask = mask;
+  e.expires = timeout > 0 ? millis() + timeout : 0;
+  if (e.expires == 0 && timeout > 0) e.expires = 1; // 0 means "never"
+  e.seq = ++statusSeq;
+
+  int top = statusTop();
+  if (top != statusShown || top == slot) statusShowTop();
+  if (focusOwnsLeds()) return LED_REPLY_FOCUS;
+  return top == slot ? LED_REPLY_OK : LED_REPLY_HIDDEN;
+}
+
+// ── Notifications ───────────────────────────────────────────
+// layer=notify puts a short overlay on the top layer, over focus too,
+// blended onto whatever is below it. It isn't kept in the status stack
+// and goes away after `timeout` ms.
+#define NOTIFY_DEFAULT_MS 3000
+unsigned long notifyUntil = 0; // 0 = no timed notification
+
+const char* notifyLeds(uint8_t r, uint8_t g, uint8_t b, LedEffect effect, long timeout,
+                       uint32_t mask, LayerBlend blend, uint8_t alpha) {
+  Layer& L = setLayer(LAYER_NOTIFY, effect, r, g, b);
+  L.mask = mask;
+  L.blend = blend;
+  L.alpha = alpha;
+  publishLeds();
+  notifyUntil = millis() + (timeout > 0 ? timeout : NOTIFY_DEFAULT_MS);
+  if (notifyUntil == 0) notifyUntil = 1;
+  return LED_REPLY_OK;
+}
+
+const char* notifyClear() {
+  notifyUntil = 0;
+  clearLayer(LAYER_NOTIFY);
+  return LED_REPLY_OK;
+}
+
+void tickNotify() {
+  if (notifyUntil == 0) return;
+  if ((long)(millis() - notifyUntil) > 0) notifyClear();
+  else wakeAt(notifyUntil + 1);
+}
+
+// Same keys as the POST /led form; `arg` returns one of them as a Span.
+// Nothing on this path allocates.
+template <typename ArgFn>
+const char* ledCommandFromArgs(ArgFn arg) {
+  Span layer = arg("layer");
+  bool notify = spanEq(layer, "notify");
+  if (!notify && layer.n > 0 && !spanEq(layer, "status")) return LED_REPLY_LAYER;
+  uint32_t mask;
+  if (!parsePixels(arg("pixels"), mask)) return LED_REPLY_PIXELS;
+
+  Span owner = arg("owner");
+  uint8_t priority = constrain(spanToLong(arg("priority")), 0L, 255L);
+  if (spanEq(arg("clear"), "1")) return notify ? notifyClear() : statusClear(owner);
+
+  Span slot = arg("timeline");
+  if (slot.n > 0 && !notify)
+    return applyLedCommand(0, 0, 0, EFFECT_TIMELINE, spanToLong(arg("timeout")), spanToLong(slot), owner, priority, mask);
+
+  Span color = arg("color");
+  Span rs = arg("r");
+  uint8_t r = 0, g = 0, b = 0;
+
+  if (color.n > 0) {
+    if (!parseColor(color, r, g, b)) return LED_REPLY_BAD;
+  } else if (rs.n > 0) {
+    r = spanToLong(rs); g = spanToLong(arg("g")); b = spanToLong(arg("b"));
+  } else {
+    return LED_REPLY_BAD;
+  }
+  if (notify) {
+    Span alpha = arg("alpha");
+    return notifyLeds(r, g, b, parseEffect(arg("effect")), spanToLong(arg("timeout")), mask,
+                      parseBlend(arg("blend"), alpha.n ? BLEND_ALPHA : BLEND_REPLACE),
+                      alpha.n ? constrain(spanToLong(alpha), 0L, 255L) : 128);
+  }
+  return applyLedCommand(r, g, b, parseEffect(arg("effect")), spanToLong(arg("timeout")), 0, owner, priority, mask);
+}
+
+// Built once: a literal here would become a heap String on every request
+const String CORS_ORIGIN_HEADER = "Access-Control-Allow-Origin";
+const String CORS_ANY = "*";
+
+void handleLedPost() {
+  if (!checkAuth()) return;
+  server.sendHeader(CORS_ORIGIN_HEADER, CORS_ANY);
+  const char* reply = ledCommandFromArgs([](const char* key) { return server.argSpan(key); });
+  server.send_P(ledReplyIsError(reply) ? 400 : 200, "application/json", reply);
+}
+
+void handleLedOptions() {
+  bootMark(BOOT_FIRST_REQUEST);
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  server.sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+  server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
+  server.send(204);
+}
+
+// Live status entries, most important first
+void handleLedStackGet() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  bool listed[STATUS_SLOTS] = {};
+  unsigned long now = millis();
+  String json = "{\"entries\":[";
+  for (int k = 0; k < STATUS_SLOTS; k++) {
+    int best = -1;
+    for (int i = 0; i < STATUS_SLOTS; i++) {
+      const StatusEntry& e = statusStack[i];
+      if (!e.used || listed[i]) continue;
+      if (best < 0 || statusOutranks(e, statusStack[best])) best = i;
+    }
+    if (best < 0) break;
+    listed[best] = true;
+    const StatusEntry& e = statusStack[best];
+    char rgb[8];
+    snprintf(rgb, sizeof(rgb), "#%02x%02x%02x", e.r, e.g, e.b);
+    if (k) json += ",";
+    json += "{\"owner\":\"" + String(e.owner) + "\",\"priority\":" + String(e.priority) +
+            ",\"effect\":\"" + EFFECT_NAMES[e.effect] + "\"";
+    if (e.effect == EFFECT_TIMELINE) json += ",\"timeline\":" + String(e.timeline);
+    else json += ",\"color\":\"" + String(rgb) + "\"";
+    if (e.mask != ALL_PIXELS) {
+      json += ",\"pixels\":[";
+      for (int i = 0, n = 0; i < NUM_LEDS; i++)
+        if (e.mask & (1u << i)) { json += n++ ? "," : ""; json += String(i); }
+      json += "]";
+    }
+    json += ",\"ttl\":";
+    json += e.expires ? String((long)(e.expires - now) > 0 ? (long)(e.expires - now) : 0L) : String("null");
+    json += ",\"shown\":";
+    json += best == statusShown && !focusOwnsLeds() ? "true}" : "false}";
+  }
+  json += "],\"slots\":" + String(STATUS_SLOTS) + "}";
+  server.send(200, "application/json", json);
+}
+
+// ── WebSocket: LED command channel ──────────────────────────
+// One connection stays open and carries commands with POST /led
+// semantics, so hooks skip the TCP handshake, HTTP parse and Basic Auth
+// per update. Auth is checked once, on the upgrade request.
+//   text:   form-encoded, same keys as POST /led ("color=blue&effect=spin")
+//   binary: r g b effect [timeout ms, u32 little-endian]
+//           effect 0 = solid, 1 = spin, 2 = pulse, 3 = timeline (slot in r)
+// Every command is answered with the same JSON as POST /led.
+
+// Args of a form-encoded payload. Values are spans into the payload, or
+// into `scratch` when they had to be percent-decoded; they stay valid as
+// long as this object does.
+struct FormArgs {
+  const uint8_t* p;
+  size_t len;
+  char scratch[96];
+  size_t used = 0;
+
+  FormArgs(const uint8_t* payload, size_t length) : p(payload), len(length) {}
+
+  Span operator()(const char* key) {
+    size_t keyLen = strlen(key);
+    size_t i = 0;
+    while (i < len) {
+      size_t end = i;
+      while (end < len && p[end] != '&') end++;
+      if (end - i > keyLen && p[i + keyLen] == '=' && memcmp(p + i, key, keyLen) == 0)
+        return decode((const char*)p + i + keyLen + 1, end - i - keyLen - 1);
+      i = end + 1;
+    }
+    return {};
+  }
+
+private:
+  Span decode(const char* v, size_t n) {
+    if (!memchr(v, '%', n) && !memchr(v, '+', n)) return { v, n };
+    char* out = scratch + used;
+    size_t o = 0;
+    for (size_t j = 0; j < n && used + o < sizeof(scratch); j++) {
+      char c = v[j];
+      if (c == '+') c = ' ';
+      else if (c == '%' && j + 2 < n) {
+        char hex[3] = { v[j + 1], v[j + 2], 0 };
+        c = (char)strtol(hex, nullptr, 16);
+        j += 2;
+      }
+      out[o++] = c;
+    }
+    used += o;
+    return { out, o };
+  }
+};
+
+const char* ledCommandFromBinary(const uint8_t* p, size_t len) {
+  if (len != 4 && len != 8) return LED_REPLY_BAD;
+  long timeout = len == 8 ? (long)(p[4] | p[5] << 8 | p[6] << 16 | (uint32_t)p[7] << 24) : 0;
+  if (p[3] == 3) return applyLedCommand(0, 0, 0, EFFECT_TIMELINE, timeout, p[0]);
+  LedEffect effect = p[3] == 1 ? EFFECT_SPIN : p[3] == 2 ? EFFECT_PULSE : EFFECT_SOLID;
+  return applyLedCommand(p[0], p[1], p[2], effect, timeout);
+}
+
+void onSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  const char* reply;
+  if (type == WStype_TEXT)
+    reply = ledCommandFromArgs(FormArgs(payload, length));
+  else if (type == WStype_BIN)
+    reply = ledCommandFromBinary(payload, length);
+  else
+    return;
+  webSocket.sendTXT(num, reply);
+}
+
+// Basic Auth on the upgrade request, same credentials as the web UI
+void applySocketAuth() {
+  if (authPassword.length() > 0) webSocket.setAuthorization("admin", authPassword.c_str());
+  else webSocket.setAuthorization("");
+}
+
+// ── Web: Timelines ──────────────────────────────────────────
+void handleTimelineGet() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  String json = "{\"slots\":[";
+  for (int i = 0; i < TIMELINE_SLOTS; i++) {
+    if (i) json += ",";
+    if (timelineLen[i] == 0) { json += "null"; continue; }
+    const uint8_t* tl = timelineSlot[i];
+    json += "{\"bytes\":" + String((int)timelineLen[i]) + ",\"keyframes\":" + String(tl[2]) +
+            ",\"loops\":" + String(tl[1]) + ",\"ms\":" + String(timelineLength(tl)) + "}";
+  }
+  json += "]}";
+  server.send(200, "application/json", json);
+}
+
+// slot=N&keys=<source>[&loops=N] stores, slot=N&clear=1 empties
+void handleTimelinePost() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  int slot = server.arg("slot").toInt();
+  if (server.arg("slot").length() == 0 || slot < 0 || slot >= TIMELINE_SLOTS) {
+    server.send(400, "application/json", "{\"error\":\"slot must be 0-" + String(TIMELINE_SLOTS - 1) + "\"}");
+    return;
+  }
+  const Layer& status = layers[LAYER_STATUS];
+  bool playing = status.on && status.effect == EFFECT_TIMELINE && status.timeline == slot;
+
+  if (server.arg("clear") == "1") {
+    timelineLen[slot] = 0;
+    statusDropTimeline(slot); // The next entry shows if it was playing
+    configTouch((ConfigRecord)(CFG_TIMELINE0 + slot));
+    configCommit();
+    server.send(200, "application/json", "{\"ok\":true}");
+    return;
+  }
+
+  uint8_t bin[TIMELINE_MAX];
+  String error;
+  size_t len = compileTimeline(server.arg("keys"), server.arg("loops").toInt(), bin, sizeof(bin), error);
+  if (len == 0) {
+    error.replace("\"", "'");
+    server.send(400, "application/json", "{\"error\":\"" + error + "\"}");
+    return;
+  }
+  memcpy(timelineSlot[slot], bin, len);
+  timelineLen[slot] = len;
+  configTouch((ConfigRecord)(CFG_TIMELINE0 + slot));
+  configCommit();
+  if (playing) statusShowTop(); // Restart with the new keyframes
+  server.send(200, "application/json",
+    "{\"ok\":true,\"slot\":" + String(slot) + ",\"bytes\":" + String((int)len) +
+    ",\"keyframes\":" + String(bin[2]) + "}");
+}
+
+// ── Web: Palette ────────────────────────────────────────────
+void handlePaletteGet() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  String json = "{\"builtin\":[";
+  for (int i = 0; i < BUILTIN_COLORS; i++) {
+    if (i) json += ",";
+    json += "\"" + String(COLORS[i].name) + "\"";
+  }
+  json += "],\"palette\":{";
+  for (int i = 0; i < paletteCount; i++) {
+    char rgb[8];
+    snprintf(rgb, sizeof(rgb), "#%02x%02x%02x", palette[i].r, palette[i].g, palette[i].b);
+    if (i) json += ",";
+    json += "\"" + String(palette[i].name) + "\":\"" + rgb + "\"";
+  }
+  json += "},\"max\":" + String(PALETTE_MAX) + "}";
+  server.send(200, "application/json", json);
+}
+
+// name=N&color=<color> saves (any /led color, resolved now), name=N&delete=1 removes
+void handlePalettePost() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  String name = server.arg("name");
+  name.trim();
+  name.toLowerCase();
+  bool nameOk = name.length() > 0 && name.length() <= COLOR_NAME_MAX;
+  for (unsigned i = 0; i < name.length(); i++) {
+    char c = name[i];
+    nameOk &= (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+  }
+  if (!nameOk) {
+    server.send(400, "application/json", "{\"error\":\"name must be 1-" + String(COLOR_NAME_MAX) + " of a-z 0-9 - _\"}");
+    return;
+  }
+  int index = paletteCount;
+  for (int i = 0; i < paletteCount; i++)
+    if (name == palette[i].name) index = i;
+
+  if (server.arg("delete") == "1") {
+    if (index == paletteCount) { server.send(404, "application/json", "{\"error\":\"no such color\"}"); return; }
+    for (int i = index; i + 1 < paletteCount; i++) palette[i] = palette[i + 1];
+    paletteCount--;
+  } else {
+    uint8_t r, g, b;
+    if (index == paletteCount && findColor(Span{ name.c_str(), name.length() }, r, g, b)) {
+      server.send(400, "application/json", "{\"error\":\"built-in color name\"}");
+      return;
+    }
+    if (!parseColor(server.arg("color"), r, g, b)) {
+      server.send(400, "application/json", LED_REPLY_BAD);
+      return;
+    }
+    if (index == PALETTE_MAX) { server.send(400, "application/json", "{\"error\":\"palette full\"}"); return; }
+    PaletteColor& c = palette[index];
+    strcpy(c.name, name.c_str());
+    c.r = r; c.g = g; c.b = b;
+    if (index == paletteCount) paletteCount++;
+  }
+  rebuildColorSlots();
+  configTouch(CFG_PALETTE);
+  configCommit();
+  server.send(200, "application/json", "{\"ok\":true,\"colors\":" + String(paletteCount) + "}");
+}
+
+// ── Realtime frames (UDP, DDP) ──────────────────────────────
+// Per-pixel frames for host-driven visualizations, in DDP packets on
+// port 4048 (the protocol xLights, WLED and LedFx speak). Off by default:
+// UDP has no auth, so anyone on the network could drive the LEDs.
+//   header: flags (0x40 = v1, 0x10 = timecode, 0x01 = push), sequence
+//           (low 4 bits, 0 = unused), data type, id (1 = display),
+//           offset u32 BE, length u16 BE; then RGB bytes
+// Packets behind the last sequence number are dropped. After
+// realtimeTimeout ms without frames the /led state comes back.
+#define DDP_HEADER      10
+#define DDP_FLAG_VER1   0x40
+#define DDP_FLAG_TIME   0x10
+#define DDP_FLAG_PUSH   0x01
+#define DDP_ID_DISPLAY  1
+
+uint8_t ddpBuf[DDP_HEADER + 4 + NUM_LEDS * 3];
+uint8_t ddpLastSeq = 0;
+unsigned long realtimeLastFrame = 0;
+uint32_t realtimeReceived = 0, realtimeDropped = 0;
+
+void ddpPacket(const uint8_t* p, size_t len) {
+  realtimeReceived++;
+  if (len < DDP_HEADER || (p[0] & 0xC0) != DDP_FLAG_VER1) { realtimeDropped++; return; }
+  size_t header = (p[0] & DDP_FLAG_TIME) ? DDP_HEADER + 4 : DDP_HEADER;
+  uint8_t id = p[3];
+  if (id != DDP_ID_DISPLAY && id != 0) { realtimeDropped++; return; }
+
+  // 4-bit sequence: anything not 1-7 steps ahead is stale or a duplicate
+  uint8_t seq = p[1] & 0x0F;
+  if (seq && ddpLastSeq) {
+    uint8_t ahead = (seq - ddpLastSeq) & 0x0F;
+    if (ahead == 0 || ahead > 7) { realtimeDropped++; return; }
+  }
+  if (seq) ddpLastSeq = seq;
+
+  uint32_t offset = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | p[6] << 8 | p[7];
+  size_t dataLen = p[8] << 8 | p[9];
+  if (header + dataLen > len || offset > sizeof(realtimeFrame)) { realtimeDropped++; return; }
+  if (offset + dataLen > sizeof(realtimeFrame)) dataLen = sizeof(realtimeFrame) - offset;
+  memcpy((uint8_t*)realtimeFrame + offset, p + header, dataLen);
+
+  // Senders that don't set push still get shown once the frame is full
+  realtimeLastFrame = millis();
+  if ((p[0] & DDP_FLAG_PUSH) || offset + dataLen == sizeof(realtimeFrame)) {
+    realtimeActive = true;
+    memcpy(layers[LAYER_REALTIME].frame, realtimeFrame, sizeof(realtimeFrame));
+    showLayer(LAYER_REALTIME, EFFECT_FRAME);
+  }
+}
+
+// Drains everything queued since the last pass; only the newest frame shows
+void pollRealtime() {
+  if (!realtimeEnabled) return;
+  for (int n = 0; n < 8; n++) {
+    int size = ddp.parsePacket();
+    if (size <= 0) break;
+    int len = ddp.read(ddpBuf, sizeof(ddpBuf));
+    if (size > (int)sizeof(ddpBuf)) { realtimeReceived++; realtimeDropped++; continue; }
+    ddpPacket(ddpBuf, len);
+  }
+  if (realtimeActive && millis() - realtimeLastFrame > (unsigned long)realtimeTimeout) {
+    realtimeActive = false;
+    ddpLastSeq = 0; // A restarted sender begins a new sequence
+    clearLayer(LAYER_REALTIME);
+  }
+  if (realtimeActive) wakeAt(millis() + REALTIME_POLL_MS);
 }
 
-void savePref(const char* key, int val) {
-  prefs.begin("btn", false);
-  prefs.putInt(key, val);
-  prefs.end();
+void applyRealtimeEnabled() {
+  ddp.stop();
+  if (realtimeEnabled) ddp.begin(DDP_PORT);
+  if (!realtimeEnabled && realtimeActive) {
+    realtimeActive = false;
+    clearLayer(LAYER_REALTIME);
+  }
 }
 
-void savePref(const char* key, String val) {
-  prefs.begin("btn", false);
-  prefs.putString(key, val);
-  prefs.end();
+void handleRealtimeGet() {
+  if (!checkAuth()) return;
+  server.send(200, "application/json",
+    "{\"enabled\":" + String(realtimeEnabled ? "true" : "false") +
+    ",\"port\":" + String(DDP_PORT) +
+    ",\"timeout\":" + String(realtimeTimeout) +
+    ",\"active\":" + String(realtimeActive ? "true" : "false") +
+    ",\"received\":" + String(realtimeReceived) +
+    ",\"dropped\":" + String(realtimeDropped) + "}");
 }
 
-// ── Reinitialize LEDs with new pin ──────────────────────────
-void initLeds(int pin) {
-  if (strip) delete strip;
-  strip = new Adafruit_NeoPixel(NUM_LEDS, pin, NEO_GRB + NEO_KHZ800);
-  strip->begin();
-  strip->setBrightness(LED_BRIGHTNESS);
-  strip->show();
+void handleRealtimePost() {
+  if (!checkAuth()) return;
+  if (server.hasArg("enabled")) {
+    realtimeEnabled = server.arg("enabled") == "1";
+    applyRealtimeEnabled();
+  }
+  if (server.hasArg("timeout"))
+    realtimeTimeout = constrain((int)server.arg("timeout").toInt(), 100, 60000);
+  configTouch(CFG_SETTINGS);
+  configCommit();
+  handleRealtimeGet();
 }
 
-// ── Authentication ──────────────────────────────────────────
-bool checkAuth() {
-  if (authPassword.length() == 0) return true; // No password set — open access
-  if (!server.authenticate("admin", authPassword.c_str())) {
-    server.requestAuthentication();
-    return false;
-  }
-  return true;
+void handleConfigGet() {
+  if (!checkAuth()) return;
+  server.send(200, "application/json",
+    "{\"commits\":" + String(configCommits) + ",\"writes\":" + String(configWrites) +
+    ",\"skipped\":" + String(configSkipped) + ",\"lastCommitUs\":" + String(configLastCommitUs) + "}");
 }
 
-// ── Web: LED API (the main new feature) ─────────────────────
-void handleLedGet() {
+// Loop passes and how much of the time the main task slept
+void handleSchedGet() {
   if (!checkAuth()) return;
-  server.sendHeader("Access-Control-Allow-Origin", "*");
   server.send(200, "application/json",
-    "{\"firmware\":\"" FW_VERSION "\",\"leds\":" + String(NUM_LEDS) +
-    ",\"pin\":" + String(ledPin) + "}");
+    "{\"wakeups\":" + String((unsigned long)loopWakeups) +
+    ",\"wakeupsPerSec\":" + String((unsigned long)wakeupsPerSec) +
+    ",\"idlePct\":" + String((int)idlePct) +
+    ",\"pollMs\":" + String(IDLE_POLL_MS) + "}");
 }
 
-void handleLedPost() {
+// Marks are microseconds since power-on; null = not reached yet
+void handleBootGet() {
   if (!checkAuth()) return;
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  String color = server.arg("color");
-  String rs = server.arg("r"), gs = server.arg("g"), bs = server.arg("b");
-  String effect = server.arg("effect");
-  int timeout = server.arg("timeout").toInt();
+  String json = "{\"uptimeMs\":" + String(millis()) + ",\"sta\":\"" + STA_STATE_NAMES[staState] + "\",\"marksUs\":{";
+  for (int i = 0; i < BOOT_MARKS; i++) {
+    if (i) json += ",";
+    json += "\"" + String(BOOT_MARK_NAMES[i]) + "\":" + (bootMarkUs[i] ? String(bootMarkUs[i]) : String("null"));
+  }
+  json += "}}";
+  server.send(200, "application/json", json);
+}
 
-  uint8_t r = 0, g = 0, b = 0;
-  bool ok = false;
 
-  if (color.length() > 0) {
-    ok = parseColor(color, r, g, b);
-  } else if (rs.length() > 0) {
-    r = rs.toInt(); g = gs.toInt(); b = bs.toInt(); ok = true;
+// ── Pages ───────────────────────────────────────────────────
+// The HTML lives in web/ and is gzipped at build time into web_pages.h
+// (tools/embed_web.py). Pages go out as-is with their ETag; the values
+// that change at runtime come from GET /state, which the pages fetch.
+
+// Coalesces small writes into MSS-sized chunks; large flash segments
+// bypass the buffer entirely.
+struct ChunkWriter {
+  char buf[1024];
+  size_t len = 0;
+
+  void flush() {
+    if (len) server.sendContent(buf, len);
+    len = 0;
+  }
+  void write(const char* p, size_t n) {
+    if (n == 0) return; // An empty chunk would end the response
+    if (len + n > sizeof(buf)) flush();
+    if (n >= sizeof(buf)) { server.sendContent_P(p, n); return; }
+    memcpy(buf + len, p, n);
+    len += n;
+  }
+  void print(const char* s) { write(s, strlen(s)); }
+  void print(const String& s) { write(s.c_str(), s.length()); }
+  void print(int v) {
+    char num[12];
+    write(num, snprintf(num, sizeof(num), "%d", v));
+  }
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char line[160];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n > 0) write(line, std::min((size_t)n, sizeof(line) - 1));
   }
+  void printIP(const IPAddress& ip) {
+    char s[16];
+    write(s, snprintf(s, sizeof(s), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]));
+  }
+};
+ChunkWriter pageOut;
 
-  if (ok) {
-    // During focus mode, don't override LEDs — respond OK but keep focus visuals
-    if (uiState == UI_FOCUS_ACTIVE || uiState == UI_FOCUS_ALARM) {
-      server.send(200, "application/json", "{\"ok\":true,\"focus\":true}");
-      return;
-    }
+struct WebPage {
+  const uint8_t* gz;
+  size_t len;
+  String etag; // Built once, like the header names below
+};
 
-    effectR = r; effectG = g; effectB = b;
-    effectPos = 0;
-    lastEffectUpdate = 0;
+WebPage indexPage  = {WEB_INDEX_GZ, sizeof(WEB_INDEX_GZ), WEB_INDEX_ETAG};
+WebPage wifiPage   = {WEB_WIFI_GZ, sizeof(WEB_WIFI_GZ), WEB_WIFI_ETAG};
+WebPage pinsPage   = {WEB_PINS_GZ, sizeof(WEB_PINS_GZ), WEB_PINS_ETAG};
+WebPage updatePage = {WEB_UPDATE_GZ, sizeof(WEB_UPDATE_GZ), WEB_UPDATE_ETAG};
 
-    if (effect == "spin") {
-      currentEffect = EFFECT_SPIN;
-    } else if (effect == "pulse") {
-      currentEffect = EFFECT_PULSE;
-    } else {
-      currentEffect = EFFECT_SOLID;
-      setAllLeds(r, g, b);
-    }
+const String ETAG_HEADER = "ETag";
+const String CACHE_CONTROL_HEADER = "Cache-Control";
+const String CACHE_REVALIDATE = "private, no-cache"; // Behind auth: browser cache only
+const String CONTENT_ENCODING_HEADER = "Content-Encoding";
+const String GZIP_ENCODING = "gzip";
 
-    if (timeout > 0) ledAutoOff = millis() + timeout;
-    else ledAutoOff = 0;
-    server.send(200, "application/json", "{\"ok\":true}");
-  } else {
-    server.send(400, "application/json", "{\"error\":\"bad color\"}");
+// A matching If-None-Match gets a bodiless 304
+void sendPage(const WebPage& page) {
+  server.sendHeader(ETAG_HEADER, page.etag);
+  server.sendHeader(CACHE_CONTROL_HEADER, CACHE_REVALIDATE);
+  const char* match = server.headerValue("If-None-Match");
+  if (match && strstr(match, page.etag.c_str())) {
+    server.send(304);
+    return;
   }
+  server.sendHeader(CONTENT_ENCODING_HEADER, GZIP_ENCODING);
+  server.send_P(200, "text/html", (PGM_P)page.gz, page.len);
 }
 
-void handleLedOptions() {
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-  server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  server.send(204);
+void printJsonString(ChunkWriter& o, const String& s) {
+  o.write("\"", 1);
+  size_t from = 0;
+  for (size_t i = 0; i < s.length(); i++) {
+    uint8_t c = s[i];
+    if (c != '"' && c != '\\' && c >= 0x20) continue;
+    o.write(s.c_str() + from, i - from);
+    if (c == '"' || c == '\\') { char esc[2] = { '\\', (char)c }; o.write(esc, 2); }
+    else if (c == '\n') o.print("\\n");
+    else o.printf("\\u%04x", c);
+    from = i + 1;
+  }
+  o.write(s.c_str() + from, s.length() - from);
+  o.write("\"", 1);
 }
 
-// ── Web: Main page ──────────────────────────────────────────
-const char PAGE_MAIN[] PROGMEM = R"rawliteral(
-<!DOCTYPE html><html><head>
-<meta name='viewport' content='width=device-width,initial-scale=1'>
-<style>
-body{font-family:system-ui;margin:20px;text-align:center;background:#111;color:#eee}
-.c{max-width:700px;margin:0 auto}
-h1{color:#34d399}
-select,button,textarea,input{padding:10px;margin:5px;font-size:15px;border-radius:6px;border:1px solid #333;background:#222;color:#eee}
-button{background:#34d399;color:#111;cursor:pointer;border:none;font-weight:bold}
-button:hover{background:#10b981}
-.docs{text-align:left;background:#1a1a2e;padding:15px;border-radius:8px;margin:10px 0}
-.docs code{background:#333;padding:2px 5px;border-radius:3px;font-family:monospace}
-textarea{width:90%;font-family:monospace}
-.status{background:#1a2e1a;padding:10px;border-radius:8px;margin:10px 0;font-size:13px}
-a{color:#34d399}
-.grid{display:flex;gap:10px;justify-content:center;flex-wrap:wrap;margin:10px 0}
-.grid button{flex:1;min-width:80px}
-.ok{color:#34d399;font-weight:bold;display:none}
-</style>
-<script>
-function showMacro(){
-  var v=document.getElementById('m').value;
-  document.getElementById('mf').style.display=v=='1'?'block':'none';
-}
-function testLed(color){fetch('/led',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'color='+color});}
-function testBtn(){
-  fetch('/btn/test').then(r=>r.json()).then(d=>{
-    var el=document.getElementById('btnResult');
-    if(d.pressed.length>0) el.innerHTML='<span style="color:#34d399">Pressed on GPIO: '+d.pressed.join(', ')+'</span>';
-    else el.innerHTML='<span style="color:#ef4444">No press detected. Try holding the button while clicking Test.</span>';
-  });
-}
-</script>
-</head><body><div class='c'>
-<h1>ClickGit Button</h1>
-<div class='status'>
-  Firmware %FW% | LED pin: %LEDPIN% | Btn pin: %BTNPIN%<br>
-  AP: clickgit (192.168.4.1) %STAINFO%<br>
-  <a href='/wifi'>WiFi Settings</a> | <a href='/pins'>Pin Config</a> | <a href='/update'>Firmware Update</a>
-</div>
-
-<h3>Quick LED Test</h3>
-<div class='grid'>
-  <button onclick="testLed('red')">Red</button>
-  <button onclick="testLed('green')">Green</button>
-  <button onclick="testLed('blue')">Blue</button>
-  <button onclick="testLed('purple')">Purple</button>
-  <button onclick="testLed('emerald')">Emerald</button>
-  <button onclick="testLed('off')">Off</button>
-</div>
-
-<h3>Single Press Action</h3>
-<form action='/setmode' method='post'>
-<select id='m' name='mode' onchange='showMacro()'>
-  <option value='0' %S0%>Party Mode</option>
-  <option value='1' %S1%>Custom Macro</option>
-</select>
-<button type='submit'>Save</button>
-
-<div class='docs' style='margin-top:10px'>
-<h3 style='color:#34d399;margin-top:0'>Focus Timer (double-tap anytime)</h3>
-<p>Double-tap the button to enter focus mode. LEDs pulse blue while waiting. Then tap for duration:</p>
-<p><strong>1 tap</strong> = 20 min &nbsp; <strong>2 taps</strong> = 40 min &nbsp; <strong>3 taps</strong> = 60 min</p>
-<p>LEDs pulse emerald and count down. When time's up, rainbow party flash until you tap to dismiss. Tap once during a session to cancel.</p>
-</div>
-
-<h3>Button Pin Test</h3>
-<p style='font-size:13px'>If the button doesn't respond, the GPIO pin might be wrong. Hold the button and click Test:</p>
-<button type='button' onclick='testBtn()'>Test Button Pin</button>
-<div id='btnResult' style='margin:8px 0;font-size:13px'></div>
-
-<div id='mf' style='display:none'>
-<h3>Macro Editor</h3>
-<textarea name='macro' rows='12'>%MACRO%</textarea>
-<div class='docs'>
-<p>Commands: <code>TYPE text</code>, <code>PRINT text</code> (with Enter),
-<code>KEY RETURN</code>, <code>COMBO GUI+SPACE</code>,
-<code>LED GREEN</code>, <code>LED RGB,r,g,b</code>,
-<code>DELAY ms</code>, <code>SPIN ms</code>, <code>// comment</code></p>
-<p>Colors: RED GREEN BLUE YELLOW MAGENTA CYAN WHITE ORANGE PURPLE EMERALD OFF</p>
-<p>Keys: UP DOWN LEFT RIGHT HOME END TAB RETURN ESC DELETE BACKSPACE SPACE F1-F12</p>
-<p>Modifiers in COMBO: CTRL ALT SHIFT GUI</p>
-</div>
-</div>
-</form>
-
-<h3>Security</h3>
-<div class='docs' style='font-size:13px'>
-<p>Status: <strong style='color:%PWCOLOR%'>%PWSTATUS%</strong></p>
-<form action='/password' method='post' style='margin:8px 0'>
-  <input name='current' type='password' placeholder='Current password' style='width:60%'><br>
-  <input name='password' type='password' placeholder='New password (blank to remove)' style='width:60%'>
-  <button type='submit'>Save</button>
-</form>
-<p>Username is <code>admin</code>. You must enter the current password to change it. Leave new password blank to disable auth. If set, the LED API also requires auth — update your curl commands with <code>-u admin:password</code>.</p>
-</div>
-
-<h3>LED API (for Claude Code hooks)</h3>
-<div class='docs' style='font-size:13px'>
-<p>Control LEDs remotely via HTTP:</p>
-<code>curl http://%HOST%/led -d "color=green"</code><br>
-<code>curl http://%HOST%/led -d "color=blue&timeout=5000"</code><br>
-<code>curl http://%HOST%/led -d "r=255&g=0&b=128"</code><br>
-<code>curl http://%HOST%/led -d "color=off"</code><br>
-<p style='margin-top:10px'>Colors: red green blue yellow cyan magenta purple orange emerald off, or #hex, or r/g/b params.<br>
-Optional <code>timeout</code> in ms to auto-turn-off.</p>
-</div>
-</div>
-<script>showMacro();</script>
-</body></html>
-)rawliteral";
+void handleStateGet() {
+  if (!checkAuth()) return;
+  ChunkWriter& o = pageOut;
+  server.sendHeader(CACHE_CONTROL_HEADER, "no-store");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  o.printf("{\"fw\":\"" FW_VERSION "\",\"ledPin\":%d,\"btnPin\":%d,\"mode\":%d,\"password\":%s,\"sta\":%s,\"host\":\"%s\",\"ip\":\"",
+           ledPin, btnPin, currentMode, authPassword.length() ? "true" : "false", staConnected ? "true" : "false",
+           staConnected ? MDNS_HOST ".local" : "192.168.4.1");
+  if (staConnected) o.printIP(WiFi.localIP());
+  o.print("\",\"ssid\":");
+  printJsonString(o, wifiSSID);
+  o.print(",\"pass\":");
+  printJsonString(o, wifiPass);
+  o.print(",\"macro\":");
+  printJsonString(o, macroText);
+  o.print("}");
+  o.flush();
+  server.sendContent("", 0); // Terminating chunk
+}
 
+// ── Web: Main page ──────────────────────────────────────────
 void handleRoot() {
   if (!checkAuth()) return;
-  String html = FPSTR(PAGE_MAIN);
-  html.replace("%FW%", FW_VERSION);
-  html.replace("%LEDPIN%", String(ledPin));
-  html.replace("%BTNPIN%", String(btnPin));
-  String staInfo = staConnected ?
-    "| WiFi: " + wifiSSID + " (" + WiFi.localIP().toString() + ")" : "";
-  html.replace("%STAINFO%", staInfo);
-  html.replace("%S0%", currentMode==0 ? "selected" : "");
-  html.replace("%S1%", currentMode==1 ? "selected" : "");
-  html.replace("%MACRO%", macroText);
-  html.replace("%PWSTATUS%", authPassword.length() > 0 ? "Protected" : "No password set");
-  html.replace("%PWCOLOR%", authPassword.length() > 0 ? "#34d399" : "#ef4444");
-  String host = staConnected ? String(MDNS_HOST) + ".local" : "192.168.4.1";
-  html.replace("%HOST%", host);
-  server.send(200, "text/html", html);
+  sendPage(indexPage);
 }
 
 // ── Web: Save mode ──────────────────────────────────────────
 void handleSetMode() {
   if (!checkAuth()) return;
-  currentMode = server.arg("mode").toInt();
-  if (currentMode == 1) {
-    macroText = server.arg("macro");
-    savePref("macro", macroText);
+  int mode = server.arg("mode").toInt();
+  if (mode == 1) {
+    // Compile first so a macro with syntax errors is never saved
+    String text = server.arg("macro");
+    static uint8_t bc[MACRO_BC_MAX];
+    MacroError errors[MACRO_MAX_ERRORS];
+    int errorCount;
+    size_t len = compileMacro(text, bc, sizeof(bc), errors, errorCount);
+    if (errorCount > 0) {
+      String list;
+      for (int i = 0; i < errorCount && i < MACRO_MAX_ERRORS; i++)
+        list += errors[i].line > 0 ? "<p>Line " + String(errors[i].line) + ": " + errors[i].msg + "</p>"
+                                   : String("<p>") + errors[i].msg + "</p>";
+      if (errorCount > MACRO_MAX_ERRORS) list += "<p>...and " + String(errorCount - MACRO_MAX_ERRORS) + " more</p>";
+      server.send(400, "text/html",
+        "<html><body style='background:#111;color:#eee;text-align:center;font-family:system-ui'>"
+        "<h2 style='color:#ef4444'>Macro not saved</h2>" + list +
+        "<a href='/' style='color:#34d399'>Back</a></body></html>");
+      return;
+    }
+    macroAbort();
+    macroText = text;
+    memcpy(macroBc, bc, len);
+    macroBcLen = len;
+    configTouch(CFG_MACRO);
   }
-  savePref("mode", currentMode);
+  currentMode = mode;
+  configTouch(CFG_SETTINGS);
+  configCommit();
   server.sendHeader("Location", "/?saved=1");
   server.send(302);
 }
 
+// ── Web: Macro status / abort ────────────────────────────────
+void handleMacroGet() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  if (!macro.running) {
+    server.send(200, "application/json", "{\"running\":false}");
+    return;
+  }
+  server.send(200, "application/json",
+    "{\"running\":true,\"line\":" + String(macro.line) +
+    ",\"elapsed\":" + String(millis() - macro.started) + "}");
+}
+
+void handleMacroAbort() {
+  if (!checkAuth()) return;
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  bool wasRunning = macro.running;
+  macroAbort();
+  server.send(200, "application/json", wasRunning ? "{\"ok\":true,\"aborted\":true}" : "{\"ok\":true,\"aborted\":false}");
+}
+
+// ── Web: Event stream ───────────────────────────────────────
+void handleEventsGet() {
+  if (!checkAuth()) return;
+  SseClient* c = nullptr;
+  for (auto& s : sseClients)
+    if (!s.used) { c = &s; break; }
+  if (!c) {
+    server.send(503, "text/plain", "Too many subscribers");
+    return;
+  }
+  int frames = server.arg("frames").toInt();
+  c->client = server.detachClient();
+  c->client.setNoDelay(true);
+  static const char HEAD[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-store\r\n"
+    "Access-Control-Allow-Origin: *\r\nConnection: keep-alive\r\n\r\n";
+  if (sseWrite(c->client, HEAD, sizeof(HEAD) - 1) != sizeof(HEAD) - 1) {
+    c->client.stop();
+    c->client = WiFiClient();
+    return;
+  }
+  if (sseSubscribers++ == 0) {
+    sseLastPing = millis();
+    ledSummary(sseLedLast, sizeof(sseLedLast));
+  }
+  c->used = true;
+  c->cursor = sseHead;
+  c->frameMs = frames > 0 ? std::max(frames, SSE_FRAME_MIN_MS) : 0;
+  c->lastFrame = millis() - c->frameMs;
+  c->frameSeq = 1; // Odd, so never a settled mirrorSeq: the first frame goes out right away
+  // Greeting: the current LED state
+  char summary[sizeof(sseLedLast)];
+  ledSummary(summary, sizeof(summary));
+  sseOwnEvent(*c, "led", "%s", summary);
+  sseFlush(*c);
+}
+
 // ── Web: Button pin test ──────────────────────────────────────
 void handleBtnTest() {
   if (!checkAuth()) return;
@@ -716,6 +3307,14 @@ void handleBtnTest() {
   server.send(200, "application/json", "{\"pressed\":" + pressed + "}");
 }
 
+// Debounced state and edge counters from the interrupt ring
+void handleBtnGet() {
+  if (!checkAuth()) return;
+  server.send(200, "application/json",
+    "{\"pin\":" + String(btnPin) + ",\"pressed\":" + String(lastBtnState == LOW ? "true" : "false") +
+    ",\"edges\":" + String((unsigned long)btnHead.load()) + ",\"dropped\":" + String((unsigned long)btnDropped) + "}");
+}
+
 // ── Web: Password ────────────────────────────────────────────
 void handlePasswordPost() {
   if (!checkAuth()) return;
@@ -723,7 +3322,7 @@ void handlePasswordPost() {
   String newPass = server.arg("password");
 
   // If a password is already set, require the current password to change it
-  if (authPassword.length() > 0 && currentPass != authPassword) {
+  if (authPassword.length() > 0 && !passwordMatches(currentPass)) {
     server.send(200, "text/html",
       "<html><body style='background:#111;color:#eee;text-align:center;font-family:system-ui'>"
       "<h2 style='color:#ef4444'>Current password is incorrect</h2>"
@@ -731,132 +3330,96 @@ void handlePasswordPost() {
     return;
   }
 
+  if (newPass.length() > PASSWORD_MAX) {
+    server.send(400, "text/plain", "Password too long (max " + String(PASSWORD_MAX) + ")");
+    return;
+  }
+
   authPassword = newPass;
-  savePref("authPass", authPassword);
+  configTouch(CFG_SETTINGS);
+  configCommit();
+  applySocketAuth();
+  sessionRekey(); // Tokens signed with the old password stop working
   server.sendHeader("Location", "/?pw=1");
   server.send(302);
 }
 
-// ── Web: WiFi config ────────────────────────────────────────
-const char PAGE_WIFI[] PROGMEM = R"rawliteral(
-<!DOCTYPE html><html><head>
-<meta name='viewport' content='width=device-width,initial-scale=1'>
-<style>
-body{font-family:system-ui;margin:20px;text-align:center;background:#111;color:#eee}
-.c{max-width:500px;margin:0 auto}
-h1{color:#34d399}
-input,button{padding:10px;margin:5px;font-size:15px;border-radius:6px;border:1px solid #333;background:#222;color:#eee;width:80%}
-button{background:#34d399;color:#111;cursor:pointer;border:none;font-weight:bold;width:auto}
-.info{background:#1a2e1a;padding:10px;border-radius:8px;margin:10px 0;font-size:13px}
-a{color:#34d399}
-</style></head><body><div class='c'>
-<h1>WiFi Settings</h1>
-<div class='info'>
-  Current: %STATUS%<br>
-  Connect to your home WiFi so Claude Code can reach the button.
-</div>
-<form action='/wifi' method='post'>
-  <input name='ssid' placeholder='WiFi Network Name' value='%SSID%'><br>
-  <input name='pass' type='password' placeholder='Password' value='%PASS%'><br>
-  <button type='submit'>Save & Connect</button>
-</form>
-<br><a href='/'>Back</a>
-</div></body></html>
-)rawliteral";
+// ── Web: Login ──────────────────────────────────────────────
+// Credentials as Basic Auth or a "password" form field; ttl= in seconds
+void handleLoginPost() {
+  bool ok = authPassword.length() == 0 || server.authenticate("admin", authPassword.c_str()) ||
+            (server.hasArg("password") && passwordMatches(server.arg("password")));
+  if (!ok) {
+    server.requestAuthentication();
+    return;
+  }
+  uint32_t ttl = server.hasArg("ttl") ? constrain(server.arg("ttl").toInt(), 60L, (long)SESSION_TTL_MAX) : SESSION_TTL;
+  char token[TOKEN_LEN + 1];
+  sessionSign(uptimeSec() + ttl, token);
+  server.sendHeader("Set-Cookie", String(SESSION_COOKIE "=") + token + "; Max-Age=" + String(ttl) +
+                    "; Path=/; HttpOnly; SameSite=Strict");
+  server.send(200, "application/json",
+    String("{\"token\":\"") + token + "\",\"expiresIn\":" + String(ttl) + "}");
+}
+
+// Drops the cookie; tokens themselves stay valid until they expire
+void handleLogoutPost() {
+  server.sendHeader("Set-Cookie", SESSION_COOKIE "=; Max-Age=0; Path=/; HttpOnly; SameSite=Strict");
+  server.send(204);
+}
 
+// ── Web: WiFi config ────────────────────────────────────────
 void handleWifiGet() {
   if (!checkAuth()) return;
-  String html = FPSTR(PAGE_WIFI);
-  String status = staConnected ?
-    "Connected to " + wifiSSID + " (" + WiFi.localIP().toString() + ")" :
-    (wifiSSID.length() > 0 ? "Saved but not connected: " + wifiSSID : "Not configured");
-  html.replace("%STATUS%", status);
-  html.replace("%SSID%", wifiSSID);
-  html.replace("%PASS%", wifiPass);
-  server.send(200, "text/html", html);
+  sendPage(wifiPage);
 }
 
 void handleWifiPost() {
   if (!checkAuth()) return;
-  wifiSSID = server.arg("ssid");
-  wifiPass = server.arg("pass");
-  savePref("wifiSSID", wifiSSID);
-  savePref("wifiPass", wifiPass);
+  String ssid = server.arg("ssid"), pass = server.arg("pass");
+  if (ssid.length() > WIFI_SSID_MAX || pass.length() > WIFI_PASS_MAX) {
+    server.send(400, "text/plain", "SSID or password too long");
+    return;
+  }
+  wifiSSID = ssid;
+  wifiPass = pass;
+  configTouch(CFG_SETTINGS);
+  configCommit();
 
-  // Try connecting
+  // Try connecting in the background: blue, then green or red for 1s
   if (wifiSSID.length() > 0) {
-    WiFi.begin(wifiSSID.c_str(), wifiPass.c_str());
-    unsigned long start = millis();
-    setAllLeds(0, 100, 255); // Blue while connecting
-    while (WiFi.status() != WL_CONNECTED && millis() - start < 15000) {
-      delay(500);
-    }
-    if (WiFi.status() == WL_CONNECTED) {
-      staConnected = true;
-      setAllLeds(0, 255, 0); // Green on success
-      delay(1000);
-      setAllLeds(0, 0, 0);
-    } else {
-      setAllLeds(255, 0, 0); // Red on failure
-      delay(1000);
-      setAllLeds(0, 0, 0);
-    }
+    WiFi.mode(WIFI_AP_STA);
+    staBegin(1000, true);
   }
   server.sendHeader("Location", "/wifi");
   server.send(302);
 }
 
 // ── Web: Pin config ─────────────────────────────────────────
-const char PAGE_PINS[] PROGMEM = R"rawliteral(
-<!DOCTYPE html><html><head>
-<meta name='viewport' content='width=device-width,initial-scale=1'>
-<style>
-body{font-family:system-ui;margin:20px;text-align:center;background:#111;color:#eee}
-.c{max-width:500px;margin:0 auto}
-h1{color:#34d399}
-input,button,select{padding:10px;margin:5px;font-size:15px;border-radius:6px;border:1px solid #333;background:#222;color:#eee}
-button{background:#34d399;color:#111;cursor:pointer;border:none;font-weight:bold}
-.info{background:#1a1a2e;padding:15px;border-radius:8px;margin:10px 0;font-size:13px;text-align:left}
-a{color:#34d399}
-.ok{color:#34d399;font-weight:bold}
-</style></head><body><div class='c'>
-<h1>Pin Configuration</h1>
-<div class='info'>
-  Current LED pin: <strong>%LEDPIN%</strong> | Button pin: <strong>%BTNPIN%</strong><br><br>
-  If LEDs don't work, try different GPIO numbers. Common ESP32-S3 LED pins: 48, 47, 38, 35, 18, 8.<br>
-  Common button pins: 0, 1, 2, 3, 4, 5.
-</div>
-
-<h3>Test LED Pin</h3>
-<form action='/pins/test' method='post'>
-  <input name='pin' type='number' min='0' max='48' value='%LEDPIN%' style='width:80px'>
-  <button type='submit'>Flash LEDs on this pin</button>
-</form>
-
-<h3>Save Pin Config</h3>
-<form action='/pins' method='post'>
-  LED GPIO: <input name='ledpin' type='number' min='0' max='48' value='%LEDPIN%' style='width:80px'><br>
-  Button GPIO: <input name='btnpin' type='number' min='0' max='48' value='%BTNPIN%' style='width:80px'><br>
-  <button type='submit'>Save & Reboot</button>
-</form>
-<br><a href='/'>Back</a>
-</div></body></html>
-)rawliteral";
+// GPIOs the LED or button may use on the S3: 19/20 are USB, 22-25 don't
+// exist, 26-32 belong to flash/PSRAM and 45/46 are strapping pins that must
+// sit at their boot level. 0 and 3 strap too, but they're the board's
+// button and LED.
+bool pinUsable(int pin) {
+  return pin >= 0 && pin <= 48 && !(pin >= 19 && pin <= 32 && pin != 21) && pin != 45 && pin != 46;
+}
 
 void handlePinsGet() {
   if (!checkAuth()) return;
-  String html = FPSTR(PAGE_PINS);
-  html.replace("%LEDPIN%", String(ledPin));
-  html.replace("%BTNPIN%", String(btnPin));
-  server.send(200, "text/html", html);
+  sendPage(pinsPage);
 }
 
 void handlePinsPost() {
   if (!checkAuth()) return;
-  int newLed = server.arg("ledpin").toInt();
-  int newBtn = server.arg("btnpin").toInt();
-  savePref("ledPin", newLed);
-  savePref("btnPin", newBtn);
+  int led = server.arg("ledpin").toInt(), btn = server.arg("btnpin").toInt();
+  if (!pinUsable(led) || !pinUsable(btn) || led == btn) {
+    server.send(400, "text/plain", "Invalid pin");
+    return;
+  }
+  ledPin = led; // Takes effect after the reboot
+  btnPin = btn;
+  configTouch(CFG_SETTINGS);
+  configCommit();
   server.send(200, "text/html",
     "<html><body style='background:#111;color:#eee;text-align:center;font-family:system-ui'>"
     "<h2 style='color:#34d399'>Saved! Rebooting...</h2>"
@@ -868,79 +3431,509 @@ void handlePinsPost() {
 void handlePinTest() {
   if (!checkAuth()) return;
   int testPin = server.arg("pin").toInt();
+  if (!pinUsable(testPin) || testPin == btnPin) {
+    server.send(400, "text/plain", "Invalid pin");
+    return;
+  }
   // Save pin and reboot for a clean RMT initialization
-  savePref("ledPin", testPin);
+  ledPin = testPin;
+  configTouch(CFG_SETTINGS);
+  configCommit();
   server.send(200, "application/json", "{\"ok\":true,\"pin\":" + String(testPin) + ",\"rebooting\":true}");
   delay(500);
   ESP.restart();
 }
 
+// Background sweep: each pin gets 1.5s green then 0.3s dark, one step per
+// loop() pass. "Found" saves the pin that just lit and ends the sweep.
+// Skips GPIO 19/20 (USB), 22-25 (not on S3), 26-32 (flash/PSRAM), 45/46 (strapping)
+const uint8_t SWEEP_PINS[] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,21,33,34,35,36,37,38,39,40,41,42,43,44,47,48};
+#define SWEEP_PIN_COUNT (int)(sizeof(SWEEP_PINS) / sizeof(SWEEP_PINS[0]))
+#define SWEEP_ON_MS  1500
+#define SWEEP_OFF_MS 300
+
+struct PinSweep {
+  bool running;
+  bool lit;             // In the green half of the current step
+  int index;            // Into SWEEP_PINS
+  int done;             // Pins fully shown
+  int found;            // Pin saved via "found", -1 if none
+  unsigned long stepAt; // Start of the current half-step
+};
+PinSweep sweep = { false, false, 0, 0, -1, 0 };
+
+// The button pin is left alone so the button stays usable mid-sweep
+int sweepNextIndex(int from) {
+  while (from < SWEEP_PIN_COUNT && SWEEP_PINS[from] == btnPin) from++;
+  return from;
+}
+
+void sweepShow(bool on) {
+  sweep.lit = on;
+  sweep.stepAt = millis();
+  ledOutPin = SWEEP_PINS[sweep.index];
+  setLocalLeds(0, on ? 255 : 0, 0);
+  if (on) Serial.printf("Testing pin %d (%d/%d)\n", ledOutPin, sweep.index + 1, SWEEP_PIN_COUNT);
+}
+
+void sweepStop(const char* why) {
+  sweep.running = false;
+  ledOutPin = ledPin; // Back to the saved pin
+  clearLayer(LAYER_LOCAL);
+  Serial.printf("Sweep %s\n", why);
+}
+
+void tickPinSweep() {
+  if (!sweep.running) return;
+  unsigned long elapsed = millis() - sweep.stepAt;
+  if (sweep.lit) {
+    if (elapsed >= SWEEP_ON_MS) sweepShow(false);
+  } else if (elapsed >= SWEEP_OFF_MS) {
+    sweep.done++;
+    sweep.index = sweepNextIndex(sweep.index + 1);
+    if (sweep.index >= SWEEP_PIN_COUNT) { sweepStop("done"); return; }
+    sweepShow(true);
+  }
+  wakeAt(sweep.stepAt + (sweep.lit ? SWEEP_ON_MS : SWEEP_OFF_MS));
+}
+
+// Pins still to show from `from` on, counting the current one
+int sweepCount(int from) {
+  int n = 0;
+  for (int i = sweepNextIndex(from); i < SWEEP_PIN_COUNT; i = sweepNextIndex(i + 1)) n++;
+  return n;
+}
+
+void sendSweepStatus() {
+  String json = "{\"running\":" + String(sweep.running ? "true" : "false");
+  if (sweep.running) {
+    long eta = (long)sweepCount(sweep.index) * (SWEEP_ON_MS + SWEEP_OFF_MS)
+               - (long)(millis() - sweep.stepAt) - (sweep.lit ? 0 : SWEEP_ON_MS);
+    json += ",\"pin\":" + String(SWEEP_PINS[sweep.index]) + ",\"lit\":" + String(sweep.lit ? "true" : "false");
+    json += ",\"etaMs\":" + String(eta > 0 ? eta : 0L);
+  }
+  json += ",\"done\":" + String(sweep.done) + ",\"total\":" + String(sweepCount(0));
+  json += ",\"found\":" + String(sweep.found) + "}";
+  server.send(200, "application/json", json);
+}
+
 void handlePinSweep() {
   if (!checkAuth()) return;
-  server.send(200, "text/plain", "Sweeping all GPIO pins... watch the LEDs. ~60 seconds.");
-  // Skip GPIO 19/20 (USB), 22-25 (not on S3), 26-32 (flash/PSRAM)
-  int pins[] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,21,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48};
-  int count = sizeof(pins)/sizeof(pins[0]);
-  for (int i = 0; i < count; i++) {
-    Serial.printf("Testing pin %d (%d/%d)\n", pins[i], i+1, count);
-    initLeds(pins[i]);
-    setAllLeds(0, 255, 0);
-    delay(1500);
-    setAllLeds(0, 0, 0);
-    delay(300);
+  if (!sweep.running) {
+    sweep = { true, false, sweepNextIndex(0), 0, -1, 0 };
+    sweepShow(true);
   }
-  // Restore saved pin
-  initLeds(ledPin);
-  Serial.println("Sweep done");
+  sendSweepStatus();
 }
 
-// ── Web: OTA update ─────────────────────────────────────────
-const char PAGE_UPDATE[] PROGMEM = R"rawliteral(
-<!DOCTYPE html><html><head>
-<meta name='viewport' content='width=device-width,initial-scale=1'>
-<style>
-body{font-family:system-ui;margin:20px;text-align:center;background:#111;color:#eee}
-.c{max-width:500px;margin:0 auto}
-h1{color:#34d399}
-button{background:#ef4444;color:white;border:none;padding:10px 20px;border-radius:6px;cursor:pointer;font-size:15px}
-button:hover{background:#dc2626}
-input[type='file']{margin:20px 0;color:#eee}
-.warn{color:#ef4444;background:#2a1a1a;padding:15px;border-radius:8px;margin:20px 0}
-.info{background:#1a2e1a;padding:15px;border-radius:8px;margin:20px 0;text-align:left;font-size:13px}
-a{color:#34d399}
-</style></head><body><div class='c'>
-<h1>Firmware Update</h1>
-<p>Current version: <strong>%FW%</strong></p>
-<div class='warn'><strong>Warning:</strong> Only upload trusted .bin firmware files.</div>
-<div class='info'>
-  1. Select firmware .bin file<br>
-  2. Click Update<br>
-  3. Wait for reboot (~10s)<br>
-  4. Reconnect to clickgit WiFi
-</div>
-<form method='POST' enctype='multipart/form-data'>
-  <input type='file' name='update' accept='.bin' required><br><br>
-  <button type='submit' onclick="return confirm('Update firmware?')">Update Firmware</button>
-</form>
-<br><a href='/'>Back</a>
-</div></body></html>
-)rawliteral";
+void handlePinSweepStatus() {
+  if (!checkAuth()) return;
+  sendSweepStatus();
+}
+
+void handlePinSweepCancel() {
+  if (!checkAuth()) return;
+  if (sweep.running) sweepStop("cancelled");
+  sendSweepStatus();
+}
+
+// Saves the pin on screen (or pin=N, from a status reply) as the LED pin
+void handlePinSweepFound() {
+  if (!checkAuth()) return;
+  int pin = server.hasArg("pin") ? server.arg("pin").toInt() : (sweep.running ? SWEEP_PINS[sweep.index] : -1);
+  if (pin < 0) {
+    server.send(400, "application/json", "{\"error\":\"no pin\"}");
+    return;
+  }
+  if (!pinUsable(pin) || pin == btnPin) {
+    server.send(400, "application/json", "{\"error\":\"pin not usable\"}");
+    return;
+  }
+  sweep.found = pin;
+  ledPin = pin;
+  configTouch(CFG_SETTINGS);
+  configCommit();
+  if (sweep.running) sweepStop("found");
+  else initLeds(ledPin);
+  sendSweepStatus();
+}
+
+// ── Web: Metrics ────────────────────────────────────────────
+// Prometheus text format, streamed through pageOut. Routes nobody has
+// called yet are left out.
+const char* methodName(HTTPMethod m) {
+  switch (m) {
+    case HTTP_GET:     return "GET";
+    case HTTP_POST:    return "POST";
+    case HTTP_OPTIONS: return "OPTIONS";
+    default:           return "ANY";
+  }
+}
+
+void emitHistogram(const char* name, const char* labels, const Histogram& h) {
+  uint32_t cumulative = 0;
+  const char* sep = labels[0] ? "," : "";
+  for (int i = 0; i <= h.buckets; i++) {
+    cumulative += h.counts[i].load(std::memory_order_relaxed);
+    if (i < h.buckets)
+      pageOut.printf("%s_bucket{%s%sle=\"%g\"} %u\n", name, labels, sep, h.bounds[i] / 1e6, (unsigned)cumulative);
+    else
+      pageOut.printf("%s_bucket{%s%sle=\"+Inf\"} %u\n", name, labels, sep, (unsigned)cumulative);
+  }
+  const char* open = labels[0] ? "{" : "";
+  const char* close = labels[0] ? "}" : "";
+  pageOut.printf("%s_sum%s%s%s %.6f\n", name, open, labels, close, h.sumUs.load(std::memory_order_relaxed) / 1e6);
+  pageOut.printf("%s_count%s%s%s %u\n", name, open, labels, close, (unsigned)h.total.load(std::memory_order_relaxed));
+}
+
+void emitMetric(const char* name, const char* type, const char* help) {
+  pageOut.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void handleMetrics() {
+  if (!checkAuth()) return;
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain; version=0.0.4", "");
+  static const char* const CLASSES[] = { "2xx", "3xx", "4xx", "5xx" };
+  char labels[96];
+
+  emitMetric("clickgit_http_requests_total", "counter", "HTTP requests by route and status class");
+  for (int i = 0; i < routeCount; i++) {
+    const RouteMetrics& r = routeMetrics[i];
+    for (int c = 0; c < 4; c++) {
+      uint32_t n = r.byClass[c].load(std::memory_order_relaxed);
+      if (n) pageOut.printf("clickgit_http_requests_total{route=\"%s\",method=\"%s\",code=\"%s\"} %u\n",
+                            r.uri, methodName(r.method), CLASSES[c], (unsigned)n);
+    }
+  }
+  emitMetric("clickgit_http_request_duration_seconds", "histogram", "Handler time per route");
+  for (int i = 0; i < routeCount; i++) {
+    const RouteMetrics& r = routeMetrics[i];
+    if (!r.latency.total.load(std::memory_order_relaxed)) continue;
+    snprintf(labels, sizeof(labels), "route=\"%s\",method=\"%s\"", r.uri, methodName(r.method));
+    emitHistogram("clickgit_http_request_duration_seconds", labels, r.latency);
+  }
+  emitMetric("clickgit_loop_duration_seconds", "histogram", "Work time of one loop() pass, excluding sleep");
+  emitHistogram("clickgit_loop_duration_seconds", "", loopTime);
+  emitMetric("clickgit_strip_show_duration_seconds", "histogram", "Time spent in strip->show()");
+  emitHistogram("clickgit_strip_show_duration_seconds", "", showTime);
+
+  emitMetric("clickgit_loop_wakeups_total", "counter", "loop() passes");
+  pageOut.printf("clickgit_loop_wakeups_total %u\n", (unsigned)loopWakeups);
+  emitMetric("clickgit_loop_idle_seconds_total", "counter", "Time the main task spent asleep");
+  pageOut.printf("clickgit_loop_idle_seconds_total %.6f\n", loopIdleUs / 1e6);
+  emitMetric("clickgit_heap_free_bytes", "gauge", "Free heap");
+  pageOut.printf("clickgit_heap_free_bytes %u\n", (unsigned)ESP.getFreeHeap());
+  emitMetric("clickgit_heap_largest_free_block_bytes", "gauge", "Largest allocatable block");
+  pageOut.printf("clickgit_heap_largest_free_block_bytes %u\n", (unsigned)ESP.getMaxAllocHeap());
+  emitMetric("clickgit_wifi_connected", "gauge", "1 while joined to the home network");
+  pageOut.printf("clickgit_wifi_connected %d\n", staConnected ? 1 : 0);
+  if (staConnected) {
+    emitMetric("clickgit_wifi_rssi_dbm", "gauge", "Signal strength of the home network");
+    pageOut.printf("clickgit_wifi_rssi_dbm %d\n", (int)WiFi.RSSI());
+  }
+  emitMetric("clickgit_wifi_reconnects_total", "counter", "Times the station came back after a drop");
+  pageOut.printf("clickgit_wifi_reconnects_total %u\n", (unsigned)staReconnects.load());
+  emitMetric("clickgit_focus_sessions_total", "counter", "Focus timers started");
+  pageOut.printf("clickgit_focus_sessions_total %u\n", (unsigned)focusSessions.load());
+  emitMetric("clickgit_macro_runs_total", "counter", "Macros started");
+  pageOut.printf("clickgit_macro_runs_total %u\n", (unsigned)macroRuns.load());
+  emitMetric("clickgit_frames_rendered_total", "counter", "Frames drawn by the renderer");
+  pageOut.printf("clickgit_frames_rendered_total %u\n", (unsigned)framesRendered.load());
+  emitMetric("clickgit_frames_sent_total", "counter", "Frames that changed and went out to the strip");
+  pageOut.printf("clickgit_frames_sent_total %u\n", (unsigned)framesSent.load());
+  emitMetric("clickgit_uptime_seconds", "gauge", "Time since boot");
+  pageOut.printf("clickgit_uptime_seconds %lu\n", millis() / 1000);
+  pageOut.flush();
+  server.sendContent("", 0); // Terminating chunk
+}
+
+// Last RECENT_REQUESTS requests, oldest first
+void handleMetricsRecent() {
+  if (!checkAuth()) return;
+  String json = "{\"requests\":[";
+  uint32_t first = recentNext > RECENT_REQUESTS ? recentNext - RECENT_REQUESTS : 0;
+  for (uint32_t i = first; i < recentNext; i++) {
+    const RecentRequest& r = recentRequests[i % RECENT_REQUESTS];
+    const RouteMetrics& route = routeMetrics[r.route];
+    if (i > first) json += ",";
+    json += "{\"route\":\"" + String(route.uri) + "\",\"method\":\"" + methodName(route.method) +
+            "\",\"status\":" + String(r.status) + ",\"us\":" + String((unsigned long)r.us) +
+            ",\"at\":" + String(r.at) + "}";
+  }
+  json += "]}";
+  server.send(200, "application/json", json);
+}
 
+// ── Web: OTA update ─────────────────────────────────────────
 void handleUpdateGet() {
   if (!checkAuth()) return;
-  String html = FPSTR(PAGE_UPDATE);
-  html.replace("%FW%", FW_VERSION);
-  server.send(200, "text/html", html);
+  sendPage(updatePage);
+}
+
+// Images arrive raw, gzip or zlib; the first byte decides (a raw ESP image
+// starts with 0xE9). Compressed ones go through the ROM's tinfl with a 32 KB
+// window, so flash sees exactly what a raw upload would write. ?sha256= is
+// checked against that inflated image and ?size= against its length before
+// the new partition is made bootable; any failure aborts the update.
+enum OtaFormat : uint8_t { OTA_RAW, OTA_GZIP, OTA_ZLIB };
+enum OtaStage : uint8_t { OTA_DETECT, OTA_GZIP_HEADER, OTA_BODY, OTA_GZIP_TRAILER, OTA_DONE, OTA_FAILED };
+
+#define GZ_FHCRC    0x02
+#define GZ_FEXTRA   0x04
+#define GZ_FNAME    0x08
+#define GZ_FCOMMENT 0x10
+
+struct OtaInflate {
+  tinfl_decompressor inflator;
+  uint8_t window[TINFL_LZ_DICT_SIZE]; // Output ring; also the back-reference history
+};
+
+struct OtaUpload {
+  OtaStage stage;
+  OtaFormat format;
+  bool begun;             // Update.begin() succeeded
+  OtaInflate* inflate;    // Only while a compressed image streams in
+  size_t windowPos;
+  uint8_t gzFlags;        // Optional gzip header fields still to skip
+  uint8_t gzPos;          // Fixed header bytes seen (12 once FEXTRA's length is in)
+  uint16_t gzSkip;        // FEXTRA bytes left, then FHCRC bytes seen
+  uint8_t trailer[8];     // gzip CRC-32 and ISIZE
+  uint8_t trailerLen;
+  uint8_t inTail[4];      // Last bytes the inflater took (its look-ahead at the end)
+  uint32_t crc;
+  size_t written;         // Inflated bytes sent to flash
+  size_t expected;        // ?size=, 0 = not given
+  bool hasHash;
+  uint8_t hash[32];       // ?sha256=
+  const char* error;
+  int shownProgress;
+};
+OtaUpload ota = {};
+mbedtls_md_context_t otaSha; // Set up once; restarted per upload
+bool otaShaReady = false;
+
+struct Crc32Table { uint32_t v[256]; };
+
+constexpr Crc32Table makeCrc32() {
+  Crc32Table t{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+    t.v[i] = c;
+  }
+  return t;
+}
+
+constexpr Crc32Table CRC32 = makeCrc32();
+
+void otaFreeInflate() {
+  delete ota.inflate;
+  ota.inflate = nullptr;
+}
+
+void otaFail(const char* reason) {
+  if (ota.stage == OTA_FAILED) return;
+  ota.stage = OTA_FAILED;
+  ota.error = reason;
+  otaFreeInflate();
+  Serial.printf("OTA failed: %s\n", reason);
+  if (!ota.begun) return;
+  if (Update.isRunning()) Update.abort();
+  setLocalLeds(255, 0, 0);
+}
+
+void otaWrite(const uint8_t* p, size_t n) {
+  mbedtls_md_update(&otaSha, p, n);
+  uint32_t c = ota.crc;
+  for (size_t i = 0; i < n; i++) c = CRC32.v[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+  ota.crc = c;
+  ota.written += n;
+  if (ota.expected && ota.written > ota.expected) { otaFail("size mismatch"); return; }
+  if (Update.write((uint8_t*)p, n) != n) {
+    Update.printError(Serial);
+    otaFail("flash write failed");
+  }
+}
+
+void otaDetect(uint8_t first) {
+  ota.format = first == 0x1f ? OTA_GZIP : first == 0x78 ? OTA_ZLIB : OTA_RAW;
+  ota.stage = ota.format == OTA_GZIP ? OTA_GZIP_HEADER : OTA_BODY;
+  if (ota.format == OTA_RAW) return;
+  ota.inflate = new (std::nothrow) OtaInflate;
+  if (!ota.inflate) { otaFail("out of memory"); return; }
+  tinfl_init(&ota.inflate->inflator);
+}
+
+// RFC 1952 header: 10 fixed bytes, then whichever optional fields FLG names
+size_t otaGzipHeader(const uint8_t* p, size_t n) {
+  size_t i = 0;
+  while (i < n && ota.stage == OTA_GZIP_HEADER) {
+    uint8_t c = p[i++];
+    if (ota.gzPos < 10) {
+      static const uint8_t MAGIC[3] = { 0x1f, 0x8b, 8 };
+      if (ota.gzPos < 3 && c != MAGIC[ota.gzPos]) { otaFail("corrupt image"); break; }
+      if (ota.gzPos == 3) {
+        if (c & 0xE0) { otaFail("corrupt image"); break; }
+        ota.gzFlags = c & (GZ_FHCRC | GZ_FEXTRA | GZ_FNAME | GZ_FCOMMENT);
+      }
+      ota.gzPos++;
+    } else if (ota.gzFlags & GZ_FEXTRA) {
+      if (ota.gzPos < 12) ota.gzSkip |= c << (8 * (ota.gzPos++ - 10));
+      else ota.gzSkip--;
+      if (ota.gzPos == 12 && ota.gzSkip == 0) ota.gzFlags &= ~GZ_FEXTRA;
+    } else if (ota.gzFlags & GZ_FNAME) {
+      if (c == 0) ota.gzFlags &= ~GZ_FNAME;
+    } else if (ota.gzFlags & GZ_FCOMMENT) {
+      if (c == 0) ota.gzFlags &= ~GZ_FCOMMENT;
+    } else if (++ota.gzSkip == 2) {
+      ota.gzFlags &= ~GZ_FHCRC;
+    }
+    if (ota.gzPos >= 10 && !ota.gzFlags) ota.stage = OTA_BODY;
+  }
+  return i;
+}
+
+// Consumes compressed bytes up to the end of the deflate stream, flushing
+// the window to flash each time it fills or the input runs out
+void otaKeepTail(const uint8_t* p, size_t n) {
+  const size_t keep = sizeof(ota.inTail);
+  if (n >= keep) { memcpy(ota.inTail, p + n - keep, keep); return; }
+  memmove(ota.inTail, ota.inTail + n, keep - n);
+  memcpy(ota.inTail + keep - n, p, n);
+}
+
+size_t otaInflate(const uint8_t* p, size_t n) {
+  mz_uint32 flags = TINFL_FLAG_HAS_MORE_INPUT;
+  if (ota.format == OTA_ZLIB) flags |= TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32;
+  size_t used = 0;
+  for (;;) {
+    OtaInflate* z = ota.inflate;
+    size_t in = n - used, out = TINFL_LZ_DICT_SIZE - ota.windowPos;
+    tinfl_status st = tinfl_decompress(&z->inflator, p + used, &in, z->window, z->window + ota.windowPos, &out, flags);
+    otaKeepTail(p + used, in);
+    used += in;
+    if (out) otaWrite(z->window + ota.windowPos, out);
+    ota.windowPos = (ota.windowPos + out) & (TINFL_LZ_DICT_SIZE - 1);
+    if (ota.stage == OTA_FAILED) return used;
+    if (st == TINFL_STATUS_DONE) {
+      // The ROM's miniz reads up to 4 bytes past the end of the deflate
+      // data and keeps them in its bit buffer; they open the gzip trailer
+      size_t ahead = std::min<size_t>(z->inflator.m_num_bits >> 3, sizeof(ota.inTail));
+      memcpy(ota.trailer, ota.inTail + sizeof(ota.inTail) - ahead, ahead);
+      ota.trailerLen = ahead;
+      otaFreeInflate();
+      ota.stage = ota.format == OTA_GZIP ? OTA_GZIP_TRAILER : OTA_DONE;
+      return used;
+    }
+    if (st < 0) { otaFail("corrupt image"); return used; }
+    if (st == TINFL_STATUS_NEEDS_MORE_INPUT) return used;
+  }
+}
+
+void otaGzipTrailer() {
+  const uint8_t* t = ota.trailer;
+  uint32_t crc = t[0] | t[1] << 8 | t[2] << 16 | (uint32_t)t[3] << 24;
+  uint32_t size = t[4] | t[5] << 8 | t[6] << 16 | (uint32_t)t[7] << 24;
+  if (crc != ~ota.crc || size != (uint32_t)ota.written) otaFail("corrupt image");
+  else ota.stage = OTA_DONE;
+}
+
+void otaFeed(const uint8_t* p, size_t n) {
+  while (n) {
+    size_t used = 0;
+    switch (ota.stage) {
+      case OTA_DETECT:
+        otaDetect(p[0]);
+        continue;
+      case OTA_GZIP_HEADER:
+        used = otaGzipHeader(p, n);
+        break;
+      case OTA_BODY:
+        if (ota.format != OTA_RAW) { used = otaInflate(p, n); break; }
+        otaWrite(p, n);
+        used = n;
+        break;
+      case OTA_GZIP_TRAILER:
+        used = std::min(n, sizeof(ota.trailer) - ota.trailerLen);
+        memcpy(ota.trailer + ota.trailerLen, p, used);
+        ota.trailerLen += used;
+        if (ota.trailerLen == sizeof(ota.trailer)) otaGzipTrailer();
+        break;
+      default:
+        return; // Failed, or bytes after the end of the stream
+    }
+    p += used;
+    n -= used;
+  }
+}
+
+void otaFinish() {
+  if (ota.stage == OTA_BODY && ota.format == OTA_RAW) ota.stage = OTA_DONE;
+  if (ota.stage == OTA_DETECT) otaFail("empty image");
+  if (ota.stage != OTA_DONE) { otaFail("truncated image"); return; }
+  uint8_t digest[32];
+  mbedtls_md_finish(&otaSha, digest);
+  if (ota.expected && ota.written != ota.expected) { otaFail("size mismatch"); return; }
+  if (ota.hasHash && memcmp(digest, ota.hash, sizeof(digest)) != 0) { otaFail("sha256 mismatch"); return; }
+  if (!Update.end(true)) {
+    Update.printError(Serial);
+    otaFail("flash verify failed");
+    return;
+  }
+  Serial.printf("OTA ok: %u bytes\n", (unsigned)ota.written);
+  setLocalLeds(0, 255, 0);
+}
+
+bool otaParseHash(const String& hex) {
+  if (hex.length() != 64) return false;
+  for (int i = 0; i < 64; i++) {
+    char c = hex[i] | 0x20;
+    int v = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    if (v < 0) return false;
+    ota.hash[i / 2] = i & 1 ? ota.hash[i / 2] | v : v << 4;
+  }
+  return true;
+}
+
+void otaStart() {
+  otaFreeInflate();
+  ota = {};
+  ota.crc = 0xFFFFFFFF;
+  ota.shownProgress = -1;
+  // Unauthenticated uploads never reach flash; the POST handler sends the 401
+  if (!isAuthorized()) { otaFail("unauthorized"); return; }
+  if (server.hasArg("sha256")) {
+    ota.hasHash = true;
+    if (!otaParseHash(server.arg("sha256"))) { otaFail("bad sha256"); return; }
+  }
+  ota.expected = server.hasArg("size") ? (size_t)server.arg("size").toInt() : 0;
+  if (!otaShaReady) {
+    mbedtls_md_init(&otaSha);
+    mbedtls_md_setup(&otaSha, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+    otaShaReady = true;
+  }
+  mbedtls_md_starts(&otaSha);
+  setLocalLeds(128, 0, 255); // Purple = updating
+  if (!Update.begin(ota.expected ? ota.expected : UPDATE_SIZE_UNKNOWN)) {
+    Update.printError(Serial);
+    otaFail("image too large");
+    return;
+  }
+  ota.begun = true;
 }
 
 void handleUpdatePost() {
   if (!checkAuth()) return;
   server.sendHeader("Connection", "close");
-  bool ok = !Update.hasError();
-  server.send(200, "text/html",
+  bool ok = ota.stage == OTA_DONE && !Update.hasError();
+  String reason = ok ? String() : String(ota.error ? ota.error : "no image");
+  server.send(ok ? 200 : 400, "text/html",
     String("<html><body style='background:#111;color:#eee;text-align:center;font-family:system-ui'>"
-    "<h2 style='color:") + (ok ? "#34d399'>Update successful!" : "#ef4444'>Update failed!") +
+    "<h2 style='color:") + (ok ? "#34d399'>Update successful!" : "#ef4444'>Update failed: " + reason) +
     "</h2><script>setTimeout(function(){window.location='/';},5000);</script></body></html>");
+  ota.stage = OTA_DETECT;
+  ota.error = nullptr;
   delay(500);
   if (ok) ESP.restart();
 }
@@ -948,29 +3941,35 @@ void handleUpdatePost() {
 void handleUpdateUpload() {
   HTTPUpload& upload = server.upload();
   if (upload.status == UPLOAD_FILE_START) {
-    setAllLeds(128, 0, 255); // Purple = updating
-    if (!Update.begin(UPDATE_SIZE_UNKNOWN)) Update.printError(Serial);
+    otaStart();
   } else if (upload.status == UPLOAD_FILE_WRITE) {
-    // Green progress (estimate based on typical firmware size ~1.5MB)
-    int progress = (int)((float)upload.totalSize / 1500000.0f * NUM_LEDS);
+    if (ota.stage == OTA_FAILED) return;
+    otaFeed(upload.buf, upload.currentSize);
+    // Green progress by compressed bytes received
+    size_t total = server.clientContentLength();
+    if (ota.stage == OTA_FAILED || !total || total == CONTENT_LENGTH_UNKNOWN) return;
+    int progress = (int)((uint64_t)(upload.totalSize + upload.currentSize) * NUM_LEDS / total);
     if (progress > NUM_LEDS) progress = NUM_LEDS;
-    for (int i = 0; i < NUM_LEDS; i++)
-      strip->setPixelColor(i, i < progress ? strip->Color(0,255,0) : strip->Color(0,30,0));
-    strip->show();
-    if (Update.write(upload.buf, upload.currentSize) != upload.currentSize)
-      Update.printError(Serial);
-  } else if (upload.status == UPLOAD_FILE_END) {
-    if (Update.end(true)) {
-      setAllLeds(0, 255, 0);
-    } else {
-      setAllLeds(255, 0, 0);
-      Update.printError(Serial);
+    if (progress != ota.shownProgress) {
+      ota.shownProgress = progress;
+      uint8_t (*frame)[3] = layers[LAYER_LOCAL].frame;
+      for (int i = 0; i < NUM_LEDS; i++) {
+        frame[i][0] = 0;
+        frame[i][1] = i < progress ? 255 : 30;
+        frame[i][2] = 0;
+      }
+      publishLocalFrame();
     }
+  } else if (upload.status == UPLOAD_FILE_END) {
+    if (ota.stage != OTA_FAILED) otaFinish();
+  } else if (upload.status == UPLOAD_FILE_ABORTED) {
+    otaFail("upload aborted");
   }
 }
 
 // ── Web: 404 ────────────────────────────────────────────────
 void handleNotFound() {
+  bootMark(BOOT_FIRST_REQUEST);
   server.sendHeader("Access-Control-Allow-Origin", "*");
   server.send(404, "text/plain", "Not found: " + server.uri());
 }
@@ -979,44 +3978,39 @@ void handleNotFound() {
 void setup() {
   Serial.begin(115200);
   Serial.println("\n\nClickGit Button v" FW_VERSION);
+#if defined(ESP32)
+  loopTaskHandle = xTaskGetCurrentTaskHandle(); // setup() and loop() share a task
+#endif
 
   // Load saved config
   loadPrefs();
+  sessionRekey();
+  bootMark(BOOT_PREFS);
 
-  // Init LEDs
-  initLeds(ledPin);
-  setAllLeds(0, 100, 255); // Blue on boot
+  // Init LEDs (the renderer owns the strip from here on)
+  ledOutPin = ledPin;
+  setLocalLeds(0, 100, 255); // Blue on boot
+  startRenderer();
+  bootMark(BOOT_LEDS);
 
   // Init USB HID
   USB.productName("ClickGit Button");
   USB.manufacturerName("ClickGit");
   USB.begin();
   Keyboard.begin();
+  bootMark(BOOT_USB);
 
-  // Init button
-  pinMode(btnPin, INPUT_PULLUP);
+  // Init button (edges arrive by interrupt from here on)
+  attachButton();
 
-  // WiFi: always start AP, optionally also connect to home WiFi
+  // WiFi: always start AP, optionally also join home WiFi (finishes in loop())
   WiFi.mode(wifiSSID.length() > 0 ? WIFI_AP_STA : WIFI_AP);
   WiFi.softAP(AP_SSID);
   Serial.print("AP IP: "); Serial.println(WiFi.softAPIP());
+  staBegin(3000, false); // Green for 3s once settled, so the correct pin is obvious
+  bootMark(BOOT_AP);
 
-  if (wifiSSID.length() > 0) {
-    WiFi.begin(wifiSSID.c_str(), wifiPass.c_str());
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - start < 15000) {
-      delay(500);
-      Serial.print(".");
-    }
-    if (WiFi.status() == WL_CONNECTED) {
-      staConnected = true;
-      Serial.print("\nWiFi connected: "); Serial.println(WiFi.localIP());
-    } else {
-      Serial.println("\nWiFi connection failed, AP only");
-    }
-  }
-
-  // mDNS
+  // mDNS (answers on the STA interface too once it comes up)
   if (MDNS.begin(MDNS_HOST)) {
     MDNS.addService("http", "tcp", 80);
     Serial.println("mDNS: http://clickgit.local");
@@ -1024,119 +4018,104 @@ void setup() {
 
   // Web server routes
   server.on("/", HTTP_GET, handleRoot);
+  server.on("/state", HTTP_GET, handleStateGet);
   server.on("/led", HTTP_GET, handleLedGet);
   server.on("/led", HTTP_POST, handleLedPost);
   server.on("/led", HTTP_OPTIONS, handleLedOptions);
+  server.on("/led/stack", HTTP_GET, handleLedStackGet);
+  server.on("/events", HTTP_GET, handleEventsGet);
   server.on("/setmode", HTTP_POST, handleSetMode);
+  server.on("/macro", HTTP_GET, handleMacroGet);
+  server.on("/macro/abort", HTTP_POST, handleMacroAbort);
+  server.on("/timeline", HTTP_GET, handleTimelineGet);
+  server.on("/timeline", HTTP_POST, handleTimelinePost);
+  server.on("/config", HTTP_GET, handleConfigGet);
+  server.on("/boot", HTTP_GET, handleBootGet);
+  server.on("/sched", HTTP_GET, handleSchedGet);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+  server.on("/metrics/recent", HTTP_GET, handleMetricsRecent);
+  server.on("/palette", HTTP_GET, handlePaletteGet);
+  server.on("/palette", HTTP_POST, handlePalettePost);
+  server.on("/realtime", HTTP_GET, handleRealtimeGet);
+  server.on("/realtime", HTTP_POST, handleRealtimePost);
   server.on("/password", HTTP_POST, handlePasswordPost);
+  server.on("/login", HTTP_POST, handleLoginPost);
+  server.on("/logout", HTTP_POST, handleLogoutPost);
   server.on("/wifi", HTTP_GET, handleWifiGet);
   server.on("/wifi", HTTP_POST, handleWifiPost);
+  server.on("/btn", HTTP_GET, handleBtnGet);
   server.on("/btn/test", HTTP_GET, handleBtnTest);
   server.on("/pins", HTTP_GET, handlePinsGet);
   server.on("/pins", HTTP_POST, handlePinsPost);
   server.on("/pins/test", HTTP_POST, handlePinTest);
   server.on("/pinsweep", HTTP_GET, handlePinSweep);
+  server.on("/pinsweep/status", HTTP_GET, handlePinSweepStatus);
+  server.on("/pinsweep/cancel", HTTP_POST, handlePinSweepCancel);
+  server.on("/pinsweep/found", HTTP_POST, handlePinSweepFound);
   server.on("/update", HTTP_GET, handleUpdateGet);
   server.on("/update", HTTP_POST, handleUpdatePost, handleUpdateUpload);
   server.onNotFound(handleNotFound);
+  static const char* headerKeys[] = { "Cookie", "If-None-Match" };
+  server.collectHeaders(headerKeys, 2); // Authorization comes along anyway
+  server.enableDelay(false); // loop() sleeps in schedWait() instead
   server.begin();
   Serial.println("Web server started on port 80");
 
-  // Boot complete — hold green for 3s so correct pin is obvious
-  setAllLeds(0, 255, 0);
-  delay(3000);
-  setAllLeds(0, 0, 0);
+  webSocket.onEvent(onSocketEvent);
+  applySocketAuth();
+  webSocket.enableHeartbeat(15000, 3000, 2); // Drop hook clients that vanished
+  webSocket.begin();
+  Serial.printf("LED WebSocket on port %d\n", WS_PORT);
+  applyRealtimeEnabled();
+  bootMark(BOOT_HTTP);
   Serial.println("Ready!");
 }
 
 // ── Loop ────────────────────────────────────────────────────
 void loop() {
+  // Sleep until something registered last pass is due
+  schedWait();
+  uint32_t passStart = micros();
+  bootMark(BOOT_LOOP);
   server.handleClient();
+  webSocket.loop();
+  pollRealtime();
 
-  // Run LED animation
-  tickEffect();
-
-  // Auto-off LEDs
-  if (ledAutoOff > 0 && millis() > ledAutoOff) {
-    currentEffect = EFFECT_SOLID;
-    setAllLeds(0, 0, 0);
-    ledAutoOff = 0;
-  }
-
-  // Button press detection (debounce + multi-tap)
-  bool state = digitalRead(btnPin);
-  if (state != lastBtnState && millis() - lastDebounce > DEBOUNCE_MS) {
-    lastDebounce = millis();
-    lastBtnState = state;
-    if (state == LOW) { // Pressed (active low with pullup)
-      unsigned long now = millis();
-      if (uiState == UI_IDLE) {
-        if (tapCount > 0 && now - lastTapTime < TAP_WINDOW) {
-          // Second tap within window → double-tap → focus setup
-          tapCount = 0;
-          lastTapTime = 0;
-          enterFocusSetup();
-        } else {
-          tapCount = 1;
-          lastTapTime = now;
-        }
-      } else if (uiState == UI_FOCUS_SETUP) {
-        tapCount++;
-        lastTapTime = now;
-        onFocusTapRegistered(tapCount);
-      } else if (uiState == UI_FOCUS_ACTIVE) {
-        // Double-tap to cancel (ignore single taps)
-        if (tapCount > 0 && now - lastTapTime < TAP_WINDOW) {
-          tapCount = 0;
-          lastTapTime = 0;
-          cancelFocusTimer();
-        } else {
-          tapCount = 1;
-          lastTapTime = now;
-        }
-      } else if (uiState == UI_FOCUS_ALARM) {
-        dismissFocusAlarm();
-      }
-    }
-  }
+  // Run LED animation (on ESP32 the render task does this on its own core)
+#if !RENDER_TASK
+  renderTick();
+#endif
+  tickFocus();
 
-  // Process single tap after settle (in IDLE state)
-  if (uiState == UI_IDLE && tapCount > 0 && millis() - lastTapTime > TAP_SETTLE) {
-    handleSinglePress();
-    tapCount = 0;
-  }
+  // WiFi join and boot/join indicator
+  tickSta();
 
-  // Process duration taps after settle (in FOCUS_SETUP state)
-  if (uiState == UI_FOCUS_SETUP && tapCount > 0 && millis() - lastTapTime > TAP_SETTLE) {
-    startFocusTimer(tapCount * 20);
-    tapCount = 0;
-  }
+  // Step a running pin sweep
+  tickPinSweep();
 
-  // Reset stale single tap during focus (so it doesn't linger)
-  if (uiState == UI_FOCUS_ACTIVE && tapCount > 0 && millis() - lastTapTime > TAP_SETTLE) {
-    tapCount = 0;
-  }
+  // Advance a running macro by one step
+  macroStep();
 
-  // Focus setup timeout (no taps within 10 seconds → exit)
-  if (uiState == UI_FOCUS_SETUP && tapCount == 0 && millis() - focusSetupStart > SETUP_TIMEOUT) {
-    uiState = UI_IDLE;
-    currentEffect = EFFECT_SOLID;
-    setAllLeds(0, 0, 0);
-  }
+  // Expire /led status entries and notifications
+  tickStatus();
+  tickNotify();
 
-  // Factory reset: hold button for 10 seconds
-  static unsigned long holdStart = 0;
-  if (digitalRead(btnPin) == LOW) {
-    if (holdStart == 0) holdStart = millis();
-    if (millis() - holdStart > 10000) {
-      setAllLeds(255, 0, 0);
-      prefs.begin("btn", false);
-      prefs.clear();
-      prefs.end();
-      delay(1000);
-      ESP.restart();
-    }
-  } else {
-    holdStart = 0;
-  }
+  // Push pending server-sent events, frames and pings
+  tickEvents();
+
+  // Button edges captured by the interrupt (debounce + multi-tap)
+  pollButton();
+
+  // Tap settle, focus setup timeout and the reset hold, as of now
+  buttonDeadlines(millis());
+  if (tapCount > 0) wakeAt(lastTapTime + TAP_SETTLE + 1);
+  if (uiState == UI_FOCUS_SETUP && tapCount == 0) wakeAt(focusSetupStart + SETUP_TIMEOUT + 1);
+  if (lastBtnState == LOW) wakeAt(btnDownAt + RESET_HOLD + 1);
+
+  // Next animation frame (after everything above has published)
+#if !RENDER_TASK
+  unsigned long frameDue;
+  if (renderNextDue(frameDue)) wakeAt(frameDue);
+#endif
+  observe(loopTime, micros() - passStart);
 }
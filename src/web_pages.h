@@ -0,0 +1,297 @@
+// Generated by tools/embed_web.py from web/*.html. Do not edit.
+#pragma once
+
+// /: 5815 bytes, 2524 gzipped
+#define WEB_INDEX_ETAG "\"4d2fdf7b19fb566e\""
+const uint8_t WEB_INDEX_GZ[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xad,0x58,0xe9,0x72,0xdb,0x38,0x12,0xfe,0xaf,0xa7,
+  0xe8,0x4d,0x6a,0x02,0xa9,0x22,0x51,0x87,0x93,0x6c,0x42,0x49,0x9c,0x92,0x15,0xf9,0xa8,0xf1,0xa1,0x95,
+  0xe5,0x4a,0xa5,0xa6,0xe6,0x07,0x24,0x42,0x12,0x26,0xbc,0x06,0x00,0xad,0x68,0x3c,0xae,0xda,0x87,0xd8,
+  0x27,0xdc,0x27,0xd9,0x6e,0x80,0xb4,0x29,0x3b,0x9e,0x4d,0xed,0x8e,0x7f,0xc8,0x24,0xd1,0x17,0xfa,0xf8,
+  0xba,0x81,0xc1,0xdf,0x3e,0x5e,0x8e,0xe7,0x9f,0xa7,0x13,0xd8,0x98,0x38,0x0a,0x06,0xc5,0xaf,0xe0,0x61,
+  0x50,0x1b,0xc4,0xc2,0x70,0x48,0x78,0x2c,0x86,0xec,0x46,0x8a,0x6d,0x96,0x2a,0xc3,0x60,0x99,0x26,0x46,
+  0x24,0x66,0xc8,0xb6,0x32,0x34,0x9b,0x61,0x28,0x6e,0xe4,0x52,0xb4,0xec,0x4b,0x53,0x26,0xd2,0x48,0x1e,
+  0xb5,0xf4,0x92,0x47,0x62,0xd8,0x65,0x28,0x43,0x9b,0x5d,0x24,0x82,0xda,0x22,0x0d,0x77,0xb7,0x2b,0x64,
+  0x6d,0xad,0x78,0x2c,0xa3,0x9d,0xaf,0x77,0xda,0x88,0xb8,0x95,0xcb,0x7e,0xcc,0xd5,0x5a,0x26,0x7e,0xaf,
+  0x93,0x7d,0xed,0x1b,0xf1,0xd5,0xb4,0x78,0x24,0xd7,0x89,0xbf,0x44,0x25,0x42,0xf5,0x17,0x7c,0xf9,0x65,
+  0xad,0xd2,0x3c,0x09,0xfd,0x97,0xdd,0x6e,0xb7,0xbf,0x4c,0xa3,0x54,0xf9,0x2f,0x85,0x10,0x77,0x35,0x6f,
+  0x79,0x1b,0xf3,0xaf,0x4e,0xb7,0xff,0xf7,0x0e,0x09,0x28,0x84,0x75,0x80,0xe7,0x26,0xbd,0xab,0x6d,0xba,
+  0xb7,0x05,0xc3,0xc1,0x9b,0xf0,0xe0,0xc3,0x87,0xbb,0x9a,0x16,0x91,0x58,0x9a,0xe6,0x22,0x37,0x26,0x4d,
+  0x9a,0xa4,0x8f,0x2b,0xc1,0xd1,0xf2,0x2c,0x37,0xb7,0x19,0x0f,0x43,0x99,0xac,0xfd,0x6e,0x45,0xd4,0x5b,
+  0x7c,0xb4,0x86,0x6b,0xf9,0xbb,0xf0,0xbb,0xf4,0xba,0x48,0x55,0x28,0x54,0x4b,0xf1,0x50,0xe6,0xda,0x7f,
+  0x77,0xff,0xc5,0xef,0x66,0x5f,0x41,0xa7,0x91,0x0c,0xe1,0xe5,0xc1,0xc1,0xc1,0x9e,0xed,0xbd,0x5e,0x6f,
+  0xcf,0x76,0x67,0xc0,0x6d,0x95,0xc4,0x99,0x58,0x52,0xd9,0xcd,0xe6,0x4a,0xe3,0x73,0x96,0x4a,0xe7,0x0b,
+  0xa7,0x25,0x49,0x13,0xe1,0x4c,0xda,0x0a,0xb9,0xde,0x18,0x7f,0x91,0x46,0x61,0x29,0xd1,0xdf,0xa4,0x37,
+  0x42,0xed,0xc9,0xed,0x76,0x16,0x1f,0xde,0x77,0xd1,0x5d,0x61,0xba,0xd4,0xb7,0x15,0x17,0x47,0x62,0x65,
+  0xf6,0x1d,0xcc,0xbb,0xbc,0x27,0xfa,0xf7,0x6e,0x78,0xba,0xd9,0xf7,0x0f,0x8e,0x21,0x27,0x41,0xa7,0x10,
+  0x8b,0x69,0x11,0x8a,0xfd,0xdd,0xa0,0x03,0x4a,0x41,0x3d,0xa4,0x7c,0x2a,0xeb,0xa0,0xf4,0x6c,0x91,0x12,
+  0x71,0x9a,0xa4,0x3a,0xe3,0x4b,0xf4,0x4e,0x19,0x97,0x5b,0x17,0xdb,0x0f,0x9d,0x1f,0x9e,0xa3,0xf4,0xb4,
+  0xe1,0x26,0xd7,0xfb,0x1b,0xc6,0x4d,0x74,0x79,0x7f,0x2f,0x9a,0xff,0x65,0x1b,0xd5,0x10,0xa3,0x5d,0x77,
+  0x35,0xfe,0x38,0x71,0xbc,0xb5,0x92,0xe1,0x6d,0x28,0x75,0x16,0xf1,0x9d,0xbf,0x8a,0xc4,0xd7,0xfe,0x9a,
+  0x67,0x4e,0xf8,0xaf,0xb9,0x36,0x72,0xb5,0x6b,0x15,0xb5,0x51,0xe6,0x2e,0x11,0xb5,0xb6,0x0a,0xa9,0xe8,
+  0xe7,0x89,0xdf,0x48,0x20,0x14,0x79,0x40,0xa4,0x7e,0xb7,0x1f,0xcb,0xa4,0x48,0xe7,0xf7,0x1d,0xb2,0xc2,
+  0x4b,0xbf,0xec,0xdb,0xf1,0x24,0xee,0xfd,0xd2,0x22,0xca,0x8a,0xbb,0xda,0xa0,0x5d,0x14,0xdc,0x40,0x2f,
+  0x95,0xcc,0x4c,0x50,0x5b,0xe5,0xc9,0xd2,0xc8,0x34,0x01,0xbd,0x49,0xb7,0xe7,0x7c,0xa9,0xd2,0x7a,0xe3,
+  0xb6,0x06,0x70,0xc3,0x15,0xdc,0x0c,0x31,0x76,0x79,0x8c,0xd6,0x7a,0x6b,0x61,0x26,0x91,0xa0,0xc7,0xc3,
+  0xdd,0x69,0x58,0x67,0x31,0x6b,0x78,0x37,0x3c,0xca,0x45,0x1f,0x69,0x9f,0xa7,0x5a,0x21,0x99,0xd5,0xe8,
+  0x15,0x76,0x0c,0x6f,0x86,0x43,0xd6,0x65,0x3f,0xb2,0x45,0x94,0x2e,0xbf,0x30,0x9f,0x91,0x5d,0xac,0x5f,
+  0xbb,0x7b,0x30,0xc4,0x08,0x6d,0xce,0x44,0x58,0xb7,0x1b,0x6b,0xdc,0xae,0x84,0x59,0x6e,0xea,0xac,0x1d,
+  0x89,0x90,0x35,0x6f,0x11,0x73,0x36,0x69,0xe8,0xb3,0xe9,0xe5,0xd5,0x9c,0x35,0x09,0x88,0x84,0xd2,0xfe,
+  0x2d,0x1b,0x3b,0xd7,0xb6,0xe6,0xbb,0x4c,0xa0,0x54,0x9e,0x65,0x91,0x5c,0x72,0x92,0xd7,0x46,0x1f,0x6f,
+  0xb7,0xad,0x55,0xaa,0x10,0x4e,0x54,0x24,0x12,0x4a,0xc5,0x90,0xdd,0x35,0x09,0x73,0x7c,0x66,0xb5,0x0c,
+  0xd9,0x6b,0xfb,0xff,0xae,0xd1,0x7f,0x64,0xc8,0xa1,0x49,0x9c,0x3f,0x4a,0x33,0x16,0x26,0x69,0xd3,0x02,
+  0x6e,0xcc,0x6c,0x44,0x52,0x57,0xc3,0x40,0x79,0xbf,0xea,0x14,0xc9,0x8a,0x2f,0xe1,0x30,0x20,0x06,0xe7,
+  0x42,0x11,0x3d,0xef,0x43,0x14,0x35,0x13,0x3a,0x8f,0x50,0x56,0xdf,0x32,0xc8,0x55,0x3d,0xf4,0x32,0x25,
+  0xb4,0x16,0xa1,0x87,0x96,0xae,0xcd,0x26,0xe8,0x34,0x50,0x86,0x27,0x93,0x44,0xa8,0x93,0xf9,0xf9,0xd9,
+  0x90,0x0d,0x30,0xb3,0x31,0x5a,0xe4,0xd4,0xe1,0x8b,0xbd,0xe0,0xbf,0x08,0xa6,0x8e,0x17,0xd0,0xf8,0xe3,
+  0xe9,0xe9,0xa5,0x0f,0xec,0xf5,0x83,0xc0,0x5f,0x11,0x26,0xea,0xac,0x09,0xac,0xf1,0x9a,0x61,0x1e,0xa0,
+  0x94,0x80,0x39,0xbd,0x22,0xd2,0xe2,0x3b,0xb4,0x88,0xd5,0x1b,0xfc,0x7b,0x11,0x5c,0xa4,0x60,0x65,0x42,
+  0x28,0x0c,0x82,0x25,0x8a,0x86,0xb9,0xda,0xc1,0x06,0xd3,0x0d,0xeb,0x09,0xd0,0x09,0x45,0xda,0xc2,0x76,
+  0x23,0x23,0x01,0x4b,0x0c,0xc5,0x17,0x5a,0x99,0xa3,0xdf,0xbc,0xaa,0x6a,0xf4,0x77,0xcd,0x26,0x65,0x91,
+  0x8c,0x83,0xb6,0x6d,0x2d,0x03,0x0a,0x4d,0x30,0x08,0xe5,0x0d,0xf2,0x72,0xad,0x87,0x6c,0x49,0xbd,0x62,
+  0xd3,0x0d,0xc6,0x24,0xea,0x58,0x1a,0x38,0xb4,0x0a,0x90,0xbe,0x8b,0x0b,0x15,0x42,0x57,0xee,0x48,0x0d,
+  0x70,0x24,0x55,0xbc,0x45,0x94,0x00,0xb7,0x97,0x90,0x1b,0xde,0x42,0x8a,0xd5,0x96,0x05,0x85,0x0d,0xf0,
+  0x07,0x9c,0x4d,0x3e,0x42,0x86,0x55,0xf7,0x88,0x08,0x93,0x6d,0x2a,0x93,0x2a,0x21,0x26,0xc2,0xb7,0x08,
+  0x31,0x86,0x55,0xc2,0xc1,0x42,0x91,0xea,0xd1,0xd4,0x77,0xbb,0x5e,0xa3,0xa9,0xf5,0xee,0x87,0x9e,0xd7,
+  0x7d,0xf7,0xde,0x7b,0xe3,0x75,0x1b,0x05,0xbb,0x0c,0xad,0xa9,0x8f,0xf9,0x06,0x1c,0x36,0x4a,0xac,0x86,
+  0xac,0xbd,0x95,0x2b,0xc9,0x82,0x4f,0xf2,0x48,0xc2,0x95,0x30,0x06,0xbd,0xa7,0x07,0x6d,0x4e,0x86,0x3c,
+  0xd0,0xa0,0x39,0xb8,0x53,0x54,0x0f,0x98,0xfd,0x2b,0xb9,0x7e,0x42,0x90,0x67,0x68,0xa6,0x60,0xc1,0xbd,
+  0x27,0xae,0xed,0x07,0xa2,0x43,0x57,0xa3,0xd7,0x82,0x1a,0x7a,0xf5,0x20,0xf8,0x47,0x8e,0xa6,0x5a,0x57,
+  0x50,0x84,0xd0,0xa9,0x07,0xfb,0x4e,0x25,0x24,0xb2,0x2e,0x1d,0x14,0x71,0x4d,0x13,0xbb,0xbb,0xe1,0x8b,
+  0xb2,0x56,0x99,0xc2,0x92,0x6a,0xbc,0x08,0x66,0x22,0x1c,0xb4,0x1d,0xd1,0x9f,0xd3,0xaf,0x95,0x10,0x09,
+  0x71,0x1c,0xd3,0xc3,0xf7,0xf1,0x2c,0x10,0x6e,0x88,0xe5,0x10,0xff,0x7f,0x1f,0x47,0x96,0xab,0x2c,0xb2,
+  0x3c,0x53,0xfb,0xf4,0x7d,0x5c,0x58,0xa2,0x8a,0x47,0x76,0x3f,0x13,0xf7,0xf8,0x7d,0x7c,0xe9,0x6a,0x45,
+  0x3c,0x97,0xab,0xd5,0x03,0x7d,0xd5,0xcd,0x57,0x18,0x45,0x2c,0x07,0x5b,0xa4,0x30,0xb2,0x18,0x53,0xf8,
+  0x9a,0xc0,0x09,0xb8,0xfd,0x82,0x61,0xd3,0xc2,0xc4,0x88,0x51,0x0c,0x1c,0xd8,0x0d,0x59,0x96,0x22,0xde,
+  0x10,0x66,0xdb,0xe1,0xc4,0x26,0x4f,0xcc,0x8a,0xc9,0xcb,0x51,0x96,0xe9,0xe8,0xde,0xd0,0xb4,0x0d,0x4f,
+  0xd6,0xb8,0x5a,0x01,0x75,0x17,0xc0,0x34,0xb3,0xd0,0x66,0xa1,0x7b,0xc8,0x3a,0x98,0x3e,0x5c,0x99,0x1d,
+  0x9c,0x23,0xdf,0xa0,0xed,0x16,0xbf,0x41,0x87,0xa3,0xda,0x18,0x7b,0x58,0x1a,0x83,0x15,0xf6,0x40,0x89,
+  0xe9,0x6b,0x6d,0xc2,0xa7,0xc2,0x2d,0x06,0x01,0x18,0xf5,0xe6,0x8b,0x58,0xa2,0xcd,0x57,0xfc,0xa6,0xe2,
+  0xf4,0xbd,0xa4,0xa2,0xb1,0x80,0x15,0x08,0xc3,0x5c,0xef,0x6b,0x99,0xd4,0x75,0x4c,0x5b,0xed,0x07,0xe5,
+  0xe2,0x7e,0x87,0xab,0x90,0xa2,0xf9,0x47,0x08,0xae,0x1a,0xe6,0x12,0xe3,0x04,0xf5,0x30,0xcd,0x17,0x91,
+  0x68,0x19,0x9e,0x01,0x4f,0x76,0x06,0x3f,0x36,0x0a,0x07,0x67,0xc1,0xc7,0x87,0xb5,0x0a,0x40,0x99,0x14,
+  0x6c,0x2f,0x86,0x95,0x95,0x43,0xee,0xf3,0xa8,0x10,0x34,0x64,0x39,0x81,0x22,0xa5,0x5c,0x81,0x62,0x5b,
+  0x2e,0xa9,0x0c,0x11,0xeb,0x10,0xe4,0x81,0xe4,0x60,0xd4,0x20,0xcc,0x95,0xed,0x32,0xfe,0xa0,0x9d,0x59,
+  0x3d,0x38,0xd1,0xaa,0x34,0x59,0x07,0x5d,0x22,0xa1,0x76,0x6b,0xdf,0x60,0x08,0xbd,0x0e,0x60,0xfb,0x86,
+  0x57,0xc9,0x42,0x67,0x7d,0x28,0xc9,0x7a,0x44,0xa6,0xab,0x74,0x6f,0xbe,0x49,0x77,0xf0,0x84,0xee,0x9d,
+  0xa5,0x2b,0xd5,0x56,0x6c,0x2e,0xd2,0x17,0x5d,0x10,0xe2,0xd8,0x95,0x27,0x06,0xfb,0xf3,0x36,0xf1,0xe0,
+  0x93,0xb5,0x1b,0x9d,0xc2,0x34,0xe4,0x59,0x13,0x14,0x97,0xc9,0x22,0xdd,0x42,0x66,0x33,0x60,0x85,0x51,
+  0xd9,0x00,0x52,0xcb,0x08,0x76,0x69,0x6e,0x37,0x88,0xde,0xc1,0xb6,0x1d,0x4b,0xad,0x71,0xd7,0xf8,0x8e,
+  0x79,0x25,0x68,0xc7,0x84,0xe5,0x1c,0x34,0xa6,0xb1,0x74,0x3e,0x5c,0x72,0x5c,0x89,0x3c,0x67,0x4c,0x25,
+  0xe3,0x1d,0x4a,0x03,0x41,0x54,0x05,0x59,0xb2,0x32,0xb0,0xfb,0x43,0x15,0x0b,0x4e,0x57,0xd5,0xd8,0x84,
+  0xa9,0xd0,0x09,0x33,0x80,0xe5,0x92,0xa5,0x49,0xd8,0xb4,0x6b,0xd4,0xd6,0x08,0x87,0x71,0xef,0x38,0xe2,
+  0xc0,0x02,0xe3,0x42,0x0e,0xf1,0xe0,0x04,0xbb,0x4f,0x95,0xdb,0xee,0x9e,0x0a,0xd4,0x6a,0x2e,0xc2,0xb3,
+  0x97,0xa3,0xee,0x85,0xdd,0x17,0x32,0xbb,0xef,0xf7,0x2c,0x20,0x1e,0x78,0xb0,0xbe,0x52,0xcf,0x94,0xc1,
+  0x54,0x80,0x0f,0xcd,0x7b,0x3f,0x87,0x69,0x76,0x7c,0x32,0x2f,0x12,0xce,0x17,0x5e,0x29,0xf9,0x71,0x34,
+  0x2a,0x19,0xab,0x23,0x9a,0xcb,0xfc,0xc0,0x96,0x19,0x4c,0x42,0x69,0x52,0x55,0x78,0xad,0x9c,0x79,0xcb,
+  0xba,0x27,0x0a,0x06,0x2a,0xdd,0x62,0x2d,0x75,0x7b,0x15,0x08,0xb0,0x0b,0xa8,0xb0,0x64,0x08,0x9e,0x96,
+  0x9d,0x4d,0x99,0x71,0x1a,0xc7,0xe8,0x25,0x8d,0x2d,0x8d,0x46,0xa2,0xc0,0x1e,0xf3,0x88,0x69,0xd0,0xb6,
+  0xef,0xcd,0xe2,0xfb,0x74,0x76,0x7a,0x31,0xaf,0x2e,0x40,0x7d,0x2b,0xcd,0x06,0x26,0x54,0x38,0x8d,0x66,
+  0xcd,0x51,0xfd,0x34,0xf9,0x0c,0xb3,0xc9,0xfc,0x7a,0x76,0xf1,0x88,0x7d,0x7c,0x79,0x7e,0x78,0x09,0xc7,
+  0xd7,0xa7,0xaf,0xaf,0xa6,0xa3,0xf1,0xa4,0x5c,0x2d,0xd8,0xa8,0xe9,0x1c,0xcf,0x26,0x93,0xc7,0x5c,0xf4,
+  0x7d,0x76,0x7c,0xd8,0x54,0xcd,0x75,0x73,0xf1,0x88,0xe7,0xe3,0xe4,0x6c,0xf4,0x19,0x62,0xfd,0x88,0xe5,
+  0x6a,0x7a,0x7a,0xf1,0xf4,0x6b,0xbb,0x8d,0x45,0x10,0xd3,0xd0,0x55,0x2c,0x94,0x15,0x33,0x26,0x54,0xc1,
+  0xcd,0xcf,0x4a,0x0b,0xe0,0xf0,0xec,0x7a,0x02,0x9f,0x27,0x67,0x67,0x97,0x9f,0xe0,0x7c,0x74,0x3c,0xb9,
+  0x98,0x8f,0x60,0xfc,0x79,0x74,0x01,0x9f,0x4e,0x4e,0xe7,0x13,0xb8,0x9c,0x8d,0x2e,0x8e,0x27,0x30,0xbd,
+  0x9e,0x4d,0xcf,0x26,0x30,0x39,0x9f,0xcc,0x46,0x67,0x1f,0xe1,0xf2,0xe8,0xa8,0x94,0xf8,0x93,0xd8,0xa1,
+  0xbc,0xeb,0x29,0x7c,0xbc,0xfc,0x74,0x81,0x28,0x72,0x34,0x87,0xd9,0xe9,0xf1,0xc9,0x1c,0x4e,0x2e,0xcf,
+  0x91,0xe1,0x02,0xdb,0xeb,0xe8,0xb0,0x70,0x12,0x4c,0xae,0xc6,0x80,0x1b,0x99,0xa0,0xe0,0xc3,0xd1,0xf8,
+  0x27,0xeb,0x1b,0x70,0xbf,0x47,0xdd,0xd6,0x51,0xb7,0x57,0x4a,0x45,0x68,0xc6,0x59,0x00,0xa7,0x5c,0xa0,
+  0x46,0x4f,0xce,0xf4,0x61,0x3c,0x9f,0x9d,0xc1,0xe8,0x6c,0x0e,0x57,0x27,0xa7,0xa8,0x05,0x9d,0x5b,0x2d,
+  0xbd,0xfb,0x7f,0xd4,0x56,0xca,0xde,0x23,0xf0,0xb0,0x28,0xcd,0xee,0x69,0x73,0xdf,0xc3,0xe1,0xc7,0x69,
+  0x4b,0x06,0x5c,0xd9,0x91,0xca,0x2f,0xa1,0xc8,0x66,0x6f,0xe6,0x86,0x28,0x07,0x46,0x4e,0xf7,0x7e,0x0f,
+  0xcb,0x50,0xf6,0x16,0xcf,0x54,0x8f,0x9a,0xd8,0xb7,0x6a,0xc5,0x35,0x26,0x7b,0xc2,0x2e,0x72,0x1b,0x4d,
+  0x55,0x18,0x30,0x56,0x14,0xea,0x83,0x2c,0x2c,0x93,0xa5,0xa0,0x39,0x53,0xe0,0xc8,0x3e,0x76,0x54,0xf0,
+  0xb0,0x5c,0x08,0x77,0x27,0xa4,0x77,0x9d,0x1f,0xd8,0xfd,0x5c,0x55,0x95,0xfe,0x40,0xff,0xa7,0xe2,0x2f,
+  0xc4,0xf6,0x5e,0x34,0xd4,0x17,0x11,0x4f,0xbe,0x10,0xd4,0x29,0x11,0xe3,0x09,0xba,0xf1,0x2d,0x65,0x95,
+  0xe1,0xe0,0xcf,0xba,0x60,0x19,0x17,0x74,0xed,0xb5,0x16,0x8a,0x8c,0x02,0xa9,0x8b,0x74,0xe5,0xa1,0x05,
+  0x75,0xfb,0xec,0xc1,0x67,0x04,0xe2,0x18,0x1b,0x6f,0xd1,0xa4,0x08,0xde,0x96,0x8f,0x76,0x6d,0xe1,0xd7,
+  0x76,0x7b,0x90,0x06,0x7b,0x97,0x40,0x5d,0x90,0x54,0x6d,0xbf,0x37,0x1d,0x71,0x86,0x63,0x0f,0xa4,0xbb,
+  0x8f,0x8d,0x07,0x08,0xb6,0x38,0x68,0x38,0x54,0xa5,0x6a,0x1b,0x4d,0x4f,0x81,0x47,0x9a,0x76,0xf8,0x5b,
+  0x2e,0x11,0x74,0x2d,0x1d,0xfc,0xfb,0x9f,0xff,0x02,0x37,0x47,0x52,0x5b,0x50,0xa4,0x3f,0xb2,0x15,0x45,
+  0xd0,0x01,0x16,0x08,0x9c,0xe5,0xad,0x1c,0xac,0xf1,0x7e,0xa9,0xb8,0xdc,0xc5,0x93,0xae,0x50,0x6a,0xab,
+  0x53,0x03,0x1d,0x47,0x3c,0x0f,0x05,0x4e,0xb0,0xf8,0xb3,0x49,0xd3,0x2f,0xba,0xf1,0x3f,0xa4,0x28,0x9d,
+  0xfe,0x54,0x1a,0xb9,0xce,0x4d,0x11,0x32,0x22,0xda,0xc1,0x8d,0xe4,0x70,0x32,0x9f,0x4f,0x0b,0xf0,0xb7,
+  0xd6,0x58,0xf3,0x37,0xc6,0x64,0x7e,0xbb,0xbd,0x3f,0xc9,0x6f,0xec,0x90,0x55,0xcc,0xe3,0x74,0xda,0x84,
+  0x56,0x08,0xee,0xe8,0x33,0xb4,0xd3,0xea,0x8b,0x12,0x40,0x28,0xa7,0xfe,0x1f,0x69,0x34,0x54,0xbc,0xa2,
+  0x46,0x9c,0xe6,0x66,0xf8,0xb6,0xd3,0xe9,0xfc,0x05,0x92,0xd5,0xb0,0xf7,0xf6,0xed,0xab,0xf5,0xb0,0xf3,
+  0x6a,0x31,0xec,0xf6,0xde,0xff,0x65,0xb6,0xe2,0x4c,0xbb,0x2f,0x2b,0x7b,0x76,0x64,0x2b,0x01,0x15,0x8f,
+  0x02,0x60,0x1d,0xe6,0xa6,0xa7,0x9d,0x88,0x22,0x9c,0x32,0x96,0x3b,0xd4,0x18,0xf3,0x35,0xe6,0x2e,0x07,
+  0x37,0x97,0x43,0xaa,0x6c,0xde,0x96,0x03,0x0b,0xea,0x6a,0xba,0x24,0x43,0xf8,0x88,0xf0,0xd4,0x23,0x6c,
+  0xc5,0xea,0x26,0xbc,0xdc,0x88,0xaf,0x4d,0x24,0x07,0xd5,0x5e,0xb7,0x17,0x34,0xb1,0xf0,0x58,0x7b,0xd6,
+  0xa0,0x4b,0x3b,0x89,0xf2,0xa8,0xc8,0xc2,0xc2,0xad,0x65,0xa7,0xa2,0x41,0x41,0x53,0xee,0xd3,0x7d,0x5f,
+  0xcb,0xe4,0x2a,0x69,0xa1,0x16,0xef,0x5b,0x68,0x79,0x7f,0x21,0x52,0x1c,0xf4,0xe9,0x24,0x29,0x9e,0x3f,
+  0xe5,0x6b,0x77,0xca,0xbf,0x3f,0xdc,0xff,0x96,0x0b,0xb5,0xbb,0xb2,0xc3,0x70,0xaa,0x46,0x51,0x54,0x67,
+  0x3f,0x3b,0xff,0xfe,0x82,0x32,0x30,0xd1,0x27,0x1c,0xa5,0x0a,0x64,0xc2,0x43,0x3e,0xb3,0x63,0x35,0x23,
+  0xeb,0x44,0x43,0xb8,0x7b,0x94,0xa1,0xfe,0x59,0x78,0xc4,0x81,0x45,0xe9,0xe9,0x5f,0xfa,0xee,0x4c,0xee,
+  0x51,0xdb,0x2d,0xee,0x36,0x1e,0x53,0xdc,0xd9,0x5b,0x03,0x14,0xa7,0xe9,0x92,0xab,0xf1,0xec,0x35,0x03,
+  0x9d,0x33,0x1b,0x7b,0x82,0xd8,0x1f,0x40,0x27,0x4b,0xba,0x1e,0x40,0x5e,0x2d,0xc3,0xd7,0x0c,0xea,0xf4,
+  0x2c,0xb3,0xd7,0xac,0x61,0x4f,0xe6,0x74,0x77,0x91,0x6d,0x9f,0xbf,0xbb,0xc0,0x06,0x60,0xd5,0x67,0xdb,
+  0x7d,0x13,0xbd,0xb2,0xfa,0x7f,0x64,0x53,0x95,0xba,0xeb,0x01,0xe6,0x33,0xba,0x32,0x28,0xf1,0x08,0xcd,
+  0x67,0x05,0xab,0xbb,0x1a,0x72,0x99,0x56,0x65,0x2d,0x66,0x7d,0x64,0x2c,0x2e,0x1d,0x2c,0x43,0xe5,0x30,
+  0xd3,0xaf,0xd1,0xee,0xab,0x17,0x07,0xee,0xca,0xa0,0x6d,0x2f,0xa8,0x6b,0xff,0x01,0xe1,0x88,0xa4,0x48,
+  0xb7,0x16,0x00,0x00,
+};
+
+// /wifi: 1387 bytes, 785 gzipped
+#define WEB_WIFI_ETAG "\"9e0047fa2570e9b0\""
+const uint8_t WEB_WIFI_GZ[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x5d,0x54,0x4b,0x6f,0xdb,0x38,0x10,0xbe,0xeb,0x57,
+  0x70,0x11,0xb4,0xb4,0x91,0x5a,0xb6,0xec,0xed,0xa2,0xd5,0xab,0x68,0xd3,0x14,0xe8,0x25,0x2d,0x90,0x05,
+  0x16,0x8b,0x20,0x07,0x9a,0x1c,0x59,0x6c,0x29,0x52,0x4b,0x52,0x7e,0xd4,0xf0,0x7f,0xef,0x50,0x52,0xb2,
+  0x76,0x2e,0x12,0x49,0xcd,0x7c,0x8f,0x99,0x11,0xf3,0x3f,0x3e,0x7f,0xbb,0xf9,0xfb,0xdf,0xef,0xb7,0xa4,
+  0xf6,0x8d,0x2a,0xf3,0xf1,0x09,0x4c,0x94,0x51,0xde,0x80,0x67,0x44,0xb3,0x06,0x0a,0xba,0x95,0xb0,0x6b,
+  0x8d,0xf5,0x94,0x70,0xa3,0x3d,0x68,0x5f,0xd0,0x9d,0x14,0xbe,0x2e,0x04,0x6c,0x25,0x87,0x59,0xbf,0x79,
+  0x23,0xb5,0xf4,0x92,0xa9,0x99,0xe3,0x4c,0x41,0x91,0x50,0xc4,0x70,0xfe,0xa0,0xa0,0x8c,0xd6,0x46,0x1c,
+  0x8e,0x15,0xa6,0xce,0x2a,0xd6,0x48,0x75,0x48,0xdd,0xc1,0x79,0x68,0x66,0x9d,0xcc,0x1a,0x66,0x37,0x52,
+  0xa7,0xcb,0x45,0xbb,0xcf,0x3c,0xec,0xfd,0x8c,0x29,0xb9,0xd1,0x29,0x47,0x12,0xb0,0xd9,0x9a,0xf1,0x9f,
+  0x1b,0x6b,0x3a,0x2d,0xd2,0xab,0x24,0x49,0x32,0x6e,0x94,0xb1,0xe9,0x15,0x00,0x9c,0xa2,0x98,0x1f,0x1b,
+  0xb6,0x1f,0xb8,0xd3,0xb7,0x8b,0x00,0x30,0x82,0x2d,0x08,0xeb,0xbc,0x39,0x45,0x75,0x72,0x1c,0x13,0x56,
+  0x7f,0x8a,0xd5,0xfb,0xf7,0xa7,0x48,0xea,0xb6,0xf3,0x6f,0xd6,0x9d,0xf7,0x46,0x1f,0x5b,0x26,0x84,0xd4,
+  0x9b,0x34,0x39,0x4b,0x7d,0x8b,0xcb,0x5e,0xa8,0x93,0xbf,0x20,0x4d,0xc2,0x76,0x6d,0xac,0x00,0x3b,0xb3,
+  0x4c,0xc8,0xce,0xa5,0x7f,0x3d,0x9f,0xa4,0x49,0xbb,0x27,0xce,0x28,0x29,0xc8,0xd5,0x6a,0xb5,0xba,0xd0,
+  0xba,0x5c,0x2e,0xcf,0xb4,0x66,0x83,0xc6,0x77,0x8b,0x57,0xa7,0x68,0xe4,0x3e,0x0f,0x1e,0xc4,0x3d,0xc5,
+  0xf7,0x36,0x3b,0xeb,0x70,0xdd,0x1a,0x39,0x54,0x61,0xe0,0xd3,0x46,0xc3,0x20,0x6e,0x07,0x72,0x53,0xfb,
+  0x74,0x6d,0x94,0x18,0xb1,0x07,0xc3,0xb1,0xd4,0x95,0xb9,0xc0,0x4e,0xd8,0x12,0x12,0x96,0x5d,0x58,0xbd,
+  0x34,0xf4,0xee,0x7f,0xf3,0xe1,0x2b,0x59,0x9c,0xfb,0x5f,0xb5,0xfb,0x53,0xc4,0x5e,0x56,0x31,0x9f,0x0f,
+  0x7d,0xcd,0xe7,0xfd,0xa8,0xe4,0xa1,0xbd,0x65,0x2e,0xe4,0x96,0x70,0xc5,0x9c,0x2b,0x28,0x0f,0xbd,0xaf,
+  0x93,0xf2,0x1f,0xf9,0x45,0x92,0x7b,0xf0,0x1e,0xb9,0x1d,0x46,0x27,0x78,0x7c,0x16,0x16,0xd4,0x62,0x24,
+  0x21,0x37,0x9d,0xb5,0xd8,0xf0,0x94,0xe4,0xae,0x65,0x9a,0x48,0x51,0x50,0xe7,0x29,0xe2,0x87,0x2d,0xe2,
+  0xdb,0x3e,0xc8,0x68,0x0d,0xdc,0x13,0x6f,0xc8,0xc1,0x74,0x96,0xd4,0xa6,0x01,0xd2,0x33,0x38,0x43,0x6e,
+  0x14,0xeb,0x04,0x60,0x0c,0x3e,0x38,0x42,0x58,0x60,0xbc,0x26,0xbe,0x06,0x32,0x14,0x3c,0x46,0xd1,0xc8,
+  0x8c,0xfc,0x95,0xb1,0x0d,0x61,0xdc,0x4b,0xa3,0x0b,0x3a,0xdf,0xc9,0x4a,0x52,0x82,0xa3,0x5e,0x1b,0x24,
+  0x6d,0x4d,0xa0,0x45,0xae,0xbc,0x1f,0x94,0x71,0xfa,0x9d,0x93,0x82,0x92,0x56,0x31,0x0e,0x35,0x56,0x1c,
+  0x6c,0x41,0x7b,0xda,0x3b,0xf0,0x3b,0x63,0x7f,0x92,0x3b,0x8c,0xa2,0x44,0x30,0xcf,0x66,0x6e,0x8c,0x7e,
+  0xd2,0x7c,0x81,0xd3,0xa2,0x69,0x4a,0xfc,0xa1,0x1d,0xd7,0x98,0xfc,0x12,0xf7,0xfb,0xf3,0xf1,0x13,0x5c,
+  0x9f,0xf4,0x0c,0x37,0x98,0x19,0x31,0x5c,0xb7,0x6e,0x24,0xea,0xbd,0x67,0x5b,0x20,0xaf,0x9f,0xea,0x93,
+  0xcf,0x87,0x20,0xb4,0x3a,0x0f,0x5e,0xf1,0x8d,0xc9,0x39,0x23,0xb5,0x85,0x0a,0x1d,0xd3,0xf2,0x13,0xce,
+  0x47,0x3e,0x67,0xe5,0x58,0x92,0xdc,0x71,0x2b,0x5b,0x5f,0x46,0x15,0x78,0x5e,0x4f,0x28,0x36,0x97,0x79,
+  0xa0,0xd3,0x18,0xab,0xa7,0x27,0xb6,0x28,0x6d,0xfc,0xc3,0x19,0x3d,0x99,0x8e,0x27,0xae,0x28,0x8f,0xa8,
+  0x45,0x18,0xde,0x35,0xd8,0xb4,0xf8,0xbf,0x0e,0xec,0xe1,0x1e,0x14,0x72,0x1b,0xfb,0x51,0xa9,0x09,0x7d,
+  0x18,0xc4,0x3f,0x22,0x06,0x2a,0xb8,0xc5,0x4e,0x4c,0x00,0x93,0x64,0x35,0xa1,0x5b,0xa6,0x3a,0x2c,0x96,
+  0xd4,0x04,0xa6,0x10,0xf7,0xbb,0xc2,0x3d,0x40,0x1c,0x32,0x1c,0xf8,0xd8,0x3d,0x66,0xa0,0x1c,0x10,0x88,
+  0xc3,0x65,0x70,0x33,0xde,0x36,0x2f,0x22,0x4e,0xd3,0xec,0x5c,0xc0,0x06,0xfc,0xad,0x82,0xb0,0xfc,0x74,
+  0xf8,0x2a,0x26,0x61,0x74,0xa6,0x97,0xe9,0x31,0x5a,0xfa,0x40,0xc7,0x02,0x81,0x08,0x23,0x44,0xaf,0xf1,
+  0x14,0x5b,0x75,0x4d,0xc9,0x24,0xac,0x65,0x7b,0x4d,0xa7,0x34,0x1d,0x0e,0x3f,0xd0,0x50,0x53,0x11,0x66,
+  0x87,0x68,0xe3,0xc3,0xad,0x37,0x64,0xa6,0xcf,0x79,0x29,0xbd,0x1b,0x3e,0x54,0x72,0xd3,0x59,0x10,0x34,
+  0x8b,0x82,0x2c,0x1c,0xd9,0xb1,0x9a,0xd8,0x87,0xfe,0xb7,0x98,0xf7,0x97,0x6a,0xf4,0x1b,0x47,0x1f,0xbf,
+  0x01,0x6b,0x05,0x00,0x00,
+};
+
+// /pins: 2482 bytes, 1186 gzipped
+#define WEB_PINS_ETAG "\"d48ad769a8fc9077\""
+const uint8_t WEB_PINS_GZ[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xad,0x56,0x51,0x6f,0xdb,0x36,0x10,0x7e,0xf7,0xaf,
+  0xe0,0x52,0xa0,0xb4,0x11,0x5b,0xb6,0xec,0x64,0x4b,0x65,0x49,0xc5,0x92,0x7a,0x5d,0x80,0x06,0x09,0x66,
+  0xbf,0x0c,0x45,0x1f,0x68,0xe9,0x64,0x71,0x91,0x48,0x8d,0xa4,0xe2,0x78,0x9e,0xff,0xfb,0x8e,0x94,0x9c,
+  0xda,0x69,0xb2,0xa1,0xc0,0x1e,0x6c,0x51,0xd2,0xdd,0x77,0xdf,0x7d,0x77,0x3c,0x2a,0xfc,0xe1,0xc3,0xed,
+  0xd5,0xe2,0xf7,0xbb,0x19,0xc9,0x4d,0x59,0xc4,0x61,0xfb,0x0f,0x2c,0x8d,0x3b,0x61,0x09,0x86,0x11,0xc1,
+  0x4a,0x88,0xe8,0x03,0x87,0x75,0x25,0x95,0xa1,0x24,0x91,0xc2,0x80,0x30,0x11,0x5d,0xf3,0xd4,0xe4,0x51,
+  0x0a,0x0f,0x3c,0x81,0x81,0xbb,0xe9,0x73,0xc1,0x0d,0x67,0xc5,0x40,0x27,0xac,0x80,0xc8,0xa7,0x88,0xa1,
+  0xcd,0xa6,0x80,0xb8,0xb3,0x94,0xe9,0x66,0x9b,0xa1,0xeb,0x20,0x63,0x25,0x2f,0x36,0x81,0xde,0x68,0x03,
+  0xe5,0xa0,0xe6,0xd3,0x92,0xa9,0x15,0x17,0xc1,0x78,0x54,0x3d,0x4e,0x0d,0x3c,0x9a,0x01,0x2b,0xf8,0x4a,
+  0x04,0x09,0x06,0x01,0x35,0x5d,0xb2,0xe4,0x7e,0xa5,0x64,0x2d,0xd2,0xe0,0x8d,0xef,0xfb,0xd3,0x44,0x16,
+  0x52,0x05,0x6f,0x00,0x60,0xd7,0xf1,0x92,0x6d,0xc9,0x1e,0x9b,0xd8,0xc1,0xf9,0xc8,0x02,0xb4,0x60,0x23,
+  0xc2,0x6a,0x23,0x77,0x9d,0xdc,0xdf,0xb6,0x0e,0x93,0xb3,0x74,0xf2,0xee,0xdd,0xae,0xc3,0x45,0x55,0x9b,
+  0xfe,0xb2,0x36,0x46,0x8a,0xbe,0x86,0x02,0x12,0xb3,0xad,0x58,0x9a,0x72,0xb1,0x0a,0xfc,0x03,0x84,0x73,
+  0x5c,0x3a,0xbe,0x9a,0xff,0x05,0x81,0x6f,0x6f,0x97,0x52,0xa5,0xa0,0x06,0x8a,0xa5,0xbc,0xd6,0xc1,0x8f,
+  0x4f,0x4f,0x02,0xbf,0x7a,0x24,0x5a,0x16,0x3c,0x25,0x6f,0x26,0x93,0xc9,0x11,0xe5,0xf1,0x78,0x7c,0x44,
+  0xb9,0x09,0xbc,0x3d,0x34,0x69,0x98,0xed,0xad,0x5c,0x8e,0xb5,0xd2,0xb8,0xae,0x24,0x6f,0x24,0x68,0xa2,
+  0x08,0x29,0xa0,0xa1,0xb4,0x06,0xbe,0xca,0x4d,0xb0,0x94,0x45,0x8a,0x22,0x70,0x91,0xc9,0x23,0x40,0x9f,
+  0xf9,0x6c,0x0c,0xd3,0xa7,0xac,0xbe,0xe5,0x7e,0xf1,0x35,0x4f,0x9b,0x33,0x19,0x1d,0xa6,0x3a,0x39,0xae,
+  0x43,0x01,0x99,0xd9,0x75,0xd8,0x73,0x1d,0x3d,0x79,0x7f,0xfc,0xe8,0x05,0x6a,0xe1,0xb0,0xa9,0x7e,0x38,
+  0x74,0x0d,0x15,0xda,0x26,0x88,0xc3,0x94,0x3f,0x90,0xa4,0x60,0x5a,0x47,0x34,0xb1,0x1d,0x92,0xfb,0xf1,
+  0x1d,0x17,0xe4,0x4a,0x8a,0x8c,0xaf,0x6a,0xc5,0x0c,0x97,0x02,0x3d,0x7c,0x7c,0x75,0x60,0x6a,0xb3,0x44,
+  0x6b,0x42,0xae,0x6a,0xa5,0xb0,0x35,0xc8,0xa7,0xd9,0x07,0x52,0x61,0x02,0x04,0x5b,0x4c,0x49,0xb1,0x22,
+  0x29,0x33,0x6c,0x80,0x96,0x05,0xa4,0x88,0x47,0x63,0x1b,0xdd,0xbe,0x88,0xc9,0xdf,0xe4,0xd2,0xc9,0xfe,
+  0xb2,0xfd,0xd2,0x88,0x63,0xfb,0x70,0xa9,0xdc,0x0f,0x83,0x5d,0x67,0x36,0x8e,0x26,0xa9,0x14,0xd4,0x90,
+  0xb5,0x54,0xf7,0x7d,0x62,0xd4,0x86,0xa4,0x3c,0xcb,0xc0,0xd1,0xf8,0x78,0x77,0x7d,0x4b,0x44,0x5d,0x2e,
+  0x41,0x69,0x0f,0x93,0x28,0x4b,0x8c,0x33,0x9b,0xdf,0x4d,0xc6,0x83,0xf9,0x64,0x4f,0x52,0x07,0xe4,0xec,
+  0xa2,0x4f,0xce,0x7e,0xea,0x93,0x09,0x5e,0x27,0xe7,0x7d,0xe2,0xe3,0xf5,0xc2,0x6b,0xc3,0xb4,0x6e,0xcb,
+  0x27,0x96,0xe8,0x30,0x42,0x9b,0x3e,0x19,0xa3,0x35,0x3a,0xf6,0xc9,0xb9,0x87,0x72,0xa2,0x1e,0x71,0x07,
+  0x15,0x9b,0xc4,0x0b,0xd0,0x8d,0x04,0x48,0x1d,0xc5,0x9a,0xa0,0x58,0x99,0x54,0x25,0x61,0x89,0x95,0x2f,
+  0xa2,0x43,0x0b,0x32,0x34,0x68,0x45,0x09,0x6e,0xe3,0x5c,0xa6,0x11,0xad,0x24,0xde,0xd9,0x70,0xa1,0xdb,
+  0x04,0xed,0xce,0x46,0x43,0x4a,0xcc,0xa6,0xc2,0x65,0x93,0x06,0x3a,0x70,0x44,0x18,0xe1,0x95,0x3d,0x46,
+  0xf4,0xec,0x82,0x3e,0x97,0x96,0xb8,0xb2,0xb6,0x13,0x20,0xb8,0xc0,0x0e,0x6a,0x60,0x5b,0xfe,0x0d,0x98,
+  0xae,0x97,0x25,0xc7,0x78,0xbf,0x60,0xfd,0xf2,0x46,0x45,0xfb,0x2e,0xe7,0xda,0x26,0x18,0x0e,0x1b,0x63,
+  0xe4,0x3d,0xb4,0xc4,0xdb,0xb4,0xe6,0xec,0x01,0xc8,0xd7,0x6e,0x78,0x35,0xb3,0x17,0x92,0xb2,0x62,0xd8,
+  0x62,0x04,0xc7,0xe9,0x21,0xe5,0xff,0x29,0xc3,0xb6,0x56,0x6d,0x2b,0xbd,0x10,0x0a,0x1b,0xe9,0x7b,0x42,
+  0xb5,0x7d,0xf7,0x2f,0xa1,0x5e,0x16,0xd4,0x69,0xf4,0x96,0xfc,0x06,0x4b,0x29,0xcd,0x6b,0x3a,0xae,0x01,
+  0x2a,0xf2,0x73,0x51,0x58,0x31,0x75,0x2b,0x63,0x8b,0x26,0x45,0x52,0xf0,0xe4,0x3e,0x3a,0xd1,0xd6,0xa8,
+  0xdb,0x08,0x6a,0x97,0xb4,0x4f,0x3f,0xce,0x16,0xb4,0x77,0x12,0xcf,0x0d,0x53,0x87,0xd0,0xff,0xe5,0x89,
+  0xa1,0x71,0xf2,0xa0,0xff,0xdd,0xed,0xdc,0x01,0x2c,0x6c,0x99,0x71,0x5e,0x91,0x82,0x7f,0x17,0x4e,0xc2,
+  0x44,0x02,0xc5,0x01,0xd0,0x95,0x7b,0x70,0x00,0x61,0x47,0x02,0xc7,0xba,0xeb,0xb5,0xdd,0xb1,0x6e,0x43,
+  0x84,0x3a,0x51,0xbc,0x32,0x71,0xe7,0x81,0x29,0xa2,0xd7,0x0b,0x5e,0xe2,0xd0,0xec,0x64,0xb5,0x70,0x1d,
+  0x43,0x9a,0x20,0x75,0xbf,0xec,0x6d,0x33,0x30,0x49,0x8e,0xcb,0x6d,0xd3,0x3d,0x41,0xb9,0xeb,0x79,0x26,
+  0x07,0xd1,0x55,0x51,0xac,0xbc,0x3f,0xb4,0x14,0xdd,0x5e,0xfb,0x44,0xe7,0x72,0xed,0x54,0xec,0x4d,0x77,
+  0x07,0x58,0xfb,0xa7,0x5d,0xdd,0xdb,0x62,0x85,0x6c,0x44,0x28,0xa2,0x54,0x26,0x75,0x89,0xd3,0xc0,0x5b,
+  0x81,0x99,0x15,0x60,0x97,0x97,0x9b,0xeb,0xb4,0x6b,0x59,0xf6,0xa6,0x68,0x97,0x14,0xc0,0x94,0x25,0x26,
+  0x6b,0xd3,0x6d,0x29,0xba,0x17,0x3c,0xeb,0x6a,0x4f,0xd5,0x42,0xe0,0xa4,0x76,0x88,0x04,0xf1,0x70,0xa4,
+  0x0b,0x50,0xbf,0x2e,0x6e,0x3e,0x45,0xd4,0xcd,0x17,0x7a,0xaa,0x3d,0xd4,0xe8,0x14,0x6d,0x51,0xd0,0xf7,
+  0x94,0x74,0xf1,0xd2,0xa3,0x01,0xa5,0xbd,0x53,0x4a,0xde,0x96,0x3c,0x4d,0xa5,0x99,0x3a,0x33,0x9c,0x54,
+  0x70,0x4a,0x87,0x76,0x69,0xa4,0x61,0xc5,0xf1,0xfb,0x1b,0x66,0x72,0x2f,0x01,0x5e,0x20,0x12,0x1e,0xee,
+  0x37,0x7a,0xe8,0x8f,0x46,0x23,0x04,0xd1,0xc4,0xce,0x79,0x3a,0x75,0x0c,0x5a,0x82,0x91,0x06,0xb3,0xe7,
+  0xbc,0x57,0xa0,0xdb,0xdb,0x7e,0x53,0x34,0x6d,0x98,0xa9,0xf5,0xbe,0x7b,0xa6,0xbb,0x3e,0x1e,0xc5,0x2e,
+  0xb9,0x1d,0xe6,0xa2,0xe1,0x38,0x21,0xed,0xb9,0x5e,0x89,0xa3,0xd1,0x7b,0x1a,0xea,0x8a,0x89,0x76,0xc0,
+  0x9f,0xc8,0xfb,0x13,0xd7,0xda,0xe9,0x7e,0x68,0xba,0x74,0x9c,0xf1,0x29,0xc5,0xd9,0x8c,0xa6,0xb1,0xcd,
+  0x78,0xda,0x71,0x07,0x4b,0x5b,0x72,0x37,0xab,0x19,0xc9,0x15,0x64,0x38,0x1a,0x68,0x7c,0x89,0xe7,0x60,
+  0x38,0x64,0x71,0x3b,0x2c,0x9f,0x5a,0xa3,0xa9,0x3c,0x75,0x5c,0x81,0xbe,0x5e,0xf5,0x28,0xb6,0x45,0x78,
+  0xaa,0xe7,0x9f,0x35,0xa8,0xcd,0xdc,0x7d,0x25,0x48,0x85,0xdb,0xa9,0x4b,0x3f,0x37,0xdb,0xf7,0x0b,0x62,
+  0xe0,0x7e,0x9b,0x31,0x44,0x05,0x74,0xc2,0x3a,0xd2,0x07,0x56,0xd4,0x40,0x09,0x32,0x87,0x1e,0x78,0xee,
+  0x2e,0xd2,0x9f,0xc1,0xb3,0x1e,0x28,0xa5,0xa7,0xbf,0x4c,0x1b,0x3d,0x3c,0x7b,0xbc,0x5e,0xb5,0xdf,0x51,
+  0xcf,0x2c,0x76,0xa8,0x9c,0xfd,0x1d,0xa4,0x38,0x6c,0xce,0xcd,0xa1,0xfb,0x36,0xeb,0xfc,0x03,0x65,0xfa,
+  0x7e,0x20,0xb2,0x09,0x00,0x00,
+};
+
+// /update: 1708 bytes, 949 gzipped
+#define WEB_UPDATE_ETAG "\"6502bd70b9b04d76\""
+const uint8_t WEB_UPDATE_GZ[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x95,0x55,0x4d,0x73,0xdb,0x36,0x10,0xbd,0xf3,0x57,
+  0xa0,0xc9,0x01,0xd4,0x24,0xa4,0x44,0xd9,0xf2,0x34,0xfc,0xf2,0xa4,0x6e,0x32,0xbd,0x39,0x13,0xa7,0xe3,
+  0xe9,0x78,0x7c,0x80,0xc0,0xa5,0x88,0x06,0x04,0x18,0x00,0x94,0x2d,0x6b,0xd4,0xdf,0xde,0x05,0x49,0xd9,
+  0x72,0x7a,0xaa,0x3c,0x92,0x45,0x00,0xfb,0xf0,0xf6,0xed,0xdb,0x55,0xfe,0xcb,0xef,0xd7,0x57,0xdf,0xfe,
+  0xfa,0xf2,0x89,0x34,0xae,0x95,0x65,0x3e,0x7d,0x02,0xab,0xca,0x20,0x6f,0xc1,0x31,0xa2,0x58,0x0b,0x05,
+  0xdd,0x0a,0x78,0xe8,0xb4,0x71,0x94,0x70,0xad,0x1c,0x28,0x57,0xd0,0x07,0x51,0xb9,0xa6,0xa8,0x60,0x2b,
+  0x38,0x44,0xc3,0xc3,0x7b,0xa1,0x84,0x13,0x4c,0x46,0x96,0x33,0x09,0x45,0x42,0x11,0xc3,0xba,0x9d,0x84,
+  0x32,0x58,0xeb,0x6a,0xb7,0xaf,0x31,0x34,0xaa,0x59,0x2b,0xe4,0x2e,0xb5,0x3b,0xeb,0xa0,0x8d,0x7a,0x91,
+  0xb5,0xcc,0x6c,0x84,0x4a,0x97,0x8b,0xee,0x31,0x73,0xf0,0xe8,0x22,0x26,0xc5,0x46,0xa5,0x1c,0x2f,0x01,
+  0x93,0xad,0x19,0xff,0xbe,0x31,0xba,0x57,0x55,0xfa,0x36,0x49,0x92,0x8c,0x6b,0xa9,0x4d,0xfa,0x16,0x00,
+  0x0e,0x41,0xcc,0xf7,0x2d,0x7b,0x1c,0xef,0x4e,0x57,0x0b,0x0f,0x30,0x81,0x2d,0x08,0xeb,0x9d,0x3e,0x04,
+  0x4d,0xb2,0x9f,0x02,0xce,0xce,0xab,0xb3,0x0f,0x1f,0x0e,0xc1,0xba,0x77,0x4e,0xab,0xfd,0x29,0x2c,0xd4,
+  0xe7,0xf8,0x9a,0x90,0x1f,0x1a,0xe1,0x20,0x5b,0x6b,0x53,0x81,0x49,0x95,0x56,0x90,0x75,0xac,0xaa,0x84,
+  0xda,0xa4,0x09,0xe2,0x93,0x81,0xe5,0xb8,0x1b,0x19,0x56,0x89,0xde,0xa6,0x17,0xb8,0xc2,0x7b,0x63,0x31,
+  0xb8,0xd3,0x62,0x20,0x3d,0x24,0x6a,0xc5,0x13,0xa4,0xc9,0xaa,0x7b,0x3c,0x5e,0x9a,0x36,0x7a,0x0b,0xe6,
+  0xd5,0xd5,0x15,0x5f,0x5e,0x2c,0x2f,0x0e,0x81,0x50,0x5d,0xef,0xee,0xdc,0xae,0x43,0xa9,0x6b,0x21,0x81,
+  0xde,0xef,0x4f,0x64,0x21,0x8b,0xd7,0x69,0x3f,0x30,0xa3,0x8e,0x79,0x4d,0xe4,0x4f,0x41,0x97,0x2c,0xc1,
+  0xbf,0x17,0xde,0xab,0xff,0x50,0xfe,0xf5,0x45,0xa9,0x11,0x1f,0x41,0x85,0xaa,0xf5,0x2b,0x6e,0x09,0x5b,
+  0xc2,0xff,0x84,0x39,0xad,0x9f,0x84,0xda,0x9d,0x0a,0x71,0xe6,0x85,0x60,0x3f,0x97,0x23,0x9f,0x8f,0x06,
+  0xc9,0xe7,0x83,0xe7,0x72,0xef,0x93,0x32,0xaf,0xc4,0x96,0x70,0xc9,0xac,0x2d,0x28,0xf7,0x26,0x6a,0x92,
+  0xf2,0xb3,0x30,0x2d,0xe6,0x0d,0xe4,0xcf,0xae,0x62,0x0e,0xf0,0x7c,0x82,0x1b,0x5d,0x79,0xd5,0x1b,0x83,
+  0x4e,0x21,0xa8,0xac,0x15,0xa8,0x31,0x41,0xc7,0x19,0xad,0x36,0x04,0x4f,0xb1,0x08,0x01,0xea,0x07,0x5a,
+  0xfa,0x5b,0xfc,0x22,0x7e,0xe9,0x30,0xea,0x04,0xde,0x4b,0x89,0xfb,0xd3,0xf6,0x2d,0x3e,0xf9,0x5c,0x9f,
+  0xcf,0x93,0x6b,0x25,0x77,0xa4,0xef,0xa4,0x66,0x15,0x71,0xa6,0x47,0xcf,0x56,0x24,0x5e,0x0b,0x45,0xea,
+  0x23,0x1f,0x5f,0x2e,0x1b,0xe7,0x73,0x04,0x7d,0x0d,0xed,0x05,0x45,0xf2,0x84,0x24,0x31,0xb9,0x01,0x09,
+  0xdc,0xbd,0x04,0x0d,0x10,0xa1,0x36,0x64,0xf3,0x24,0xba,0x6e,0xc2,0x8c,0x37,0x4f,0xb3,0x01,0x2e,0x5f,
+  0x1b,0x1f,0xb7,0x8c,0xc9,0x75,0xe7,0x30,0x29,0x26,0x91,0x44,0xc7,0xf0,0x72,0xe2,0x1a,0x20,0x37,0x7f,
+  0x7c,0x8c,0x96,0xab,0x0b,0xa2,0xeb,0xe1,0xb1,0x57,0x5c,0xb7,0x9d,0x01,0x6b,0x27,0x9c,0x29,0xfc,0x2c,
+  0x26,0x57,0x52,0xf0,0xef,0x47,0xc5,0xc6,0xd5,0xf3,0x98,0xdc,0x32,0x81,0x54,0xf0,0x72,0x03,0x6b,0xad,
+  0x1d,0x09,0xff,0x49,0x16,0x76,0x36,0xed,0xaf,0x62,0xf2,0x15,0xb0,0xc7,0x95,0xe7,0xeb,0x34,0x26,0x83,
+  0x10,0x1b,0x0c,0xb8,0x15,0x9f,0x45,0x70,0x4c,0x13,0xa3,0x5b,0x82,0xe3,0xa1,0xd1,0x55,0x41,0xbf,0x5c,
+  0xdf,0x7c,0xa3,0x04,0x14,0x1f,0xfd,0xdb,0xf6,0xd2,0x89,0x8e,0x19,0x37,0xf7,0xa7,0x22,0x5f,0x07,0x4a,
+  0xb4,0xb2,0xfd,0xba,0x15,0xae,0x78,0xb3,0x65,0x86,0x34,0x85,0x6b,0x84,0x8d,0x6d,0xc3,0xe2,0x2d,0x93,
+  0x3d,0xc4,0xce,0x88,0x36,0x9c,0x65,0xc3,0x2a,0xe3,0x3e,0xe7,0xa2,0xb9,0xa4,0xf3,0x7e,0x60,0x7e,0x89,
+  0xe7,0x30,0xdf,0x82,0xbe,0x6b,0xd2,0xe3,0x1a,0xcd,0x0c,0xb8,0xde,0x28,0x3f,0x8e,0xbc,0xaa,0x21,0x1d,
+  0xb3,0x7c,0x96,0xf8,0x92,0xce,0xde,0xf8,0x7c,0xf2,0xa1,0xb5,0xc8,0x49,0x6b,0x4d,0x13,0x6d,0xc2,0x21,
+  0x8c,0x73,0xe8,0x70,0x9c,0x79,0xe5,0xde,0x63,0x09,0x28,0xca,0xf2,0xa3,0x17,0x06,0xbc,0x1b,0xcd,0x09,
+  0xc4,0x18,0x86,0x5c,0x28,0xe9,0x24,0xe3,0xd0,0x68,0x89,0xbd,0x50,0xd0,0x63,0x39,0x42,0x3d,0x15,0x6b,
+  0x46,0x89,0xb7,0x7c,0x41,0xcf,0x17,0xf8,0xcd,0xdb,0x1b,0x45,0x19,0xda,0x24,0x5a,0x6b,0x1c,0x04,0xed,
+  0xd0,0x2d,0xf4,0x19,0x7e,0x9c,0x0e,0x13,0xc5,0x51,0x26,0x5a,0x4e,0xe9,0x1c,0x6d,0x9f,0xcf,0xc7,0x53,
+  0xa8,0xfd,0x20,0x2b,0xfe,0xc7,0xe8,0x9c,0x91,0xc6,0x40,0x5d,0xd0,0x39,0x2d,0x7f,0xc3,0xd6,0xcd,0xe7,
+  0xac,0x9c,0x6a,0x94,0x5b,0x6e,0x44,0xe7,0xca,0xa0,0x06,0xc7,0x9b,0x90,0xa2,0xa3,0x7d,0xba,0xb3,0x18,
+  0x2d,0xa3,0x42,0x53,0x94,0x26,0xfe,0xdb,0x6a,0x15,0xce,0xa6,0x15,0x5b,0x94,0x7b,0x24,0x53,0x69,0xde,
+  0xb7,0xd8,0x4f,0xf1,0x8f,0x1e,0xcc,0x6e,0xb4,0xad,0x36,0x1f,0xa5,0x0c,0xe9,0xdd,0xd8,0x51,0xf7,0x88,
+  0x81,0x0c,0x3e,0x31,0x44,0x05,0x0c,0x12,0x75,0x48,0x87,0x22,0x52,0x82,0x9e,0x86,0x19,0x8c,0x25,0x2d,
+  0xec,0x1d,0xc4,0x3e,0xc2,0x82,0x8b,0xed,0x7d,0x06,0xd2,0x02,0xc1,0x42,0xe3,0x80,0xb8,0x9a,0x7e,0x41,
+  0x7e,0x3a,0x71,0x98,0x65,0x81,0x7f,0x63,0xf3,0x4d,0xd4,0x31,0xe9,0x61,0x1c,0xcc,0x87,0x5f,0xa5,0xe0,
+  0x5f,0xa1,0xb8,0xee,0x9e,0xac,0x06,0x00,0x00,
+};
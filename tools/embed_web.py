@@ -0,0 +1,61 @@
+"""Gzips web/*.html into src/web_pages.h as PROGMEM byte arrays.
+
+Runs before every PlatformIO build (extra_scripts = pre:tools/embed_web.py)
+and by hand: python3 tools/embed_web.py. The header is checked in so a
+plain compiler run works too; it is only rewritten when a page changed.
+Each page's ETag is a hash of its gzipped bytes, so browsers revalidate
+with If-None-Match and get a 304 until the firmware ships a new page.
+"""
+import gzip
+import hashlib
+import os
+
+try:
+    Import("env")  # noqa: F821 (SCons builtin under PlatformIO)
+    ROOT = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PAGES = [  # (file in web/, URL path, C name)
+    ("index.html", "/", "WEB_INDEX"),
+    ("wifi.html", "/wifi", "WEB_WIFI"),
+    ("pins.html", "/pins", "WEB_PINS"),
+    ("update.html", "/update", "WEB_UPDATE"),
+]
+
+
+def render():
+    out = [
+        "// Generated by tools/embed_web.py from web/*.html. Do not edit.",
+        "#pragma once",
+        "",
+    ]
+    for name, path, sym in PAGES:
+        with open(os.path.join(ROOT, "web", name), "rb") as f:
+            raw = f.read()
+        gz = gzip.compress(raw, 9, mtime=0)  # No timestamp: same page, same bytes
+        etag = hashlib.sha256(gz).hexdigest()[:16]
+        out.append("// %s: %d bytes, %d gzipped" % (path, len(raw), len(gz)))
+        out.append('#define %s_ETAG "\\"%s\\""' % (sym, etag))
+        out.append("const uint8_t %s_GZ[] PROGMEM = {" % sym)
+        for i in range(0, len(gz), 20):
+            out.append("  " + ",".join("0x%02x" % b for b in gz[i:i + 20]) + ",")
+        out.append("};")
+        out.append("")
+    return "\n".join(out)
+
+
+def main():
+    path = os.path.join(ROOT, "src", "web_pages.h")
+    text = render()
+    try:
+        with open(path) as f:
+            if f.read() == text:
+                return
+    except OSError:
+        pass
+    with open(path, "w") as f:
+        f.write(text)
+    print("embed_web: wrote " + os.path.relpath(path, ROOT))
+
+
+main()